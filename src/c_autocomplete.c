@@ -35,7 +35,7 @@
 
 #include "c_console.h"
 
-autocomplete_t autocompletelist[] =
+const autocomplete_t autocompletelist[] =
 {
     { "alias ",                                             DOOM1AND2        },
     { "alwaysrun ",                                         DOOM1AND2        },
@@ -9299,6 +9299,11 @@ autocomplete_t autocompletelist[] =
     { "if r_playerweapon_translucency off then ",           DOOM1AND2        },
     { "if r_playerweapon_translucency on ",                 DOOM1AND2        },
     { "if r_playerweapon_translucency on then ",            DOOM1AND2        },
+    { "if r_pvs ",                                          DOOM1AND2        },
+    { "if r_pvs off ",                                      DOOM1AND2        },
+    { "if r_pvs off then ",                                 DOOM1AND2        },
+    { "if r_pvs on ",                                       DOOM1AND2        },
+    { "if r_pvs on then ",                                  DOOM1AND2        },
     { "if r_radiallighting ",                               DOOM1AND2        },
     { "if r_radiallighting off ",                           DOOM1AND2        },
     { "if r_radiallighting off then ",                      DOOM1AND2        },
@@ -9377,6 +9382,11 @@ autocomplete_t autocompletelist[] =
     { "if r_textures_translucency off then ",               DOOM1AND2        },
     { "if r_textures_translucency on ",                     DOOM1AND2        },
     { "if r_textures_translucency on then ",                DOOM1AND2        },
+    { "if r_threads ",                                      DOOM1AND2        },
+    { "if r_threads 1 ",                                    DOOM1AND2        },
+    { "if r_threads 1 then ",                               DOOM1AND2        },
+    { "if r_threads 16 ",                                   DOOM1AND2        },
+    { "if r_threads 16 then ",                              DOOM1AND2        },
     { "if regenhealth ",                                    DOOM1AND2        },
     { "if regenhealth off ",                                DOOM1AND2        },
     { "if regenhealth off then ",                           DOOM1AND2        },
@@ -9628,6 +9638,11 @@ autocomplete_t autocompletelist[] =
     { "if vid_showfps off then ",                           DOOM1AND2        },
     { "if vid_showfps on ",                                 DOOM1AND2        },
     { "if vid_showfps on then ",                            DOOM1AND2        },
+    { "if vid_showprofile ",                                DOOM1AND2        },
+    { "if vid_showprofile off ",                            DOOM1AND2        },
+    { "if vid_showprofile off then ",                       DOOM1AND2        },
+    { "if vid_showprofile on ",                             DOOM1AND2        },
+    { "if vid_showprofile on then ",                        DOOM1AND2        },
     { "if vid_vsync ",                                      DOOM1AND2        },
 #if !defined(__APPLE__)
     { "if vid_vsync adaptive ",                             DOOM1AND2        },
@@ -10231,6 +10246,7 @@ autocomplete_t autocompletelist[] =
     { "melt ",                                              DOOM1AND2        },
     { "melt off",                                           DOOM1AND2        },
     { "melt on",                                            DOOM1AND2        },
+    { "memstats",                                           DOOM1AND2        },
     { "+menu",                                              DOOM1AND2        },
     { "menuhighlight ",                                     DOOM1AND2        },
     { "menuhighlight off",                                  DOOM1AND2        },
@@ -10694,6 +10710,7 @@ autocomplete_t autocompletelist[] =
     { "playerstats",                                        DOOM1AND2        },
     { "+prevweapon",                                        DOOM1AND2        },
     { "print ",                                             DOOM1AND2        },
+    { "profile ",                                           DOOM1AND2        },
     { "quit",                                               DOOM1AND2        },
     { "r_althud ",                                          DOOM1AND2        },
     { "r_althud off",                                       DOOM1AND2        },
@@ -10868,6 +10885,9 @@ autocomplete_t autocompletelist[] =
     { "r_playerweapon_translucency ",                       DOOM1AND2        },
     { "r_playerweapon_translucency off",                    DOOM1AND2        },
     { "r_playerweapon_translucency on",                     DOOM1AND2        },
+    { "r_pvs ",                                             DOOM1AND2        },
+    { "r_pvs off",                                          DOOM1AND2        },
+    { "r_pvs on",                                           DOOM1AND2        },
     { "r_radiallighting ",                                  DOOM1AND2        },
     { "r_radiallighting off",                               DOOM1AND2        },
     { "r_radiallighting on",                                DOOM1AND2        },
@@ -10915,6 +10935,9 @@ autocomplete_t autocompletelist[] =
     { "r_textures_translucency ",                           DOOM1AND2        },
     { "r_textures_translucency off",                        DOOM1AND2        },
     { "r_textures_translucency on",                         DOOM1AND2        },
+    { "r_threads ",                                         DOOM1AND2        },
+    { "r_threads 1",                                        DOOM1AND2        },
+    { "r_threads 16",                                       DOOM1AND2        },
     { "readme",                                             DOOM1AND2        },
     { "regenhealth ",                                       DOOM1AND2        },
     { "regenhealth off",                                    DOOM1AND2        },
@@ -11167,6 +11190,7 @@ autocomplete_t autocompletelist[] =
     { "reset r_pickupeffect",                               DOOM1AND2        },
     { "reset r_playerweapon",                               DOOM1AND2        },
     { "reset r_playerweapon_translucency",                  DOOM1AND2        },
+    { "reset r_pvs",                                        DOOM1AND2        },
     { "reset r_radiallighting",                             DOOM1AND2        },
     { "reset r_radsuiteffect",                              DOOM1AND2        },
     { "reset r_randomstartframes",                          DOOM1AND2        },
@@ -11183,6 +11207,7 @@ autocomplete_t autocompletelist[] =
     { "reset r_teleportzoom",                               DOOM1AND2        },
     { "reset r_textures",                                   DOOM1AND2        },
     { "reset r_textures_translucency",                      DOOM1AND2        },
+    { "reset r_threads",                                    DOOM1AND2        },
     { "reset s_channels",                                   DOOM1AND2        },
     { "reset s_fullsfx",                                    DOOM1AND2        },
     { "reset s_lowermenumusic",                             DOOM1AND2        },
@@ -11223,6 +11248,7 @@ autocomplete_t autocompletelist[] =
     { "reset vid_scalefilter",                              DOOM1AND2        },
     { "reset vid_screenresolution",                         DOOM1AND2        },
     { "reset vid_showfps",                                  DOOM1AND2        },
+    { "reset vid_showprofile",                              DOOM1AND2        },
     { "reset vid_vsync",                                    DOOM1AND2        },
     { "reset vid_widescreen",                               DOOM1AND2        },
     { "reset vid_windowpos",                                DOOM1AND2        },
@@ -11818,6 +11844,7 @@ autocomplete_t autocompletelist[] =
     { "toggle r_pickupeffect",                              DOOM1AND2        },
     { "toggle r_playerweapon",                              DOOM1AND2        },
     { "toggle r_playerweapon_translucency",                 DOOM1AND2        },
+    { "toggle r_pvs",                                       DOOM1AND2        },
     { "toggle r_radiallighting",                            DOOM1AND2        },
     { "toggle r_radsuiteffect",                             DOOM1AND2        },
     { "toggle r_randomstartframes",                         DOOM1AND2        },
@@ -11847,6 +11874,7 @@ autocomplete_t autocompletelist[] =
     { "toggle vid_fullscreen",                              DOOM1AND2        },
     { "toggle vid_pillarboxes",                             DOOM1AND2        },
     { "toggle vid_showfps",                                 DOOM1AND2        },
+    { "toggle vid_showprofile",                             DOOM1AND2        },
     { "toggle vid_widescreen",                              DOOM1AND2        },
     { "toggle weaponbounce",                                DOOM1AND2        },
     { "toggle weaponrecoil",                                DOOM1AND2        },
@@ -12117,6 +12145,9 @@ autocomplete_t autocompletelist[] =
     { "vid_showfps ",                                       DOOM1AND2        },
     { "vid_showfps off",                                    DOOM1AND2        },
     { "vid_showfps on",                                     DOOM1AND2        },
+    { "vid_showprofile ",                                   DOOM1AND2        },
+    { "vid_showprofile off",                                DOOM1AND2        },
+    { "vid_showprofile on",                                 DOOM1AND2        },
     { "vid_vsync ",                                         DOOM1AND2        },
 #if !defined(__APPLE__)
     { "vid_vsync adaptive",                                 DOOM1AND2        },
@@ -64,6 +64,7 @@
 #include "md5.h"
 #include "p_inter.h"
 #include "p_local.h"
+#include "p_pvs.h"
 #include "p_setup.h"
 #include "p_tick.h"
 #include "r_sky.h"
@@ -74,6 +75,8 @@
 #include "v_video.h"
 #include "version.h"
 #include "w_wad.h"
+#include "yyjson/yyjson.h"
+#include "z_zone.h"
 
 #define ALIASFORMAT                     BOLDITALICS("alias") " [[" BOLD("\"") "]" BOLDITALICS("command") "[" BOLD(";") " " \
                                         BOLDITALICS("command") " ..." BOLD("\"") "]]"
@@ -98,6 +101,7 @@
                                         BOLD("first") "|" BOLD("previous") "|" BOLD("next") "|" BOLD("last") "|" BOLD("random")
 #define MAPFORMAT2                      BOLD("MAP") BOLDITALICS("xy") "|" BOLDITALICS("title") "|" BOLD("first") "|" BOLD("previous") "|" \
                                         BOLD("next") "|" BOLD("last") "|" BOLD("random")
+#define MEMSTATSFORMAT                  "[" BOLDITALICS("filename") "[" BOLD(".json") "]]"
 #define NOCLIPFORMAT                    "[" BOLD("on") "|" BOLD("off") "]"
 #define NOMONSTERSFORMAT                "[" BOLD("on") "|" BOLD("off") "]"
 #define NOTARGETFORMAT                  "[" BOLD("on") "|" BOLD("off") "]"
@@ -105,6 +109,7 @@
 #define PLAYFORMAT                      BOLDITALICS("soundeffect") "|" BOLDITALICS("music")
 #define NAMEFORMAT                      "[[" BOLD("un") "]" BOLD("friendly") " ]" BOLDITALICS("monster") " " BOLDITALICS("name")
 #define PRINTFORMAT                     "[" BOLD("\x93") "]" BOLDITALICS("message") "[" BOLD("\x94") "]"
+#define PROFILEFORMAT                   "[" BOLDITALICS("filename") "[" BOLD(".csv") "]]"
 #define REGENHEALTHFORMAT               "[" BOLD("on") "|" BOLD("off") "]"
 #define REMOVEFORMAT                    BOLD("decorations") "|" BOLD("corpses") "|" BOLD("bloodsplats") "|" BOLD("items") "|" \
                                         BOLDITALICS("item") "|" BOLD("everything")
@@ -203,6 +208,11 @@ bool        togglingcvar = false;
 bool        togglingvanilla = false;
 bool        vanilla = false;
 
+stringhash_t    actionhash;
+stringhash_t    consolecmdhash;
+int             numactions;
+int             numconsolecmds;
+
 const control_t controls[] =
 {
     { "escape",        keyboardcontrol,   KEY_ESCAPE                },
@@ -471,6 +481,7 @@ static bool mapfunc1(char *cmd, char *parms);
 static void mapfunc2(char *cmd, char *parms);
 static void maplistfunc2(char *cmd, char *parms);
 static void mapstatsfunc2(char *cmd, char *parms);
+static void memstatsfunc2(char *cmd, char *parms);
 static bool namefunc1(char *cmd, char *parms);
 static void namefunc2(char *cmd, char *parms);
 static void newgamefunc2(char *cmd, char *parms);
@@ -483,6 +494,7 @@ static bool playfunc1(char *cmd, char *parms);
 static void playfunc2(char *cmd, char *parms);
 static void playerstatsfunc2(char *cmd, char *parms);
 static void printfunc2(char *cmd, char *parms);
+static void profilefunc2(char *cmd, char *parms);
 static void quitfunc2(char *cmd, char *parms);
 static void readmefunc2(char *cmd, char *parms);
 static void regenhealthfunc2(char *cmd, char *parms);
@@ -557,6 +569,7 @@ static void r_hud_translucencyfunc2(char *cmd, char *parms);
 static void r_invulnerabilityeffectfunc2(char *cmd, char *parms);
 static void r_lowpixelsizefunc2(char *cmd, char *parms);
 static void r_mirroredweaponsfunc2(char *cmd, char *parms);
+static void r_pvsfunc2(char *cmd, char *parms);
 static void r_radiallightingfunc2(char *cmd, char *parms);
 static void r_randomstartframesfunc2(char *cmd, char *parms);
 static void r_rockettrails_translucencyfunc2(char *cmd, char *parms);
@@ -565,6 +578,7 @@ static void r_shadows_translucencyfunc2(char *cmd, char *parms);
 static void r_sprites_translucencyfunc2(char *cmd, char *parms);
 static void r_texturesfunc2(char *cmd, char *parms);
 static void r_textures_translucencyfunc2(char *cmd, char *parms);
+static void r_threadsfunc2(char *cmd, char *parms);
 static void s_randommusicfunc2(char *cmd, char *parms);
 static void s_remixfunc2(char *cmd, char *parms);
 static bool s_volumecvarsfunc1(char *cmd, char *parms);
@@ -590,6 +604,7 @@ static bool vid_scalefilterfunc1(char *cmd, char *parms);
 static void vid_scalefilterfunc2(char *cmd, char *parms);
 static void vid_screenresolutionfunc2(char *cmd, char *parms);
 static void vid_showfpsfunc2(char *cmd, char *parms);
+static void vid_showprofilefunc2(char *cmd, char *parms);
 static void vid_vsyncfunc2(char *cmd, char *parms);
 static void vid_widescreenfunc2(char *cmd, char *parms);
 static void vid_windowposfunc2(char *cmd, char *parms);
@@ -925,6 +940,8 @@ consolecmd_t consolecmds[] =
         "The amount of time you have been in the current map."),
     BOOLCVAR(melt, "", "", boolfunc1, boolfunc2, 0,
         "Toggles a melting effect when transitioning between some screens."),
+    CCMD(memstats, "", "", nullfunc1, memstatsfunc2, true, MEMSTATSFORMAT,
+        "Shows stats about the memory allocated by the zone memory allocator, or saves them to a JSON file."),
     BOOLCVAR(menuhighlight, "", "", boolfunc1, boolfunc2, 0,
         "Toggles the highlighting of items selected in the menu."),
     BOOLCVAR(menushadow, "", "", boolfunc1, boolfunc2, 0,
@@ -963,6 +980,8 @@ consolecmd_t consolecmds[] =
         "Shows stats about you."),
     CCMD(print, "", "", ingameccmdfunc1, printfunc2, true, PRINTFORMAT,
         "Prints a player " BOLDITALICS("\"message\"") "."),
+    CCMD(profile, "", "", nullfunc1, profilefunc2, true, PROFILEFORMAT,
+        "Dumps the frame profiler's timings into " BOLDITALICS("filename") " as comma-separated values."),
     CCMD(quit, "", exit, nullfunc1, quitfunc2, false, "",
         "Quits to the " DESKTOP "."),
     BOOLCVAR(r_althud, "", "", boolfunc1, boolfunc2, 0,
@@ -1065,6 +1084,8 @@ consolecmd_t consolecmds[] =
         "Toggles showing your weapon."),
     BOOLCVAR(r_playerweapon_translucency, "", "", boolfunc1, boolfunc2, 0,
         "Toggles the translucency effect when firing your weapon."),
+    BOOLCVAR(r_pvs, "", "", boolfunc1, r_pvsfunc2, 0,
+        "Toggles culling the parts of the map that can't be seen from the sector you're in."),
     BOOLCVAR(r_radiallighting, "", "", boolfunc1, r_radiallightingfunc2, 0,
         "Toggles radial diminished lighting around you."),
     BOOLCVAR(r_radsuiteffect, "", "", boolfunc1, boolfunc2, 0,
@@ -1097,6 +1118,8 @@ consolecmd_t consolecmds[] =
         "Toggles showing all textures."),
     BOOLCVAR(r_textures_translucency, "", "", boolfunc1, r_textures_translucencyfunc2, 0,
         "Toggles the translucency of certain " ITALICS("BOOM-") "compatible wall textures."),
+    INTCVAR(r_threads, "", "", intfunc1, r_threadsfunc2, 0, 0,
+        "The number of threads used to render the walls, floors and ceilings (" BOLD("1") " to " BOLD("16") ")."),
     CCMD(readme, "", "", nullfunc1, readmefunc2, false, "",
         "Shows the accompanying readme file for the currently loaded PWAD."),
     CCMD(regenhealth, "", "", ingameccmdfunc1, regenhealthfunc2, true, REGENHEALTHFORMAT,
@@ -1231,6 +1254,8 @@ consolecmd_t consolecmds[] =
         "\xD7" ITALICS("height")) ")."),
     BOOLCVAR(vid_showfps, "", "", boolfunc1, vid_showfpsfunc2, 0,
         "Toggles showing the number of frames per second."),
+    BOOLCVAR(vid_showprofile, "", "", boolfunc1, vid_showprofilefunc2, 0,
+        "Toggles showing how long each stage of drawing a frame takes."),
 #if defined(__APPLE__)
     INTCVAR(vid_vsync, "", "", intfunc1, vid_vsyncfunc2, 0, VSYNCVALUEALIAS,
         "Toggles vertical sync with the display's refresh rate (" BOLD("on") " or " BOLD("off") ")."),
@@ -1627,19 +1652,63 @@ static void zoomoutactionfunc(void)
         AM_ToggleZoomOut();
 }
 
-int C_GetIndex(const char *cmd)
+//
+// C_InitHashTables
+//
+// [BH] Hash the names of all CCMDs, CVARs and actions so that they can be
+//  looked up without searching through every one of them.
+//
+void C_InitHashTables(void)
 {
-    int i = 0;
+    while (*consolecmds[numconsolecmds].name)
+        numconsolecmds++;
+
+    while (*actions[numactions].action)
+        numactions++;
+
+    M_InitStringHash(&consolecmdhash, numconsolecmds * 3);
 
-    while (*consolecmds[i].name)
+    for (int i = 0; i < numconsolecmds; i++)
     {
-        if (M_StringCompare(cmd, consolecmds[i].name) || M_StringCompare(cmd, consolecmds[i].alternate))
-            break;
+        M_AddToStringHash(&consolecmdhash, consolecmds[i].name, i);
 
-        i++;
+        if (*consolecmds[i].altspelling && !M_StringCompare(consolecmds[i].altspelling, EMPTYVALUE))
+            M_AddToStringHash(&consolecmdhash, consolecmds[i].altspelling, i);
+
+        if (*consolecmds[i].alternate && !M_StringCompare(consolecmds[i].alternate, EMPTYVALUE))
+            M_AddToStringHash(&consolecmdhash, consolecmds[i].alternate, i);
     }
 
-    return i;
+    M_InitStringHash(&actionhash, numactions * 2);
+
+    for (int i = 0; i < numactions; i++)
+    {
+        M_AddToStringHash(&actionhash, actions[i].action, i);
+
+        if (!M_StringCompare(actions[i].oldaction, actions[i].action))
+            M_AddToStringHash(&actionhash, actions[i].oldaction, i);
+    }
+}
+
+int C_GetIndex(const char *cmd)
+{
+    int         indices[MAXCMDMATCHES];
+    const int   count = M_FindAllInStringHash(&consolecmdhash, cmd, indices, MAXCMDMATCHES);
+
+    // match the name or alternate, but not the alternate spelling
+    for (int i = 0; i < count; i++)
+        if (M_StringCompare(cmd, consolecmds[indices[i]].name)
+            || M_StringCompare(cmd, consolecmds[indices[i]].alternate))
+            return indices[i];
+
+    return numconsolecmds;
+}
+
+int C_GetActionIndex(const char *action)
+{
+    const int   i = M_FindInStringHash(&actionhash, action);
+
+    return (i == -1 ? numactions : i);
 }
 
 static void C_ShowDescription(int index)
@@ -2382,13 +2451,7 @@ void bindfunc2(char *cmd, char *parms)
         }
         else
         {
-            while (*actions[action].action)
-            {
-                if (M_StringCompare(parm2, actions[action].action) || M_StringCompare(parm2, actions[action].oldaction))
-                    break;
-
-                action++;
-            }
+            action = C_GetActionIndex(parm2);
 
             if (*actions[action].action)
             {
@@ -2865,15 +2928,15 @@ static void condumpfunc2(char *cmd, char *parms)
     if ((file = fopen(filename, "wt")))
 #endif
     {
-        char    *temp1 = commify((int64_t)numconsolestrings);
+        char    *temp1 = commify((int64_t)numconsolestrings - firstconsolestring);
 
 #if defined(_WIN32)
         fputs("\xEF\xBB\xBF", file);
 #endif
 
-        for (int i = 1; i < numconsolestrings - 1; i++)
+        for (int i = MAX(1, firstconsolestring); i < numconsolestrings - 1; i++)
         {
-            stringtype_t    type = console[i].stringtype;
+            stringtype_t    type = CONSOLESTRING(i).stringtype;
 
             if (type == dividerstring)
 #if defined(_WIN32)
@@ -2883,7 +2946,7 @@ static void condumpfunc2(char *cmd, char *parms)
 #endif
             else
             {
-                char            *string = M_StringDuplicate(console[i].string);
+                char            *string = M_StringDuplicate(CONSOLESTRING(i).string);
                 char            line[CONSOLETEXTMAXLENGTH * 2];
                 int             len;
                 int             linepos = 0;
@@ -2898,15 +2961,15 @@ static void condumpfunc2(char *cmd, char *parms)
                         continue;
                 }
 
-                if (type == warningstring && con_warninglevel < console[i].warninglevel && !devparm)
+                if (type == warningstring && con_warninglevel < CONSOLESTRING(i).warninglevel && !devparm)
                     continue;
 
                 if ((type == playermessagestring || type == playerwarningstring
                     || type == obituarystring || type == playerobituarystring)
-                    && console[i].count > 1)
+                    && CONSOLESTRING(i).count > 1)
                 {
                     char    buffer[CONSOLETEXTMAXLENGTH];
-                    char    *temp2 = commify(console[i].count);
+                    char    *temp2 = commify(CONSOLESTRING(i).count);
 
                     M_snprintf(buffer, sizeof(buffer), "%s (%s)", string, temp2);
                     free(temp2);
@@ -2930,7 +2993,7 @@ static void condumpfunc2(char *cmd, char *parms)
 
                     if (letter == '\t')
                     {
-                        const unsigned int  tabstop = console[i].tabs[tabcount] / 6;
+                        const unsigned int  tabstop = CONSOLESTRING(i).tabs[tabcount] / 6;
 
                         if (outpos < tabstop)
                         {
@@ -2965,7 +3028,7 @@ static void condumpfunc2(char *cmd, char *parms)
                     || type == obituarystring || type == playerobituarystring)
                 {
                     int         spaces = (int)strlen(DIVIDERSTRING) - 10 - outpos;
-                    struct tm   timestamp = console[i].timestamp;
+                    struct tm   timestamp = CONSOLESTRING(i).timestamp;
 
                     if (con_timestampformat == con_timestampformat_military)
                         spaces += 2;
@@ -6592,6 +6655,212 @@ static void mapstatsfunc2(char *cmd, char *parms)
     }
 }
 
+//
+// memstats CCMD
+//
+static const char *memstatstagnames[PU_MAX] = { "PU_FREE", "PU_STATIC", "PU_LEVEL", "PU_LEVSPEC", "PU_CACHE" };
+
+#if defined(ZONESTATS)
+static int memstatscompare(const void *a, const void *b)
+{
+    const zonecallsite_t    *callsite1 = &zonecallsites[*(const int *)a];
+    const zonecallsite_t    *callsite2 = &zonecallsites[*(const int *)b];
+
+    if (callsite1->bytes != callsite2->bytes)
+        return (callsite1->bytes < callsite2->bytes ? 1 : -1);
+
+    return (callsite1->peakbytes < callsite2->peakbytes ? 1 : (callsite1->peakbytes > callsite2->peakbytes ? -1 : 0));
+}
+
+static int memstatscallsites(int *callsites)
+{
+    int count = 0;
+
+    for (int i = 0; i <= ZONECALLSITES; i++)
+        if (zonecallsites[i].file)
+            callsites[count++] = i;
+
+    qsort(callsites, count, sizeof(*callsites), &memstatscompare);
+    return count;
+}
+#endif
+
+static bool memstatsjson(const char *filename)
+{
+    yyjson_mut_doc  *doc = yyjson_mut_doc_new(NULL);
+    yyjson_mut_val  *root;
+    yyjson_mut_val  *tags;
+    bool            result;
+
+    if (!doc)
+        return false;
+
+    if (!(root = yyjson_mut_obj(doc)) || !(tags = yyjson_mut_obj_add_arr(doc, root, "tags")))
+    {
+        yyjson_mut_doc_free(doc);
+        return false;
+    }
+
+    yyjson_mut_doc_set_root(doc, root);
+
+    for (int tag = PU_STATIC; tag < PU_MAX; tag++)
+    {
+        const zonestats_t   *stats = &zonestats[tag];
+        yyjson_mut_val      *obj = yyjson_mut_arr_add_obj(doc, tags);
+
+        if (!obj
+            || !yyjson_mut_obj_add_str(doc, obj, "tag", memstatstagnames[tag])
+            || !yyjson_mut_obj_add_uint(doc, obj, "bytes", stats->bytes)
+            || !yyjson_mut_obj_add_uint(doc, obj, "blocks", stats->blocks)
+            || !yyjson_mut_obj_add_uint(doc, obj, "peakbytes", stats->peakbytes)
+            || !yyjson_mut_obj_add_uint(doc, obj, "peakblocks", stats->peakblocks)
+            || !yyjson_mut_obj_add_uint(doc, obj, "arenabytes", stats->arenabytes))
+        {
+            yyjson_mut_doc_free(doc);
+            return false;
+        }
+    }
+
+#if defined(ZONESTATS)
+    {
+        int             callsites[ZONECALLSITES + 1];
+        const int       count = memstatscallsites(callsites);
+        yyjson_mut_val  *arr;
+        yyjson_mut_val  *rate;
+
+        if (!(arr = yyjson_mut_obj_add_arr(doc, root, "callsites"))
+            || !(rate = yyjson_mut_obj_add_obj(doc, root, "allocations"))
+            || !yyjson_mut_obj_add_uint(doc, rate, "total", zoneallocations)
+            || !yyjson_mut_obj_add_uint(doc, rate, "tics", zonetics)
+            || !yyjson_mut_obj_add_int(doc, rate, "lasttic", zonelastticallocations)
+            || !yyjson_mut_obj_add_int(doc, rate, "peaktic", zonepeakticallocations))
+        {
+            yyjson_mut_doc_free(doc);
+            return false;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            const zonecallsite_t    *callsite = &zonecallsites[callsites[i]];
+            yyjson_mut_val          *obj = yyjson_mut_arr_add_obj(doc, arr);
+
+            if (!obj
+                || !yyjson_mut_obj_add_str(doc, obj, "file", callsite->file)
+                || !yyjson_mut_obj_add_int(doc, obj, "line", callsite->line)
+                || (callsites[i] != ZONECALLSITES
+                    && !yyjson_mut_obj_add_str(doc, obj, "tag", memstatstagnames[callsite->tag]))
+                || !yyjson_mut_obj_add_uint(doc, obj, "bytes", callsite->bytes)
+                || !yyjson_mut_obj_add_uint(doc, obj, "blocks", callsite->blocks)
+                || !yyjson_mut_obj_add_uint(doc, obj, "peakbytes", callsite->peakbytes)
+                || !yyjson_mut_obj_add_uint(doc, obj, "allocations", callsite->allocations))
+            {
+                yyjson_mut_doc_free(doc);
+                return false;
+            }
+        }
+    }
+#endif
+
+    result = yyjson_mut_write_file(filename, doc, YYJSON_WRITE_PRETTY, NULL, NULL);
+    yyjson_mut_doc_free(doc);
+    return result;
+}
+
+static void memstatsfunc2(char *cmd, char *parms)
+{
+    const int   tabs[MAXTABS] = { 137, 257, 417 };
+    size_t      totalbytes = 0;
+    size_t      totalblocks = 0;
+    char        *temp1;
+    char        *temp2;
+
+    if (*parms)
+    {
+        char    *appdatafolder = M_GetAppDataFolder();
+        char    consolefolder[MAX_PATH];
+        char    filename[MAX_PATH];
+
+        M_snprintf(consolefolder, sizeof(consolefolder),
+            "%s" DIR_SEPARATOR_S DOOMRETRO_CONSOLEFOLDER, appdatafolder);
+        free(appdatafolder);
+        M_MakeDirectory(consolefolder);
+        M_snprintf(filename, sizeof(filename), "%s" DIR_SEPARATOR_S "%s%s",
+            consolefolder, parms, (strchr(parms, '.') ? "" : ".json"));
+
+        if (memstatsjson(filename))
+            C_Output("Memory stats have been saved to " BOLD("%s") ".", filename);
+        else
+            C_Warning(0, BOLD("%s") " couldn't be saved.", filename);
+
+        return;
+    }
+
+    for (int tag = PU_STATIC; tag < PU_MAX; tag++)
+    {
+        const zonestats_t   *stats = &zonestats[tag];
+        char                *temp3 = commify(stats->peakbytes);
+
+        temp1 = commify(stats->blocks);
+        temp2 = commify(stats->bytes);
+
+        C_TabbedOutput(tabs, BOLD("%s") "\t%s block%s\t%s bytes\t%s bytes at most",
+            memstatstagnames[tag], temp1, (stats->blocks == 1 ? "" : "s"), temp2, temp3);
+
+        free(temp1);
+        free(temp2);
+        free(temp3);
+
+        if (stats->arenabytes)
+        {
+            temp1 = commify(stats->arenabytes);
+            C_TabbedOutput(tabs, "\t\t%s bytes reserved in an arena", temp1);
+            free(temp1);
+        }
+
+        totalbytes += stats->bytes;
+        totalblocks += stats->blocks;
+    }
+
+    temp1 = commify(totalblocks);
+    temp2 = commify(totalbytes);
+    C_TabbedOutput(tabs, "Total\t%s block%s\t%s bytes", temp1, (totalblocks == 1 ? "" : "s"), temp2);
+    free(temp1);
+    free(temp2);
+
+#if defined(ZONESTATS)
+    {
+        const int   tabs2[MAXTABS] = { 200, 260, 370, 490 };
+        int         callsites[ZONECALLSITES + 1];
+        const int   count = memstatscallsites(callsites);
+
+        temp1 = commify(zonelastticallocations);
+        temp2 = commify(zonepeakticallocations);
+        C_Output("%s block%s allocated in the last tic, and %s at most.",
+            temp1, (zonelastticallocations == 1 ? " was" : "s were"), temp2);
+        free(temp1);
+        free(temp2);
+
+        for (int i = 0; i < count; i++)
+        {
+            const zonecallsite_t    *callsite = &zonecallsites[callsites[i]];
+            char                    *temp3 = commify(callsite->peakbytes);
+
+            temp1 = commify(callsite->blocks);
+            temp2 = commify(callsite->bytes);
+
+            C_TabbedOutput(tabs2, "%s:%i\t%s\t%s block%s\t%s bytes\t%s bytes at most",
+                leafname((char *)callsite->file), callsite->line,
+                (callsites[i] == ZONECALLSITES ? "" : memstatstagnames[callsite->tag]),
+                temp1, (callsite->blocks == 1 ? "" : "s"), temp2, temp3);
+
+            free(temp1);
+            free(temp2);
+            free(temp3);
+        }
+    }
+#endif
+}
+
 //
 // name CCMD
 //
@@ -8433,6 +8702,94 @@ static void printfunc2(char *cmd, char *parms)
         HU_PlayerMessage(parms, true, false);
 }
 
+//
+// profile CCMD
+//
+static void profilefunc2(char *cmd, char *parms)
+{
+    char        consolefolder[MAX_PATH];
+    char        filename[MAX_PATH];
+    const char  *appdatafolder = M_GetAppDataFolder();
+    FILE        *file;
+
+    if (!numprofileframes)
+    {
+        C_Warning(0, "The frame profiler hasn't timed any frames yet. Change " BOLD("vid_showprofile")
+            " to " BOLD("on") " first.");
+        return;
+    }
+
+    M_snprintf(consolefolder, sizeof(consolefolder),
+        "%s" DIR_SEPARATOR_S DOOMRETRO_CONSOLEFOLDER, appdatafolder);
+    M_MakeDirectory(consolefolder);
+
+    if (!*parms)
+    {
+        int count = 0;
+
+        M_snprintf(filename, sizeof(filename), "%s" DIR_SEPARATOR_S "%s.csv", consolefolder, cmd);
+
+        while (M_FileExists(filename))
+        {
+            char    *temp = commify(++count);
+
+            M_snprintf(filename, sizeof(filename),
+                "%s" DIR_SEPARATOR_S "%s (%s).csv", consolefolder, cmd, temp);
+            free(temp);
+        }
+    }
+    else
+        M_snprintf(filename, sizeof(filename), "%s" DIR_SEPARATOR_S "%s%s",
+            consolefolder, parms, (strchr(parms, '.') ? "" : ".csv"));
+
+    if ((file = fopen(filename, "wt")))
+    {
+        const int   first = (numprofileframes < PROFILEFRAMES ? 0 : profileframeindex);
+        char        *temp = commify(numprofileframes);
+
+        fputs("frame", file);
+
+        for (int i = 0; i < NUMPROFILESTAGES; i++)
+            fprintf(file, ",%s (us)", profilestagenames[i]);
+
+        fputs(",Total (us)", file);
+
+        for (int i = 0; i < NUMPROFILECOUNTERS; i++)
+            fprintf(file, ",%s", profilecounternames[i]);
+
+        fputc('\n', file);
+
+        for (int i = 0; i < numprofileframes; i++)
+        {
+            const profileframe_t    *frame = &profileframes[(first + i) % PROFILEFRAMES];
+            int                     total = 0;
+
+            fprintf(file, "%i", i + 1);
+
+            for (int j = 0; j < NUMPROFILESTAGES; j++)
+            {
+                fprintf(file, ",%i", frame->stages[j]);
+                total += frame->stages[j];
+            }
+
+            fprintf(file, ",%i", total);
+
+            for (int j = 0; j < NUMPROFILECOUNTERS; j++)
+                fprintf(file, ",%i", frame->counters[j]);
+
+            fputc('\n', file);
+        }
+
+        fclose(file);
+
+        C_Output("The timings of the last %s frame%s were dumped into " BOLD("%s") ".",
+            temp, (numprofileframes == 1 ? "" : "s"), filename);
+        free(temp);
+    }
+    else
+        C_Warning(0, BOLD("%s") " couldn't be created.", filename);
+}
+
 //
 // quit CCMD
 //
@@ -11245,7 +11602,7 @@ static void englishfunc2(char *cmd, char *parms)
     {
         ST_InitStatBar();
         D_TranslateDehStrings();
-        M_TranslateAutocomplete();
+        C_InitAutocomplete();
     }
 }
 
@@ -12311,6 +12668,19 @@ static void r_mirroredweaponsfunc2(char *cmd, char *parms)
             }
 }
 
+//
+// r_pvs CVAR
+//
+static void r_pvsfunc2(char *cmd, char *parms)
+{
+    const bool  r_pvs_old = r_pvs;
+
+    boolfunc2(cmd, parms);
+
+    if (r_pvs != r_pvs_old)
+        P_TogglePVS();
+}
+
 //
 // r_radiallighting CVAR
 //
@@ -12530,6 +12900,19 @@ static void r_textures_translucencyfunc2(char *cmd, char *parms)
     }
 }
 
+//
+// r_threads CVAR
+//
+static void r_threadsfunc2(char *cmd, char *parms)
+{
+    const int   r_threads_old = r_threads;
+
+    intfunc2(cmd, parms);
+
+    if (r_threads != r_threads_old)
+        R_InitDrawThreads();
+}
+
 //
 // s_randommusic CVAR
 //
@@ -13047,6 +13430,19 @@ static void vid_showfpsfunc2(char *cmd, char *parms)
     }
 }
 
+//
+// vid_showprofile CVAR
+//
+static void vid_showprofilefunc2(char *cmd, char *parms)
+{
+    const bool  vid_showprofile_old = vid_showprofile;
+
+    boolfunc2(cmd, parms);
+
+    if (vid_showprofile != vid_showprofile_old)
+        R_ClearProfile();
+}
+
 //
 // vid_vsync CVAR
 //
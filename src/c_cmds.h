@@ -37,9 +37,12 @@
 
 #include "doomtype.h"
 #include "m_config.h"
+#include "m_misc.h"
 
 #define MAXALIASES          256
 
+#define MAXCMDMATCHES       8
+
 #define DIVIDERSTRING       "------------------------------------------------------------" \
                             "------------------------------------------------------------"
 
@@ -130,6 +133,10 @@ extern action_t         actions[];
 extern const control_t  controls[];
 extern consolecmd_t     consolecmds[];
 extern alias_t          aliases[MAXALIASES];
+extern stringhash_t     actionhash;
+extern stringhash_t     consolecmdhash;
+extern int              numactions;
+extern int              numconsolecmds;
 extern bool             executingalias;
 extern bool             healthcvar;
 extern bool             massacre;
@@ -147,6 +154,8 @@ void execfunc2(char *cmd, char *parms);
 
 bool IsControlBound(const controltype_t type, const int control, const bool automaponly);
 char *C_LookupAliasFromValue(const int value, const valuealiastype_t valuealiastype);
+void C_InitHashTables(void);
 int C_GetIndex(const char *cmd);
+int C_GetActionIndex(const char *action);
 bool C_ExecuteAlias(const char *alias);
 char *C_DistanceTraveled(double feet, bool allowzero);
@@ -55,6 +55,7 @@
 #include "i_swap.h"
 #include "i_system.h"
 #include "i_timer.h"
+#include "m_array.h"
 #include "m_cheat.h"
 #include "m_config.h"
 #include "m_menu.h"
@@ -109,10 +110,16 @@ static short            colorbackwidth;
 
 char                    consoleinput[255] = "";
 int                     numconsolestrings = 0;
+int                     firstconsolestring = 0;
 int                     numvisibleconsolestrings = 0;
 static int              numvisibleconsolerows = 0;
 size_t                  consolestringsmax = 0;
 
+static char             *consolearena;
+static size_t           consolearenasize;
+static size_t           consolearenaused;
+static char             **oldconsolearenas;
+
 static size_t           undolevels;
 static undohistory_t    *undohistory;
 static size_t           maxundolevels;
@@ -145,6 +152,11 @@ static int              timerwidth;
 static int              timewidth;
 static int              zerowidth;
 
+// [BH] autocompletelist[] translated into the current language, and sorted
+static const char       **autocompletetexts;
+static int              *autocompletesorted;
+static int              numautocompletes;
+
 static byte             *consoleautomapbevelcolor;
 static byte             *consolebackcolor1;
 static byte             *consolebackcolor2;
@@ -212,7 +224,7 @@ void C_CreateTimeStamp(const int index)
     const time_t    now = time(NULL);
     struct tm       *currenttime = localtime(&now);
 
-    console[index].timestamp = *currenttime;
+    CONSOLESTRING(index).timestamp = *currenttime;
 }
 
 static bool IsEmptyConsoleMessage(const char *string)
@@ -247,7 +259,106 @@ static void C_ScrollToBottom(void)
     outputhistoryoffset = 0;
 }
 
-static void C_StoreConsoleString(char *dest, const char *src, const size_t dest_size)
+// Remove the oldest string from the console, keeping the input and output history positions within
+// the strings that are left.
+static void C_RemoveOldestConsoleString(void)
+{
+    firstconsolestring++;
+
+    if (inputhistory != -1 && inputhistory < firstconsolestring)
+        inputhistory = -1;
+
+    if (outputhistory != -1 && outputhistory < firstconsolestring)
+    {
+        outputhistory = firstconsolestring;
+        outputhistoryoffset = 0;
+    }
+}
+
+// Copy a string into the console's arena. The console's strings may be being iterated over, so
+// if there isn't room for it, none of them are moved. Instead, a new arena is started, and the
+// old one is kept until C_CompactConsoleStrings() is next called.
+static char *C_AllocConsoleString(const char *string)
+{
+    const size_t    length = strlen(string) + 1;
+
+    if (consolearenaused + length > consolearenasize)
+    {
+        if (consolearena)
+            array_push(oldconsolearenas, consolearena);
+
+        if (!consolearenasize)
+            consolearenasize = CONSOLEARENASIZE / 64;
+
+        while (length > consolearenasize)
+            consolearenasize *= 2;
+
+        consolearena = I_Malloc(consolearenasize);
+        consolearenaused = 0;
+    }
+
+    memcpy(consolearena + consolearenaused, string, length);
+    consolearenaused += length;
+
+    return (consolearena + consolearenaused - length);
+}
+
+// Move the strings of all the console strings still in the console to a new arena, making sure
+// there's room left for a string of up to CONSOLETEXTMAXLENGTH bytes. The new arena is twice the
+// size if the old one was more than half full, up to CONSOLEARENASIZE bytes, after which the
+// oldest console strings are removed instead. Only called by C_AddConsoleString(), so never while
+// the console's strings are being iterated over.
+static void C_CompactConsoleStrings(void)
+{
+    size_t  used = 0;
+    size_t  size = (consolearenasize ? consolearenasize : CONSOLEARENASIZE / 64);
+    char    *arena;
+
+    if (!array_size(oldconsolearenas) && consolearena && consolearenaused + CONSOLETEXTMAXLENGTH <= consolearenasize)
+        return;
+
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
+        used += strlen(CONSOLESTRING(i).string) + 1;
+
+    while (used + CONSOLETEXTMAXLENGTH > size / 2 && size < CONSOLEARENASIZE)
+        size *= 2;
+
+    while (used + CONSOLETEXTMAXLENGTH > size && firstconsolestring < numconsolestrings)
+    {
+        used -= strlen(CONSOLESTRING(firstconsolestring).string) + 1;
+        C_RemoveOldestConsoleString();
+    }
+
+    arena = I_Malloc(size);
+    consolearenaused = 0;
+
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
+    {
+        const size_t    len = strlen(CONSOLESTRING(i).string) + 1;
+
+        memcpy(arena + consolearenaused, CONSOLESTRING(i).string, len);
+        CONSOLESTRING(i).string = arena + consolearenaused;
+        consolearenaused += len;
+    }
+
+    for (int i = 0; i < array_size(oldconsolearenas); i++)
+        free(oldconsolearenas[i]);
+
+    array_clear(oldconsolearenas);
+    free(consolearena);
+    consolearena = arena;
+    consolearenasize = size;
+}
+
+void C_SetConsoleString(const int index, const char *string)
+{
+    // an older copy of the string will be left in the arena until it's next moved
+    CONSOLESTRING(index).string = C_AllocConsoleString(string);
+    memset(CONSOLESTRING(index).wrap, 0, sizeof(console[0].wrap));
+    CONSOLESTRING(index).wrapwidth = 0;
+}
+
+static void C_StoreConsoleString(const int index, const char *src)
 {
 #if defined(_WIN32)
     char    codepage[8] = "";
@@ -264,14 +375,56 @@ static void C_StoreConsoleString(char *dest, const char *src, const size_t dest_
             if (MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, src, -1, wide, arrlen(wide))
                 && WideCharToMultiByte(consolecodepage, 0, wide, -1, buffer, (int)sizeof(buffer), NULL, NULL))
             {
-                M_StringCopy(dest, buffer, dest_size);
+                C_SetConsoleString(index, buffer);
                 return;
             }
         }
     }
 #endif
 
-    M_StringCopy(dest, src, dest_size);
+    C_SetConsoleString(index, src);
+}
+
+//
+// C_AddConsoleString
+//
+// [BH] Add an empty string of the specified type to the end of the console,
+//  and return its index. The console is a ring buffer, so once it's grown to
+//  CONSOLESTRINGSMAX strings, the oldest string is removed each time.
+//
+int C_AddConsoleString(const stringtype_t stringtype)
+{
+    console_t   *string;
+
+    if (numconsolestrings - firstconsolestring >= (int)consolestringsmax)
+    {
+        if (consolestringsmax < CONSOLESTRINGSMAX)
+        {
+            // strings may have been removed already, so copy them to where their indices
+            //  are in the larger ring buffer
+            const size_t    size = (consolestringsmax ? consolestringsmax * 2 : CONSOLESTRINGSMAX / 8);
+            console_t       *strings = I_Malloc(size * sizeof(*strings));
+
+            for (int i = firstconsolestring; i < numconsolestrings; i++)
+                strings[i & (size - 1)] = CONSOLESTRING(i);
+
+            free(console);
+            console = strings;
+            consolestringsmax = size;
+        }
+        else
+            C_RemoveOldestConsoleString();
+    }
+
+    C_CompactConsoleStrings();
+
+    string = &CONSOLESTRING(numconsolestrings);
+    memset(string, 0, sizeof(*string));
+    string->string = C_AllocConsoleString("");
+    string->stringtype = stringtype;
+    string->count = 1;
+
+    return numconsolestrings++;
 }
 
 void C_Input(const char *string, ...)
@@ -286,14 +439,7 @@ void C_Input(const char *string, ...)
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-    console[numconsolestrings].indent = 0;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings++].stringtype = inputstring;
+    C_StoreConsoleString(C_AddConsoleString(inputstring), buffer);
     inputhistory = -1;
 
     C_ScrollToBottom();
@@ -314,14 +460,7 @@ void C_Cheat(const char *string)
 
     buffer[len] = '\0';
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    M_StringCopy(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-    console[numconsolestrings].indent = 0;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings++].stringtype = cheatstring;
+    C_SetConsoleString(C_AddConsoleString(cheatstring), buffer);
     inputhistory = -1;
 
     C_ScrollToBottom();
@@ -347,8 +486,8 @@ void C_IntegerCVAROutputNoRepeat(const char *cvar, const int value)
 
     M_snprintf(buffer, sizeof(buffer), "%s %s", cvar, temp);
 
-    if (numconsolestrings && M_StringStartsWith(console[numconsolestrings - 1].string, cvar))
-        M_StringCopy(console[numconsolestrings - 1].string, buffer, sizeof(console[0].string));
+    if (numconsolestrings && M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, cvar))
+        C_SetConsoleString(numconsolestrings - 1, buffer);
     else
         C_Input("%s", buffer);
 
@@ -370,8 +509,9 @@ void C_StringCVAROutput(const char *cvar, const char *string)
 
 void C_Output(const char *string, ...)
 {
-    va_list args;
-    char    buffer[CONSOLETEXTMAXLENGTH];
+    va_list     args;
+    char        buffer[CONSOLETEXTMAXLENGTH];
+    int         i;
 
     if (!*string || togglingvanilla)
         return;
@@ -380,52 +520,36 @@ void C_Output(const char *string, ...)
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-    console[numconsolestrings].string[0] = toupper(console[numconsolestrings].string[0]);
-    console[numconsolestrings].indent = 0;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings++].stringtype = outputstring;
+    C_StoreConsoleString((i = C_AddConsoleString(outputstring)), buffer);
+    CONSOLESTRING(i).string[0] = toupper(CONSOLESTRING(i).string[0]);
 
     C_ScrollToBottom();
 }
 
 void C_TabbedOutput(const int tabs[MAXTABS], const char *string, ...)
 {
-    va_list args;
-    char    buffer[CONSOLETEXTMAXLENGTH];
+    va_list     args;
+    char        buffer[CONSOLETEXTMAXLENGTH];
+    const int   i = C_AddConsoleString(outputstring);
 
     va_start(args, string);
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-    console[numconsolestrings].stringtype = outputstring;
-    memcpy(console[numconsolestrings].tabs, tabs, sizeof(console[0].tabs));
-    console[numconsolestrings].indent = (tabs[2] ? tabs[2] : (tabs[1] ? tabs[1] : tabs[0])) - 10;
-    console[numconsolestrings].wrapwidth = 0;
-    memset(console[numconsolestrings++].wrap, 0, sizeof(console[0].wrap));
+    C_StoreConsoleString(i, buffer);
+    memcpy(CONSOLESTRING(i).tabs, tabs, sizeof(console[0].tabs));
+    CONSOLESTRING(i).indent = (tabs[2] ? tabs[2] : (tabs[1] ? tabs[1] : tabs[0])) - 10;
 
     C_ScrollToBottom();
 }
 
 void C_Header(const int tabs[MAXTABS], patch_t *header, const char *string)
 {
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
+    const int   i = C_AddConsoleString(headerstring);
 
-    console[numconsolestrings].stringtype = headerstring;
-    memcpy(console[numconsolestrings].tabs, tabs, sizeof(console[0].tabs));
-    console[numconsolestrings].header = header;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    C_StoreConsoleString(console[numconsolestrings++].string, string, sizeof(console[0].string));
+    memcpy(CONSOLESTRING(i).tabs, tabs, sizeof(console[0].tabs));
+    CONSOLESTRING(i).header = header;
+    C_StoreConsoleString(i, string);
 
     C_ScrollToBottom();
 }
@@ -440,20 +564,16 @@ void C_Warning(const int warninglevel, const char *string, ...)
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings > 0 && console[i].stringtype == warningstring && M_StringCompare(console[i].string, buffer))
-        console[i].count++;
+    if (numconsolestrings > 0 && CONSOLESTRING(i).stringtype == warningstring
+        && M_StringCompare(CONSOLESTRING(i).string, buffer))
+        CONSOLESTRING(i).count++;
     else
     {
-        if (numconsolestrings >= (int)consolestringsmax)
-            console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-        C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-        console[numconsolestrings].indent = WARNINGWIDTH + 2;
-        memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-        console[numconsolestrings].wrapwidth = 0;
-        console[numconsolestrings].stringtype = warningstring;
-        console[numconsolestrings].count = 1;
-        console[numconsolestrings++].warninglevel = warninglevel;
+        const int   j = C_AddConsoleString(warningstring);
+
+        C_StoreConsoleString(j, buffer);
+        CONSOLESTRING(j).indent = WARNINGWIDTH + 2;
+        CONSOLESTRING(j).warninglevel = warninglevel;
     }
 
     C_ScrollToBottom();
@@ -469,30 +589,24 @@ void C_PlayerMessage(const char *string, ...)
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings > 0 && console[i].stringtype == playermessagestring
-        && M_StringCompare(console[i].string, buffer) && groupmessages)
+    if (numconsolestrings > 0 && CONSOLESTRING(i).stringtype == playermessagestring
+        && M_StringCompare(CONSOLESTRING(i).string, buffer) && groupmessages)
     {
         C_CreateTimeStamp(i);
-        console[i].count++;
+        CONSOLESTRING(i).count++;
     }
     else
     {
-        if (numconsolestrings >= (int)consolestringsmax)
-            console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
+        int j;
 
         M_StringReplaceAll(buffer, "\n", " ", false);
 
         if (IsEmptyConsoleMessage(buffer))
             return;
 
-        C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-        console[numconsolestrings].stringtype = playermessagestring;
-        C_CreateTimeStamp(numconsolestrings);
-        console[numconsolestrings].string[0] = toupper(console[numconsolestrings].string[0]);
-        console[numconsolestrings].indent = 0;
-        memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-        console[numconsolestrings].wrapwidth = 0;
-        console[numconsolestrings++].count = 1;
+        C_StoreConsoleString((j = C_AddConsoleString(playermessagestring)), buffer);
+        C_CreateTimeStamp(j);
+        CONSOLESTRING(j).string[0] = toupper(CONSOLESTRING(j).string[0]);
     }
 
     C_ScrollToBottom();
@@ -500,24 +614,18 @@ void C_PlayerMessage(const char *string, ...)
 
 void C_PlayerWarning(const char *string, ...)
 {
-    va_list args;
-    char    buffer[CONSOLETEXTMAXLENGTH];
+    va_list     args;
+    char        buffer[CONSOLETEXTMAXLENGTH];
+    const int   i = C_AddConsoleString(playerwarningstring);
 
     va_start(args, string);
     M_vsnprintf(buffer, CONSOLETEXTMAXLENGTH - 1, string, args);
     va_end(args);
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    C_StoreConsoleString(console[numconsolestrings].string, buffer, sizeof(console[0].string));
-    console[numconsolestrings].stringtype = playerwarningstring;
-    C_CreateTimeStamp(numconsolestrings);
-    console[numconsolestrings].string[0] = toupper(console[numconsolestrings].string[0]);
-    console[numconsolestrings].indent = WARNINGWIDTH + 2;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings++].count = 1;
+    C_StoreConsoleString(i, buffer);
+    C_CreateTimeStamp(i);
+    CONSOLESTRING(i).string[0] = toupper(CONSOLESTRING(i).string[0]);
+    CONSOLESTRING(i).indent = WARNINGWIDTH + 2;
 
     C_ScrollToBottom();
 }
@@ -529,10 +637,10 @@ char *C_GetPlayerName(void)
 
 void C_ResetWrappedLines(void)
 {
-    for (int i = 0; i < numconsolestrings; i++)
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
     {
-        memset(console[i].wrap, 0, sizeof(console[0].wrap));
-        console[i].wrapwidth = 0;
+        memset(CONSOLESTRING(i).wrap, 0, sizeof(console[0].wrap));
+        CONSOLESTRING(i).wrapwidth = 0;
     }
 }
 
@@ -548,14 +656,8 @@ static void C_AddToUndoHistory(void)
 
 void C_AddConsoleDivider(void)
 {
-    if (!numconsolestrings || console[numconsolestrings - 1].stringtype != dividerstring)
-    {
-        if (numconsolestrings >= (int)consolestringsmax)
-            console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-        M_StringCopy(console[numconsolestrings].string, DIVIDERSTRING, sizeof(console[0].string));
-        console[numconsolestrings++].stringtype = dividerstring;
-    }
+    if (!numconsolestrings || CONSOLESTRING(numconsolestrings - 1).stringtype != dividerstring)
+        C_SetConsoleString(C_AddConsoleString(dividerstring), DIVIDERSTRING);
 }
 
 const kern_t altkern[] =
@@ -824,63 +926,63 @@ static int C_OverlayWidth(const char *text, const bool monospaced)
 
 static bool C_IsVisibleConsoleString(const int index)
 {
-    const stringtype_t  stringtype = console[index].stringtype;
+    const stringtype_t  stringtype = CONSOLESTRING(index).stringtype;
 
     if ((stringtype == obituarystring || stringtype == playerobituarystring) && obituaries)
         C_BuildObituaryString(index);
 
     if (stringtype != dividerstring && stringtype != headerstring
-        && IsEmptyConsoleMessage(console[index].string))
+        && IsEmptyConsoleMessage(CONSOLESTRING(index).string))
         return false;
 
-    return ((stringtype != warningstring || con_warninglevel >= console[index].warninglevel || devparm)
+    return ((stringtype != warningstring || con_warninglevel >= CONSOLESTRING(index).warninglevel || devparm)
         && ((stringtype != obituarystring && stringtype != playerobituarystring) || obituaries));
 }
 
 static int C_GetWrapWidth(const int index, const int wrap)
 {
-    const stringtype_t  stringtype = console[index].stringtype;
+    const stringtype_t  stringtype = CONSOLESTRING(index).stringtype;
 
     return (((wrap || stringtype == warningstring || stringtype == playerwarningstring
-        || stringtype == playerobituarystring) ? MAX(0, CONSOLETEXTPIXELWIDTH - console[index].indent) :
+        || stringtype == playerobituarystring) ? MAX(0, CONSOLETEXTPIXELWIDTH - CONSOLESTRING(index).indent) :
         CONSOLETEXTPIXELWIDTH));
 }
 
 static void C_GetWrapPositions(const int index, int wrappositions[CONSOLEWRAPS])
 {
-    const int   len = (int)strlen(console[index].string);
-    const int   stringtype = console[index].stringtype;
-    const int   *tabs = (!console[index].indent || stringtype == warningstring || stringtype == playerwarningstring
-                    || stringtype == playerobituarystring ? NULL : console[index].tabs);
+    const int   len = (int)strlen(CONSOLESTRING(index).string);
+    const int   stringtype = CONSOLESTRING(index).stringtype;
+    const int   *tabs = (!CONSOLESTRING(index).indent || stringtype == warningstring || stringtype == playerwarningstring
+                    || stringtype == playerobituarystring ? NULL : CONSOLESTRING(index).tabs);
 
-    memset(wrappositions, 0, sizeof(console[index].wrap));
+    memset(wrappositions, 0, sizeof(CONSOLESTRING(index).wrap));
 
     if (!len)
         return;
 
-    if (console[index].wrapwidth == CONSOLETEXTPIXELWIDTH)
+    if (CONSOLESTRING(index).wrapwidth == CONSOLETEXTPIXELWIDTH)
     {
-        memcpy(wrappositions, console[index].wrap, sizeof(console[index].wrap));
+        memcpy(wrappositions, CONSOLESTRING(index).wrap, sizeof(CONSOLESTRING(index).wrap));
         return;
     }
 
-    for (int wrap = 0, start = 0; wrap < arrlen(console[index].wrap) && start < len; wrap++)
+    for (int wrap = 0, start = 0; wrap < arrlen(CONSOLESTRING(index).wrap) && start < len; wrap++)
     {
         for (int i = len; i > start; i--)
         {
-            const unsigned char breakchar = console[index].string[i];
-            const char          prev = console[index].string[i];
+            const unsigned char breakchar = CONSOLESTRING(index).string[i];
+            const char          prev = CONSOLESTRING(index).string[i];
             int                 width;
 
             if (!isbreak(breakchar))
                 continue;
 
-            if (i > 0 && console[index].string[i - 1] == ':' && (breakchar == '/' || breakchar == '\\'))
+            if (i > 0 && CONSOLESTRING(index).string[i - 1] == ':' && (breakchar == '/' || breakchar == '\\'))
                 continue;
 
-            console[index].string[i] = '\0';
-            width = C_TextWidth(&console[index].string[start], (wrap ? NULL : tabs), true, true);
-            console[index].string[i] = prev;
+            CONSOLESTRING(index).string[i] = '\0';
+            width = C_TextWidth(&CONSOLESTRING(index).string[start], (wrap ? NULL : tabs), true, true);
+            CONSOLESTRING(index).string[i] = prev;
 
             if (width <= C_GetWrapWidth(index, wrap) + 10)
             {
@@ -894,16 +996,16 @@ static void C_GetWrapPositions(const int index, int wrappositions[CONSOLEWRAPS])
             break;
     }
 
-    memcpy(console[index].wrap, wrappositions, sizeof(console[index].wrap));
-    console[index].wrapwidth = CONSOLETEXTPIXELWIDTH;
+    memcpy(CONSOLESTRING(index).wrap, wrappositions, sizeof(CONSOLESTRING(index).wrap));
+    CONSOLESTRING(index).wrapwidth = CONSOLETEXTPIXELWIDTH;
 }
 
 static int C_GetConsoleDisplayRows(const int index)
 {
-    const int   len = (int)strlen(console[index].string);
+    const int   len = (int)strlen(CONSOLESTRING(index).string);
     int         wraps[CONSOLEWRAPS];
 
-    if (!len || IsEmptyConsoleMessage(console[index].string))
+    if (!len || IsEmptyConsoleMessage(CONSOLESTRING(index).string))
         return 0;
 
     C_GetWrapPositions(index, wraps);
@@ -924,12 +1026,12 @@ static int C_GetVisibleRowForHistoryPosition(const int arrayindex, const int off
     if (offset < 0)
         return -1;
 
-    for (int i = 0; i < numconsolestrings; i++)
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
     {
         if (!C_IsVisibleConsoleString(i))
             continue;
 
-        if (console[i].stringtype == obituarystring || console[i].stringtype == playerobituarystring)
+        if (CONSOLESTRING(i).stringtype == obituarystring || CONSOLESTRING(i).stringtype == playerobituarystring)
             C_BuildObituaryString(i);
 
         if (i == arrayindex)
@@ -947,7 +1049,7 @@ static void C_GetHistoryPositionForVisibleRow(int row, int *arrayindex, int *off
 
     if ((row = MAX(-1, MIN(row, MAX(0, numvisibleconsolerows - 1)))) < 0)
     {
-        for (int i = 0; i < numconsolestrings; i++)
+        for (int i = firstconsolestring; i < numconsolestrings; i++)
             if (C_IsVisibleConsoleString(i))
             {
                 *arrayindex = i;
@@ -955,17 +1057,17 @@ static void C_GetHistoryPositionForVisibleRow(int row, int *arrayindex, int *off
                 return;
             }
 
-        *arrayindex = 0;
+        *arrayindex = firstconsolestring;
         *offset = 0;
         return;
     }
 
-    for (int i = 0, rows; i < numconsolestrings; i++)
+    for (int i = firstconsolestring, rows; i < numconsolestrings; i++)
     {
         if (!C_IsVisibleConsoleString(i))
             continue;
 
-        if (console[i].stringtype == obituarystring || console[i].stringtype == playerobituarystring)
+        if (CONSOLESTRING(i).stringtype == obituarystring || CONSOLESTRING(i).stringtype == playerobituarystring)
             C_BuildObituaryString(i);
 
         rows = C_GetConsoleDisplayRows(i);
@@ -980,7 +1082,7 @@ static void C_GetHistoryPositionForVisibleRow(int row, int *arrayindex, int *off
         visiblecount += rows;
     }
 
-    *arrayindex = 1;
+    *arrayindex = firstconsolestring + 1;
     *offset = 0;
 }
 
@@ -1108,14 +1210,18 @@ static void C_DrawScrollbar(void)
 void C_ClearConsole(void)
 {
     numconsolestrings = 0;
-    consolestringsmax = CONSOLESTRINGSMAX;
+    firstconsolestring = 0;
+    consolestringsmax = CONSOLESTRINGSMAX / 8;
     console = I_Realloc(console, consolestringsmax * sizeof(*console));
-    memset(console, 0, consolestringsmax * sizeof(*console));
-    console[numconsolestrings].string[0] = '\0';
-    console[numconsolestrings].indent = 0;
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings++].stringtype = outputstring;
+    consolearenaused = 0;
+
+    for (int i = 0; i < array_size(oldconsolearenas); i++)
+        free(oldconsolearenas[i]);
+
+    array_clear(oldconsolearenas);
+    inputhistory = -1;
+    C_ScrollToBottom();
+    C_AddConsoleString(outputstring);
 }
 
 static void C_InitEdgeColors(void)
@@ -1245,7 +1351,78 @@ void C_Init(void)
     suckswidth = C_OverlayWidth(s_STSTR_SUCKS, false);
     timewidth = C_OverlayWidth("00:00.00", true);
 
-    M_TranslateAutocomplete();
+    C_InitAutocomplete();
+}
+
+static int C_CompareAutocompletes(const void *a, const void *b)
+{
+    const int   i = *(const int *)a;
+    const int   j = *(const int *)b;
+    const int   result = strcasecmp(autocompletetexts[i], autocompletetexts[j]);
+
+    return (result ? result : i - j);
+}
+
+//
+// C_InitAutocomplete
+//
+// [BH] Translate autocompletelist[] into the current language, and sort it so
+//  that the autocompletes that start with the console input can be found
+//  using a binary search. Only autocompletes that are changed by translating
+//  them are copied.
+//
+void C_InitAutocomplete(void)
+{
+    if (!numautocompletes)
+    {
+        while (*autocompletelist[numautocompletes].text)
+            numautocompletes++;
+
+        autocompletetexts = I_Calloc(numautocompletes, sizeof(*autocompletetexts));
+        autocompletesorted = I_Malloc(numautocompletes * sizeof(*autocompletesorted));
+    }
+
+    for (int i = 0; i < numautocompletes; i++)
+    {
+        char    text[255];
+
+        if (autocompletetexts[i] != autocompletelist[i].text)
+            free((char *)autocompletetexts[i]);
+
+        M_StringCopy(text, autocompletelist[i].text, sizeof(text));
+
+        if (english == english_american)
+            M_BritishToAmericanEnglish(text);
+        else
+            M_AmericanToBritishEnglish(text);
+
+        autocompletetexts[i] = (strcmp(text, autocompletelist[i].text) ?
+            M_StringDuplicate(text) : autocompletelist[i].text);
+        autocompletesorted[i] = i;
+    }
+
+    qsort(autocompletesorted, numautocompletes, sizeof(*autocompletesorted), &C_CompareAutocompletes);
+}
+
+// Find the first autocomplete in autocompletesorted[] that starts with input if after is false, or
+// the first one after all of those if it is true.
+static int C_FindAutocomplete(const char *input, const size_t length, const bool after)
+{
+    int low = 0;
+    int high = numautocompletes;
+
+    while (low < high)
+    {
+        const int   mid = (low + high) / 2;
+        const int   result = strncasecmp(autocompletetexts[autocompletesorted[mid]], input, length);
+
+        if (result < 0 || (after && !result))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
 }
 
 void C_ShowConsole(bool reset)
@@ -1583,7 +1760,7 @@ static int C_DrawConsoleText(int x, int y, char *text, const int color1, const i
     const int           len = (int)strlen(text);
     int                 startx = x;
     unsigned char       prevletter3 = '\0';
-    const stringtype_t  stringtype = console[index].stringtype;
+    const stringtype_t  stringtype = CONSOLESTRING(index).stringtype;
 
     y -= CONSOLEHEIGHT - consoleheight;
 
@@ -1922,7 +2099,7 @@ static void C_DrawOverlayText(byte *screen, const int screenwidth,
 static void C_DrawTimeStamp(int x, const int y, const int index, const int color)
 {
     char        buffer[9];
-    struct tm   timestamp = console[index].timestamp;
+    struct tm   timestamp = CONSOLESTRING(index).timestamp;
 
     if (con_timestampformat == con_timestampformat_standard)
     {
@@ -2385,6 +2562,101 @@ void C_UpdatePlayerStatsOverlay(void)
     }
 }
 
+void C_UpdateProfileOverlay(void)
+{
+    const int       x = OVERLAYTEXTX;
+    int             y = OVERLAYTEXTY + OVERLAYLINEHEIGHT + OVERLAYSPACING;
+    const uint64_t  now = I_GetTimeMS();
+    static uint64_t lastupdate = 0;
+    static char     stages[NUMPROFILESTAGES + 1][16];
+    static char     counters[NUMPROFILECOUNTERS][16];
+    static char     peaks[NUMPROFILECOUNTERS][20];
+    static int      labelwidth;
+    static int      valuewidth;
+
+    if (!numprofileframes)
+        return;
+
+    C_GetOverlayTextColors();
+
+    if (!labelwidth)
+    {
+        for (int i = 0; i < NUMPROFILESTAGES; i++)
+            labelwidth = MAX(labelwidth, C_OverlayWidth(profilestagenames[i], false));
+
+        for (int i = 0; i < NUMPROFILECOUNTERS; i++)
+            labelwidth = MAX(labelwidth, C_OverlayWidth(profilecounternames[i], false));
+
+        valuewidth = C_OverlayWidth("000.00 ms", true);
+    }
+
+    // [BH] average the timings over the rolling window, but only update them
+    //  twice a second so they're readable
+    if (now - lastupdate >= 500)
+    {
+        int64_t stagetotals[NUMPROFILESTAGES + 1] = { 0 };
+        int64_t countertotals[NUMPROFILECOUNTERS] = { 0 };
+        int     counterpeaks[NUMPROFILECOUNTERS] = { 0 };
+
+        for (int i = 0; i < numprofileframes; i++)
+        {
+            for (int j = 0; j < NUMPROFILESTAGES; j++)
+            {
+                stagetotals[j] += profileframes[i].stages[j];
+                stagetotals[NUMPROFILESTAGES] += profileframes[i].stages[j];
+            }
+
+            for (int j = 0; j < NUMPROFILECOUNTERS; j++)
+            {
+                countertotals[j] += profileframes[i].counters[j];
+                counterpeaks[j] = MAX(counterpeaks[j], profileframes[i].counters[j]);
+            }
+        }
+
+        for (int i = 0; i <= NUMPROFILESTAGES; i++)
+            M_snprintf(stages[i], sizeof(stages[i]), "%.2f ms",
+                stagetotals[i] / 1000.0 / numprofileframes);
+
+        for (int i = 0; i < NUMPROFILECOUNTERS; i++)
+        {
+            char    *temp = commify((countertotals[i] + numprofileframes / 2) / numprofileframes);
+
+            M_StringCopy(counters[i], temp, sizeof(counters[i]));
+            free(temp);
+
+            // [BH] also show the high-water mark, which the render pools are sized from
+            temp = commify(counterpeaks[i]);
+            M_snprintf(peaks[i], sizeof(peaks[i]), "(%s)", temp);
+            free(temp);
+        }
+
+        lastupdate = now;
+    }
+
+    for (int i = 0; i <= NUMPROFILESTAGES; i++)
+    {
+        C_DrawOverlayText(screens[0], SCREENWIDTH, x, y,
+            (i < NUMPROFILESTAGES ? profilestagenames[i] : "Total"), false);
+        C_DrawOverlayText(screens[0], SCREENWIDTH,
+            x + labelwidth + valuewidth - C_OverlayWidth(stages[i], true), y, stages[i], true);
+        y += OVERLAYLINEHEIGHT;
+    }
+
+    if (gamestate != GS_LEVEL)
+        return;
+
+    y += OVERLAYSPACING;
+
+    for (int i = 0; i < NUMPROFILECOUNTERS; i++)
+    {
+        C_DrawOverlayText(screens[0], SCREENWIDTH, x, y, profilecounternames[i], false);
+        C_DrawOverlayText(screens[0], SCREENWIDTH,
+            x + labelwidth + valuewidth - C_OverlayWidth(counters[i], true), y, counters[i], true);
+        C_DrawOverlayText(screens[0], SCREENWIDTH, x + labelwidth + valuewidth + spacewidth, y, peaks[i], true);
+        y += OVERLAYLINEHEIGHT;
+    }
+}
+
 static bool IsCheatSequence(char *string)
 {
     const int   len = (int)strlen(string);
@@ -2462,7 +2734,7 @@ static int C_CountVisibleStrings(void)
 {
     int count = 0;
 
-    for (int i = 0; i < numconsolestrings; i++)
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
         if (C_IsVisibleConsoleString(i))
             count++;
 
@@ -2473,12 +2745,12 @@ static int C_CountVisibleRows(void)
 {
     int count = 0;
 
-    for (int i = 0; i < numconsolestrings; i++)
+    for (int i = firstconsolestring; i < numconsolestrings; i++)
     {
         if (!C_IsVisibleConsoleString(i))
             continue;
 
-        if (console[i].stringtype == obituarystring || console[i].stringtype == playerobituarystring)
+        if (CONSOLESTRING(i).stringtype == obituarystring || CONSOLESTRING(i).stringtype == playerobituarystring)
             C_BuildObituaryString(i);
 
         count += C_GetConsoleDisplayRows(i);
@@ -2495,30 +2767,30 @@ static char *C_GetWrappedTextSegment(const int index, const int start, const int
     bool    monospaced = false;
     char    prefix[5] = "";
     int     prefixlen = 0;
-    char    *text = M_SubString(console[index].string, start, (size_t)(end - start));
+    char    *text = M_SubString(CONSOLESTRING(index).string, start, (size_t)(end - start));
 
     for (int i = 0; i < start; i++)
-        if (console[index].string[i] == BOLDONCHAR)
+        if (CONSOLESTRING(index).string[i] == BOLDONCHAR)
         {
             if (bold)
                 bolder = true;
             else
                 bold = true;
         }
-        else if (console[index].string[i] == BOLDOFFCHAR)
+        else if (CONSOLESTRING(index).string[i] == BOLDOFFCHAR)
         {
             if (bolder)
                 bolder = false;
             else
                 bold = false;
         }
-        else if (console[index].string[i] == ITALICSONCHAR)
+        else if (CONSOLESTRING(index).string[i] == ITALICSONCHAR)
             italics = true;
-        else if (console[index].string[i] == ITALICSOFFCHAR)
+        else if (CONSOLESTRING(index).string[i] == ITALICSOFFCHAR)
             italics = false;
-        else if (console[index].string[i] == MONOSPACEDONCHAR)
+        else if (CONSOLESTRING(index).string[i] == MONOSPACEDONCHAR)
             monospaced = true;
-        else if (console[index].string[i] == MONOSPACEDOFFCHAR)
+        else if (CONSOLESTRING(index).string[i] == MONOSPACEDOFFCHAR)
             monospaced = false;
 
     if (bold)
@@ -2549,8 +2821,8 @@ static char *C_GetWrappedTextSegment(const int index, const int start, const int
 static void C_DrawConsoleStringParts(const int index, const int row, const int toprow,
     const int bottomrow, const int outputyoffset, const int notabs[MAXTABS])
 {
-    const stringtype_t  stringtype = console[index].stringtype;
-    const int           len = (int)strlen(console[index].string);
+    const stringtype_t  stringtype = CONSOLESTRING(index).stringtype;
+    const int           len = (int)strlen(CONSOLESTRING(index).string);
     int                 wraps[CONSOLEWRAPS] = { 0 };
     int                 start = 0;
 
@@ -2572,12 +2844,12 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
         {
             if (!part)
             {
-                char    *temp1 = (end < len ? M_SubString(console[index].string, 0, end) :
-                            M_StringDuplicate(console[index].string));
+                char    *temp1 = (end < len ? M_SubString(CONSOLESTRING(index).string, 0, end) :
+                            M_StringDuplicate(CONSOLESTRING(index).string));
 
                 if (stringtype == playermessagestring || stringtype == obituarystring)
                 {
-                    const int   count = console[index].count;
+                    const int   count = CONSOLESTRING(index).count;
 
                     if (count > 1)
                     {
@@ -2601,7 +2873,7 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
                 }
                 else if (stringtype == outputstring)
                     C_DrawConsoleText(CONSOLETEXTX, y, temp1, consoleoutputcolor, NOBACKGROUNDCOLOR,
-                        consoleboldcolor, tinttab66, console[index].tabs, true, true, false, index, '\0', '\0',
+                        consoleboldcolor, tinttab66, CONSOLESTRING(index).tabs, true, true, false, index, '\0', '\0',
                         &V_DrawConsoleTextPatch);
                 else if (stringtype == inputstring || stringtype == cheatstring)
                     C_DrawConsoleText(CONSOLETEXTX, y, temp1, consoleinputcolor, NOBACKGROUNDCOLOR,
@@ -2609,7 +2881,7 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
                         &V_DrawConsoleTextPatch);
                 else if (stringtype == warningstring)
                 {
-                    const int   count = console[index].count;
+                    const int   count = CONSOLESTRING(index).count;
 
                     if (count > 1)
                     {
@@ -2629,7 +2901,7 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
                 }
                 else if (stringtype == playerwarningstring || stringtype == playerobituarystring)
                 {
-                    const int   count = console[index].count;
+                    const int   count = CONSOLESTRING(index).count;
 
                     if (count > 1)
                     {
@@ -2653,11 +2925,11 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
                 }
                 else if (con_edgecolor == con_edgecolor_auto)
                     V_DrawConsoleHeaderPatch(CONSOLETEXTX, y + 4 - (CONSOLEHEIGHT - consoleheight),
-                        console[index].header, CONSOLEHEADERWIDTH, consoleedgecolor1,
+                        CONSOLESTRING(index).header, CONSOLEHEADERWIDTH, consoleedgecolor1,
                         I_GetContrastingColor(consoleedgecolor1 >> 8));
                 else
                     V_DrawConsoleHeaderPatch(CONSOLETEXTX, y + 4 - (CONSOLEHEIGHT - consoleheight),
-                        console[index].header, CONSOLEHEADERWIDTH, (nearestcolors[con_edgecolor] << 8),
+                        CONSOLESTRING(index).header, CONSOLEHEADERWIDTH, (nearestcolors[con_edgecolor] << 8),
                         I_GetContrastingColor(nearestcolors[con_edgecolor]));
 
                 free(temp1);
@@ -2666,7 +2938,7 @@ static void C_DrawConsoleStringParts(const int index, const int row, const int t
             {
                 char    *temp = C_GetWrappedTextSegment(index, start, end);
 
-                C_DrawConsoleText(CONSOLETEXTX + console[index].indent, y, trimwhitespace(temp),
+                C_DrawConsoleText(CONSOLETEXTX + CONSOLESTRING(index).indent, y, trimwhitespace(temp),
                     consolecolors[stringtype], NOBACKGROUNDCOLOR, consoleboldcolors[stringtype], tinttab66,
                     notabs, true, true, (end >= len), 0, '\0', '\0', &V_DrawConsoleTextPatch);
                 free(temp);
@@ -2795,10 +3067,10 @@ void C_Drawer(void)
     topofconsole = (toprow < 0);
 
     // draw console text
-    for (i = 0, len = 0; i < numconsolestrings; i++)
+    for (i = firstconsolestring, len = 0; i < numconsolestrings; i++)
     {
         int                 rows;
-        const stringtype_t  stringtype = console[i].stringtype;
+        const stringtype_t  stringtype = CONSOLESTRING(i).stringtype;
 
         if (!C_IsVisibleConsoleString(i))
             continue;
@@ -2842,7 +3114,7 @@ void C_Drawer(void)
                 }
             }
         }
-        else if (strlen(console[i].string))
+        else if (strlen(CONSOLESTRING(i).string))
             C_DrawConsoleStringParts(i, len, toprow, bottomrow, outputyoffset, notabs);
 
         len += rows;
@@ -3024,34 +3296,74 @@ bool C_ExecuteInputString(const char *input)
     return true;
 }
 
+// Add the CCMDs, CVARs and cheats that might be called key to a list of candidates, keeping them in
+// the order they're in consolecmds[] without any duplicates.
+static int C_AddCandidates(const char *key, int *candidates, int numcandidates)
+{
+    int         indices[MAXCMDMATCHES];
+    const int   count = M_FindAllInStringHash(&consolecmdhash, key, indices, MAXCMDMATCHES);
+
+    for (int i = 0; i < count; i++)
+    {
+        int j = numcandidates;
+
+        for (; j > 0 && candidates[j - 1] > indices[i]; j--);
+
+        if (j > 0 && candidates[j - 1] == indices[i])
+            continue;
+
+        memmove(&candidates[j + 1], &candidates[j], (numcandidates - j) * sizeof(*candidates));
+        candidates[j] = indices[i];
+        numcandidates++;
+    }
+
+    return numcandidates;
+}
+
 bool C_ValidateInput(char *input)
 {
     const int   length = (int)strlen(input);
+    int         candidates[MAXCMDMATCHES * 3];
+    int         numcandidates = 0;
+    char        cheat[128] = "";
+    char        cmd[128] = "";
+    char        parms[128] = "";
+    int         actionindices[MAXCMDMATCHES];
+    int         numactionindices;
+
+    // [BH] look up the CCMDs, CVARs and cheats that input might be calling rather than trying them all
+    numcandidates = C_AddCandidates(input, candidates, numcandidates);
+
+    if (length > 2 && isdigit((int)input[length - 2]) && isdigit((int)input[length - 1]))
+    {
+        M_StringCopy(cheat, input, sizeof(cheat));
+        cheat[length - 2] = '\0';
+        numcandidates = C_AddCandidates(cheat, candidates, numcandidates);
+    }
+
+    if (sscanf(input, "%127s %127[^\n]", cmd, parms) > 0)
+        numcandidates = C_AddCandidates(cmd, candidates, numcandidates);
 
-    for (int i = 0; *consolecmds[i].name; i++)
+    for (int j = 0; j < numcandidates; j++)
     {
-        char    cmd[128] = "";
+        const int   i = candidates[j];
 
         if (consolecmds[i].type == CT_CHEAT)
         {
             if (consolecmds[i].parameters)
             {
-                if (isdigit((int)input[length - 2]) && isdigit((int)input[length - 1]))
+                if (*cheat)
                 {
                     consolecheatparm[0] = input[length - 2];
                     consolecheatparm[1] = input[length - 1];
                     consolecheatparm[2] = '\0';
 
-                    M_StringCopy(cmd, input, sizeof(cmd));
-                    cmd[length - 2] = '\0';
-
-                    if (M_StringCompare(cmd, consolecmds[i].name)
-                        && length == strlen(cmd) + 2
+                    if (M_StringCompare(cheat, consolecmds[i].name)
                         && consolecmds[i].func1(consolecmds[i].name, consolecheatparm))
                     {
                         if (gamestate == GS_LEVEL)
                         {
-                            M_StringCopy(consolecheat, cmd, sizeof(consolecheat));
+                            M_StringCopy(consolecheat, cheat, sizeof(consolecheat));
                             C_HideConsoleAndMenu();
                         }
 
@@ -3067,46 +3379,46 @@ bool C_ValidateInput(char *input)
                 return true;
             }
         }
-        else
+        else if (*cmd)
         {
-            char    parms[128] = "";
-
-            if (sscanf(input, "%127s %127[^\n]", cmd, parms) > 0)
-            {
-                char    *temp = M_StringDuplicate(parms);
+            char    *temp = M_StringDuplicate(parms);
 
-                if (!(strlen(temp) == 2 && temp[0] == '"' && temp[1] == '"'))
-                    M_StripQuotes(temp);
+            if (!(strlen(temp) == 2 && temp[0] == '"' && temp[1] == '"'))
+                M_StripQuotes(temp);
 
-                if ((M_StringCompare(cmd, consolecmds[i].name)
-                    || M_StringCompare(cmd, consolecmds[i].altspelling)
-                    || M_StringCompare(cmd, consolecmds[i].alternate))
-                    && consolecmds[i].func1(consolecmds[i].name, temp)
-                    && (consolecmds[i].parameters || !*temp))
+            if ((M_StringCompare(cmd, consolecmds[i].name)
+                || M_StringCompare(cmd, consolecmds[i].altspelling)
+                || M_StringCompare(cmd, consolecmds[i].alternate))
+                && consolecmds[i].func1(consolecmds[i].name, temp)
+                && (consolecmds[i].parameters || !*temp))
+            {
+                if (!executingalias && !resettingcvar && !togglingcvar && !parsingcfgfile)
                 {
-                    if (!executingalias && !resettingcvar && !togglingcvar && !parsingcfgfile)
-                    {
-                        if (temp[0] != '\0')
-                            C_Input((input[length - 1] == '%' ? "%s %s%" : "%s %s"), cmd, parms);
-                        else
-                            C_Input("%s%s", cmd, (input[length - 1] == ' ' ? " " : ""));
-                    }
-
-                    consolecmds[i].func2(consolecmds[i].name, temp);
-                    free(temp);
-
-                    return true;
+                    if (temp[0] != '\0')
+                        C_Input((input[length - 1] == '%' ? "%s %s%" : "%s %s"), cmd, parms);
+                    else
+                        C_Input("%s%s", cmd, (input[length - 1] == ' ' ? " " : ""));
                 }
 
+                consolecmds[i].func2(consolecmds[i].name, temp);
                 free(temp);
+
+                return true;
             }
+
+            free(temp);
         }
     }
 
     if (C_ExecuteAlias(input))
         return true;
 
-    for (int i = 0; *actions[i].action; i++)
+    numactionindices = M_FindAllInStringHash(&actionhash, input, actionindices, MAXCMDMATCHES);
+
+    for (int j = 0; j < numactionindices; j++)
+    {
+        const int   i = actionindices[j];
+
         if (M_StringCompare(input, actions[i].action))
         {
             C_Input("%s", input);
@@ -3121,6 +3433,7 @@ bool C_ValidateInput(char *input)
 
             return true;
         }
+    }
 
     return false;
 }
@@ -3377,7 +3690,6 @@ bool C_Responder(event_t *ev)
                 if (consoleinput[0] != '\0' && caretpos == len)
                 {
                     const int   scrolldirection = ((modstate & KMOD_SHIFT) ? -1 : 1);
-                    const int   start = autocomplete;
                     const bool  singlecommand = (M_StringStartsWith(consoleinput, "bind ")
                                     || M_StringStartsWith(consoleinput, "unbind ")
                                     || M_StringStartsWith(consoleinput, "alias "));
@@ -3421,59 +3733,67 @@ bool C_Responder(event_t *ev)
                     spaces1 = numspaces(input);
                     endspace1 = (input[strlen(input) - 1] == ' ');
 
-                    while ((scrolldirection == -1 && autocomplete > 0)
-                        || (scrolldirection == 1 && (autocomplete == -1 || *autocompletelist[autocomplete].text)))
+                    if (input[strlen(input) - 1] != '+')
                     {
-                        static char output[255];
-
-                        autocomplete += scrolldirection;
-                        M_StringCopy(output, autocompletelist[autocomplete].text, sizeof(output));
-
-                        if (!M_StringCompare(output, input))
+                        const size_t    length = strlen(input);
+                        const int       last = C_FindAutocomplete(input, length, true);
+                        const int       games = ((1 << DOOM1AND2)
+                                            | (gamemission == pack_plut ? (1 << PLUTONIAONLY) : 0)
+                                            | (gamemission == pack_tnt ? (1 << TNTONLY) : 0)
+                                            | (gamemission == pack_nerve ? (1 << NERVEONLY) : 0)
+                                            | (gamemission == pack_masterlevels ? (1 << MASTERLEVELSONLY) : 0)
+                                            | (legacyofrust ? (1 << LEGACYOFRUSTONLY) : 0)
+                                            | (gamemission == doom ? (1 << DOOM1ONLY) : (1 << DOOM2ONLY)));
+                        int             next = -1;
+
+                        // [BH] of the autocompletes that start with input, find the next one in
+                        //  autocompletelist[] in the direction being scrolled
+                        for (int j = C_FindAutocomplete(input, length, false); j < last; j++)
                         {
-                            const int   game = autocompletelist[autocomplete].game;
-                            const int   len2 = (int)strlen(output);
-                            const int   spaces2 = numspaces(output);
-                            const bool  endspace2 = (len2 > 0 && output[len2 - 1] == ' ');
-
-                            if ((game == DOOM1AND2
-                                || (gamemission == pack_plut && game == PLUTONIAONLY)
-                                || (gamemission == pack_tnt && game == TNTONLY)
-                                || (gamemission == pack_nerve && game == NERVEONLY)
-                                || (gamemission == pack_masterlevels && game == MASTERLEVELSONLY)
-                                || (legacyofrust && game == LEGACYOFRUSTONLY)
-                                || (gamemission == doom && game == DOOM1ONLY)
-                                || (gamemission != doom && game == DOOM2ONLY))
-                                && M_StringStartsWith(output, input)
-                                && input[strlen(input) - 1] != '+'
+                            const int   k = autocompletesorted[j];
+                            const char  *text = autocompletetexts[k];
+                            const int   len2 = (int)strlen(text);
+                            const int   spaces2 = numspaces(text);
+                            const bool  endspace2 = (len2 > 0 && text[len2 - 1] == ' ');
+
+                            if ((scrolldirection == 1 ? (k > autocomplete && (next == -1 || k < next)) :
+                                (k < autocomplete && k > next))
+                                && (games & (1 << autocompletelist[k].game))
+                                && !M_StringCompare(text, input)
                                 && ((!spaces1 && (!spaces2 || (spaces2 == 1 && endspace2)))
                                     || (spaces1 == 1 && !endspace1 && (spaces2 == 1 || (spaces2 == 2 && endspace2)))
                                     || (spaces1 == 2 && !endspace1 && (spaces2 == 2 || (spaces2 == 3 && endspace2)))
                                     || (spaces1 == 3 && !endspace1)))
-                            {
-                                char    *temp;
-
-                                if (isuppercase(input))
-                                    temp = M_StringJoin(prefix, M_StringReplaceFirst(uppercase(output), input, input),
-                                        NULL);
-                                else if (islowercase(input))
-                                    temp = M_StringJoin(prefix, M_StringReplaceFirst(lowercase(output), input, input),
-                                        NULL);
-                                else
-                                    temp = M_StringJoin(prefix, M_StringReplaceFirst(output, input, input), NULL);
-
-                                C_AddToUndoHistory();
-                                M_StringCopy(consoleinput, temp, sizeof(consoleinput));
-                                caretpos = selectstart = selectend = len2 + (int)strlen(prefix);
-                                caretwait = I_GetTimeMS() + CARETBLINKTIME;
-                                showcaret = true;
-                                free(temp);
-                                return true;
-                            }
+                                next = k;
+                        }
+
+                        if (next != -1)
+                        {
+                            static char output[255];
+                            char        *temp;
+
+                            autocomplete = next;
+                            M_StringCopy(output, autocompletetexts[next], sizeof(output));
+
+                            if (isuppercase(input))
+                                temp = M_StringJoin(prefix, M_StringReplaceFirst(uppercase(output), input, input),
+                                    NULL);
+                            else if (islowercase(input))
+                                temp = M_StringJoin(prefix, M_StringReplaceFirst(lowercase(output), input, input),
+                                    NULL);
+                            else
+                                temp = M_StringJoin(prefix, M_StringReplaceFirst(output, input, input), NULL);
+
+                            C_AddToUndoHistory();
+                            M_StringCopy(consoleinput, temp, sizeof(consoleinput));
+                            caretpos = selectstart = selectend = (int)strlen(output) + (int)strlen(prefix);
+                            caretwait = I_GetTimeMS() + CARETBLINKTIME;
+                            showcaret = true;
+                            free(temp);
+                            return true;
                         }
                     }
 
-                    autocomplete = start;
                 }
 
                 break;
@@ -3493,13 +3813,13 @@ bool C_Responder(event_t *ev)
                     if (inputhistory == -1)
                         M_StringCopy(currentinput, consoleinput, sizeof(currentinput));
 
-                    for (i = (inputhistory == -1 ? numconsolestrings : inputhistory) - 1; i >= 0; i--)
-                        if (console[i].stringtype == inputstring
-                            && !M_StringCompare(consoleinput, console[i].string)
-                            && C_TextWidth(console[i].string, NULL, false, true) <= CONSOLEINPUTPIXELWIDTH)
+                    for (i = (inputhistory == -1 ? numconsolestrings : inputhistory) - 1; i >= firstconsolestring; i--)
+                        if (CONSOLESTRING(i).stringtype == inputstring
+                            && !M_StringCompare(consoleinput, CONSOLESTRING(i).string)
+                            && C_TextWidth(CONSOLESTRING(i).string, NULL, false, true) <= CONSOLEINPUTPIXELWIDTH)
                         {
                             inputhistory = i;
-                            M_StringCopy(consoleinput, console[i].string, sizeof(consoleinput));
+                            M_StringCopy(consoleinput, CONSOLESTRING(i).string, sizeof(consoleinput));
                             caretpos = selectstart = selectend = (int)strlen(consoleinput);
                             caretwait = I_GetTimeMS() + CARETBLINKTIME;
                             showcaret = true;
@@ -3524,12 +3844,12 @@ bool C_Responder(event_t *ev)
                     if (inputhistory != -1)
                     {
                         for (i = inputhistory + 1; i < numconsolestrings; i++)
-                            if (console[i].stringtype == inputstring
-                                && !M_StringCompare(consoleinput, console[i].string)
-                                && C_TextWidth(console[i].string, NULL, false, true) <= CONSOLEINPUTPIXELWIDTH)
+                            if (CONSOLESTRING(i).stringtype == inputstring
+                                && !M_StringCompare(consoleinput, CONSOLESTRING(i).string)
+                                && C_TextWidth(CONSOLESTRING(i).string, NULL, false, true) <= CONSOLEINPUTPIXELWIDTH)
                             {
                                 inputhistory = i;
-                                M_StringCopy(consoleinput, console[i].string, sizeof(consoleinput));
+                                M_StringCopy(consoleinput, CONSOLESTRING(i).string, sizeof(consoleinput));
                                 break;
                             }
 
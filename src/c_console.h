@@ -44,7 +44,11 @@
 #include "hu_lib.h"
 #include "r_defs.h"
 
-#define CONSOLESTRINGSMAX                   1024
+// [BH] the console is a ring buffer of up to this many strings (must be a power of 2),
+//  with their text in an arena of up to CONSOLEARENASIZE bytes
+#define CONSOLESTRINGSMAX                   8192
+#define CONSOLEARENASIZE                    (1024 * 1024)
+#define CONSOLESTRING(i)                    console[(i) & (consolestringsmax - 1)]
 
 #define CONSOLEFONTSTART                    32
 #define CONSOLEFONTEND                      255
@@ -181,7 +185,7 @@ typedef enum
 
 typedef struct
 {
-    char            string[1024];
+    char            *string;
     int             count;
     stringtype_t    stringtype;
     int             wrap[CONSOLEWRAPS];
@@ -211,7 +215,7 @@ typedef struct
 
 typedef struct
 {
-    char            text[255];
+    const char      *text;
     const int       game;
 } autocomplete_t;
 
@@ -239,6 +243,7 @@ extern int              consoledirection;
 
 extern char             consoleinput[255];
 extern int              numconsolestrings;
+extern int              firstconsolestring;
 extern size_t           consolestringsmax;
 
 extern int              caretpos;
@@ -264,9 +269,11 @@ extern bool             scrollbardrawn;
 extern const kern_t     kern[];
 extern const kern_t     altkern[];
 
-extern autocomplete_t   autocompletelist[];
+extern const autocomplete_t autocompletelist[];
 
 void C_CreateTimeStamp(const int index);
+int C_AddConsoleString(const stringtype_t stringtype);
+void C_SetConsoleString(const int index, const char *string);
 void C_Input(const char *string, ...);
 void C_Cheat(const char *string);
 void C_IntegerCVAROutput(const char *cvar, const int value);
@@ -284,6 +291,7 @@ void C_ResetWrappedLines(void);
 void C_AddConsoleDivider(void);
 void C_ClearConsole(void);
 void C_Init(void);
+void C_InitAutocomplete(void);
 void C_ShowConsole(bool reset);
 void C_HideConsole(void);
 void C_HideConsoleAndMenu(void);
@@ -302,6 +310,7 @@ void C_UpdateTimerOverlay(void);
 void C_UpdatePathOverlay(void);
 void C_UpdatePlayerStatsOverlay(void);
 void C_UpdatePlayerPositionOverlay(void);
+void C_UpdateProfileOverlay(void);
 int C_TextWidth(const char *text, const int tabs[MAXTABS], const bool formatting, const bool kerning);
 
 #if defined(_WIN32)
@@ -206,16 +206,13 @@ static const char *C_KillVerb(const mobjtype_t target, const bool gibbed)
 
 void C_BuildObituaryString(const int index)
 {
-    const obituaryinfo_t    *obituary = &console[index].obituary;
-    char                    *buffer = console[index].string;
-    char                    oldstring[sizeof(console[index].string)];
-    const int               buffersize = (int)sizeof(console[index].string);
+    const obituaryinfo_t    *obituary = &CONSOLESTRING(index).obituary;
+    char                    buffer[CONSOLETEXTMAXLENGTH] = "";
+    const int               buffersize = (int)sizeof(buffer);
     const mobjtype_t        target = obituary->target;
     const mobjtype_t        inflicter = obituary->inflicter;
     const mobjtype_t        source = obituary->source;
 
-    memcpy(oldstring, buffer, sizeof(oldstring));
-
     if (obituary->targetisplayer)
     {
         const char  *deh = C_GetDEHObituaryString(obituary);
@@ -497,11 +494,9 @@ finish:
     if (buffer[0])
         buffer[0] = (char)toupper(buffer[0]);
 
-    if (M_StringCompare(oldstring, buffer))
-    {
-        memset(console[index].wrap, 0, sizeof(console[0].wrap));
-        console[index].wrapwidth = 0;
-    }
+    // [BH] only replace the string, and so have to wrap it again, if it has changed
+    if (strcmp(CONSOLESTRING(index).string, buffer))
+        C_SetConsoleString(index, buffer);
 }
 
 static bool C_SameObituary(const obituaryinfo_t *a, const obituaryinfo_t *b)
@@ -658,7 +653,7 @@ static bool C_SameObituary(const obituaryinfo_t *a, const obituaryinfo_t *b)
 void C_WriteObituary(mobj_t *target, mobj_t *inflicter, mobj_t *source,
     const bool gibbed, const bool telefragged, const bool crushed)
 {
-    const int       i = MAX(0, numconsolestrings - 1);
+    int             i = MAX(0, numconsolestrings - 1);
     obituaryinfo_t  obituary = { 0 };
     mobj_t          *obituarysource = source;
 
@@ -737,44 +732,32 @@ void C_WriteObituary(mobj_t *target, mobj_t *inflicter, mobj_t *source,
 
     if (groupmessages
         && numconsolestrings > 0
-        && console[i].stringtype == obituarystring
-        && C_SameObituary(&console[i].obituary, &obituary))
+        && CONSOLESTRING(i).stringtype == obituarystring
+        && C_SameObituary(&CONSOLESTRING(i).obituary, &obituary))
     {
-        console[i].obituary = obituary;
+        CONSOLESTRING(i).obituary = obituary;
         C_CreateTimeStamp(i);
-        console[i].count++;
+        CONSOLESTRING(i).count++;
         outputhistory = -1;
         return;
     }
 
-    if (numconsolestrings >= (int)consolestringsmax)
-        console = I_Realloc(console, (consolestringsmax += CONSOLESTRINGSMAX) * sizeof(*console));
-
-    memset(console[numconsolestrings].wrap, 0, sizeof(console[0].wrap));
-    console[numconsolestrings].wrapwidth = 0;
-    console[numconsolestrings].count = 1;
-    C_CreateTimeStamp(numconsolestrings);
+    i = C_AddConsoleString(obituary.targetisplayer ? playerobituarystring : obituarystring);
+    C_CreateTimeStamp(i);
 
-    console[numconsolestrings].obituary = obituary;
+    CONSOLESTRING(i).obituary = obituary;
 
     if (obituary.targetisplayer)
     {
-        console[numconsolestrings].stringtype = playerobituarystring;
-        console[numconsolestrings].indent = WARNINGWIDTH + 2;
+        CONSOLESTRING(i).indent = WARNINGWIDTH + 2;
 
         if (obituaries)
         {
-            C_BuildObituaryString(numconsolestrings);
-            HU_SetPlayerMessage(console[numconsolestrings].string, false, false);
+            C_BuildObituaryString(i);
+            HU_SetPlayerMessage(CONSOLESTRING(i).string, false, false);
             message_warning = true;
         }
     }
-    else
-    {
-        console[numconsolestrings].stringtype = obituarystring;
-        console[numconsolestrings].indent = 0;
-    }
 
-    numconsolestrings++;
     outputhistory = -1;
 }
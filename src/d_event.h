@@ -75,7 +75,8 @@ typedef enum
     ga_victory,
     ga_worlddone,
     ga_autoloadgame,
-    ga_autosavegame
+    ga_autosavegame,
+    ga_playdemo
 } gameaction_t;
 
 //
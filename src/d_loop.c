@@ -57,6 +57,13 @@ void TryRunTics(void)
     lastmadetic += newtics;
     fractionaltic = ((I_GetTimeMS() * TICRATE) % 1000) * FRACUNIT / 1000;
 
+    // [BH] run exactly one tic per frame, as fast as possible, while timing a demo
+    if (timingdemo)
+    {
+        newtics = (maketic == gametime);
+        fractionaltic = FRACUNIT - 1;
+    }
+
     while (newtics--)
     {
         I_StartTic();
@@ -323,6 +323,7 @@ void D_Display(void)
     uint64_t            wipestart;
     bool                done;
 
+    R_StartProfileFrame();
     I_UpdateDiscordRPC();
 
     if (vid_capfps != TICRATE && (realframe = (gametime > saved_gametime)))
@@ -341,7 +342,7 @@ void D_Display(void)
         HU_DrawDisk();
 
     // save the current screen if about to wipe
-    if ((dowipe = (gamestate != wipegamestate || forcewipe)))
+    if ((dowipe = ((gamestate != wipegamestate || forcewipe) && !timingdemo)))
     {
         fadecount = 0;
 
@@ -359,6 +360,9 @@ void D_Display(void)
         }
     }
 
+    // [BH] everything up to here, including starting a wipe, is timed separately from the HUD
+    R_ProfileStage(PROFILE_SETUP);
+
     if (gamestate != GS_LEVEL)
     {
         if (gamestate != oldgamestate)
@@ -392,6 +396,8 @@ void D_Display(void)
 
         updateswirl = (r_liquid_swirl && !(consoleactive || helpscreen || paused || (viewplayer->cheats & CF_FREEZE)));
 
+        R_ProfileStage(PROFILE_SETUP);
+
         // draw the view directly
         R_RenderPlayerView();
 
@@ -458,6 +464,9 @@ void D_Display(void)
             if (!takingcleancreenshot && vid_showfps && !dowipe && !splashscreen && framespersecond)
                 C_UpdateFPSOverlay();
 
+            if (!takingcleancreenshot && vid_showprofile && !dowipe && !splashscreen)
+                C_UpdateProfileOverlay();
+
             if (!takingcleancreenshot && gamestate == GS_LEVEL)
             {
                 gotoverlaytextcolors = false;
@@ -496,11 +505,20 @@ void D_Display(void)
         if (fadecount)
             D_UpdateFade();
 
+        R_ProfileStage(PROFILE_HUD);
+
         // normal update
         blitfunc();
+        R_ProfileStage(PROFILE_BLIT);
         I_RenderPresent();
+        R_ProfileStage(PROFILE_PRESENT);
 
         mapblitfunc();
+        R_ProfileStage(PROFILE_BLIT);
+        R_EndProfileFrame();
+
+        if (timingdemo)
+            return;
 
         if ((!vid_capfps || vid_capfps > 60 || (vid_vsync && refreshrate > 60))
             && (gamestate != GS_LEVEL || menuactive || consoleactive || paused))
@@ -550,12 +568,17 @@ static void D_DoomLoop(void)
 
     while (true)
     {
+        const uint64_t  frametime = (timingdemo ? I_GetTimeUS() : 0);
+
         TryRunTics();       // will run at least one tic
 
         if (splashscreen)
             D_SplashDrawer();
-        else
+        else if (!fastdemo || !demoplayback)
             D_Display();    // update display, next frame, with current state
+
+        if (timingdemo)
+            G_AddDemoFrameTime(I_GetTimeUS() - frametime);
     }
 }
 
@@ -2348,6 +2371,7 @@ static void D_DoomMainSetup(void)
 
     dsdh_InitTables();
     D_BuildBEXTables();
+    C_InitHashTables();
 
 #if defined(_WIN32)
     C_PrintCompileDate();
@@ -2379,6 +2403,28 @@ static void D_DoomMainSetup(void)
         C_Warning(0, "A " BOLD("-nosplash") " parameter was found on the command-line. "
             ITALICS(DOOMRETRO_NAME "'s") " splash screen wasn't displayed.");
 
+    if ((p = M_CheckParmWithArgs("-timedemo", 1)) || (p = M_CheckParmWithArgs("-fastdemo", 1)))
+    {
+        timingdemo = true;
+        fastdemo = M_StringCompare(myargv[p], "-fastdemo");
+        G_DeferredPlayDemo(myargv[p + 1]);
+        C_Output("A " BOLD("%s") " parameter was found on the command-line. "
+            "The demo " BOLD("%s") " will now be played back as fast as possible and timed.",
+            myargv[p], myargv[p + 1]);
+    }
+    else if ((p = M_CheckParmWithArgs("-playdemo", 1)))
+    {
+        G_DeferredPlayDemo(myargv[p + 1]);
+        C_Output("A " BOLD("-playdemo") " parameter was found on the command-line. "
+            "The demo " BOLD("%s") " will now be played back.", myargv[p + 1]);
+    }
+    else if ((p = M_CheckParmWithArgs("-record", 1)))
+    {
+        G_RecordDemo(myargv[p + 1]);
+        C_Output("A " BOLD("-record") " parameter was found on the command-line. "
+            "A demo will now be recorded to " BOLD("%s") ".", myargv[p + 1]);
+    }
+
     if ((respawnmonsters = M_CheckParm("-respawn")))
         C_Output("A " BOLD("-respawn") " parameter was found on the command-line. "
             "Monsters will now respawn.");
@@ -2418,6 +2464,10 @@ static void D_DoomMainSetup(void)
     if ((devparm = M_CheckParm("-devparm")))
         C_Output("A " BOLD("-devparm") " parameter was found on the command-line. %s", s_D_DEVSTR);
 
+    if ((checksight = M_CheckParm("-checksight")))
+        C_Output("A " BOLD("-checksight") " parameter was found on the command-line. "
+            "Every cached line of sight check will now also be checked again without the cache.");
+
     // turbo option
     if ((p = M_CheckParm("-turbo")))
     {
@@ -3029,6 +3079,17 @@ static void D_DoomMainSetup(void)
         }
     }
 
+    // [BH] recording a demo always starts a new game
+    if (demorecording && !autostart)
+    {
+        if (gamemode == commercial)
+            M_snprintf(lumpname, sizeof(lumpname), "MAP%02i", startmap);
+        else
+            M_snprintf(lumpname, sizeof(lumpname), "E%iM%i", startepisode, startmap);
+
+        autostart = true;
+    }
+
     if (M_CheckParm("-dog"))
     {
         P_InitHelperDogs(1);
@@ -3178,7 +3239,17 @@ static void D_DoomMainSetup(void)
             creditlump = W_CacheLumpName(gamemission == doom ? (gamemode == shareware ? "CREDIT1" : "CREDIT2") : "CREDIT3");
     }
 
-    if (gameaction != ga_loadgame)
+    if (gameaction == ga_playdemo)
+    {
+        menuactive = false;
+        splashscreen = false;
+        vid_scalefilter = vid_scalefilter_copy;
+        M_SaveCVARs();
+        I_RestartGraphics(false);
+        I_UpdateBlitFunc(false);
+        I_InitKeyboard();
+    }
+    else if (gameaction != ga_loadgame)
     {
         if (autostart)
         {
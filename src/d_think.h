@@ -71,4 +71,7 @@ typedef struct thinker_s
 
     // [BH] active during menu
     bool                menu;
+
+    // [BH] allocated from the mobj pool by P_AllocMobj(), set by P_AddThinker()
+    bool                pooled;
 } thinker_t;
@@ -214,6 +214,14 @@ extern bool             paused;         // Game Pause?
 
 extern bool             viewactive;
 
+// -------------------------------------
+// Demo playback/recording related stuff.
+//
+extern bool             demoplayback;
+extern bool             demorecording;
+extern bool             timingdemo;     // checkparm of -timedemo or -fastdemo
+extern bool             fastdemo;       // checkparm of -fastdemo
+
 // -------------------------------------
 // Scores, rating.
 // Statistics on a given map, for intermission.
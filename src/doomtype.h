@@ -52,3 +52,9 @@ typedef uint8_t byte;
 #endif
 
 #define arrlen(array)   (sizeof(array) / sizeof(*array))
+
+#if defined(_MSC_VER)
+#define THREADLOCAL     __declspec(thread)
+#else
+#define THREADLOCAL     __thread
+#endif
@@ -922,7 +922,7 @@ static void F_CastDrawer(void)
         rot = castrot;
 
     lump = sprframe->lump[rot];
-    patch = W_CacheLumpNum(lump + firstspritelump);
+    patch = W_CacheWritableLumpNum(lump + firstspritelump);
     patch->topoffset = (r_fixspriteoffsets ? newspritetopoffset[lump] : spritetopoffset[lump]) >> FRACBITS;
 
     if (type == MT_SKULL || type == MT_GHOUL || type == MT_BANSHEE)
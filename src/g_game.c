@@ -54,6 +54,7 @@
 #include "i_controller.h"
 #include "i_system.h"
 #include "i_timer.h"
+#include "m_array.h"
 #include "m_config.h"
 #include "m_menu.h"
 #include "m_misc.h"
@@ -66,6 +67,7 @@
 #include "st_stuff.h"
 #include "v_video.h"
 #include "wi_stuff.h"
+#include "z_zone.h"
 
 static void G_DoReborn(void);
 
@@ -73,6 +75,10 @@ static void G_DoNewGame(void);
 static void G_DoCompleted(void);
 static void G_DoWorldDone(void);
 static void G_DoSaveGame(void);
+static void G_DoPlayDemo(void);
+static void G_BeginRecording(void);
+static void G_ReadDemoTiccmd(ticcmd_t *cmd);
+static void G_WriteDemoTiccmd(const ticcmd_t *cmd);
 
 gameaction_t    gameaction;
 gamestate_t     gamestate = GS_NONE;
@@ -229,8 +235,60 @@ int             savegameslot;
 char            savename[MAX_PATH];
 static char     savedescription[SAVESTRINGSIZE];
 
+// [BH] the savegame being written on another thread, reported once it has been saved
+static char     savingfile[MAX_PATH];
+static char     savingname[MAX_PATH];
+static char     savingdescription[SAVESTRINGSIZE];
+static int      savingslot;
+static bool     savingautosave;
+static bool     savingconsole;
+static uint64_t savingtime;
+
 gameaction_t    loadaction = ga_nothing;
 
+bool            demorecording;
+bool            demoplayback;
+bool            timingdemo;                     // if true, exit with report on completion
+bool            fastdemo;                       // if true, don't render while timing demo
+
+static char     demoname[MAX_PATH];
+static FILE     *demofile;
+static byte     *demobuffer;
+static byte     *demo_p;
+static byte     *demoend;
+static uint64_t demostarttime;
+static int      demotics;
+static int      *demoframetimes;
+
+// [BH] Options that affect gameplay are stored in the header of a demo
+//  so it plays back the same regardless of how it is configured.
+static bool     *demooptions[] =
+{
+    &respawnmonsters,
+    &fastparm,
+    &nomonsters,
+    &pistolstart,
+    &solonet,
+    &autoaim,
+    &freelook,
+    &infighting,
+    &infiniteheight,
+    &r_corpses_gib,
+    &r_corpses_moreblood,
+    &r_corpses_nudge,
+    &r_corpses_slide,
+    &r_fixmaperrors,
+    &r_liquid_current,
+    &r_randomstartframes,
+    &tossdrop
+};
+
+static bool     prevdemooptions[arrlen(demooptions)];
+static int      prevr_blood;
+static gamemission_t prevgamemission;
+
+unsigned int    demoseed;
+
 void G_RemoveChoppers(void)
 {
     viewplayer->cheats &= ~CF_CHOPPERS;
@@ -1311,6 +1369,9 @@ void G_Ticker(void)
     // Game state the last time G_Ticker was called.
     static gamestate_t  oldgamestate;
 
+    Z_Tick();
+    P_UpdateSaveGame();
+
     // do player reborn if needed
     if (viewplayer->playerstate == PST_REBORN)
         G_DoReborn();
@@ -1356,6 +1417,10 @@ void G_Ticker(void)
                 G_DoWorldDone();
                 break;
 
+            case ga_playdemo:
+                G_DoPlayDemo();
+                break;
+
             default:
                 break;
         }
@@ -1364,6 +1429,12 @@ void G_Ticker(void)
     // and build new consistency check
     memcpy(&viewplayer->cmd, &localcmds[gametime % BACKUPTICS], sizeof(ticcmd_t));
 
+    if (demoplayback)
+        G_ReadDemoTiccmd(&viewplayer->cmd);
+
+    if (demorecording)
+        G_WriteDemoTiccmd(&viewplayer->cmd);
+
     // check for special buttons
     if (viewplayer->cmd.buttons & BT_SPECIAL)
     {
@@ -1812,7 +1883,7 @@ static void G_DoCompleted(void)
     stat_mapsfinished = SafeAdd(stat_mapsfinished, 1);
     M_SaveCVARs();
 
-    if (!numconsolestrings || (!M_StringCompare(console[numconsolestrings - 1].string, "exitmap")))
+    if (!numconsolestrings || (!M_StringCompare(CONSOLESTRING(numconsolestrings - 1).string, "exitmap")))
         C_Input("exitmap");
 
     WI_Start(&wminfo);
@@ -1893,14 +1964,19 @@ void G_LoadGame(const char *name)
 
 void G_DoLoadGame(void)
 {
-    int savedmaptime;
+    int         savedmaptime;
+    uint64_t    starttime;
+    double      loadtime;
 
     I_SetPalette(PLAYPAL);
 
     loadaction = gameaction;
     gameaction = ga_nothing;
 
-    if (numconsolestrings == 1 || !M_StringStartsWith(console[numconsolestrings - 1].string, "load "))
+    if (demorecording || demoplayback)
+        G_StopDemo();
+
+    if (numconsolestrings == 1 || !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "load "))
         C_Input("load %s", savename);
 
     if (!(save_stream = P_OpenSaveGame(savename)))
@@ -1925,6 +2001,7 @@ void G_DoLoadGame(void)
     G_InitNew(gameskill, gameepisode, gamemap);
 
     maptime = savedmaptime;
+    starttime = I_GetTimeUS();
 
     // unarchive all the modifications
     P_UnarchivePlayer();
@@ -1947,6 +2024,8 @@ void G_DoLoadGame(void)
 
     fclose(save_stream);
 
+    loadtime = (I_GetTimeUS() - starttime) / 1000.0;
+
     if (setsizeneeded)
         R_ExecuteSetViewSize();
 
@@ -1975,6 +2054,9 @@ void G_DoLoadGame(void)
         C_HideConsoleFast();
     }
 
+    if (devparm)
+        C_Output("It took %.2f milliseconds to load.", loadtime);
+
     ammohighlight = 0;
     armorhighlight = 0;
     healthhighlight = 0;
@@ -2086,99 +2168,91 @@ void G_SaveGame(const int slot, const char *description, const char *name)
 
 static void G_DoSaveGame(void)
 {
-    char    *temp_savegame_file = P_TempSaveGameFile();
-    char    *savegame_file = (consoleactive || !*savedescription ? savename : P_SaveGameFile(savegameslot));
+    char            *savegame_file = (consoleactive || !*savedescription ? savename : P_SaveGameFile(savegameslot));
+    const uint64_t  starttime = I_GetTimeUS();
 
-    // Open the savegame file for writing. We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    if (!(save_stream = fopen(temp_savegame_file, "wb")))
+    // Write the savegame to a buffer, which is then written to a temporary
+    // file on a separate thread and renamed at the end if it was successfully
+    // written. This prevents an existing savegame from being overwritten by
+    // a corrupted one.
+    P_BeginSaveGame();
+
+    if (gameaction == ga_autosavegame)
     {
-        menuactive = false;
-        C_ShowConsole(false);
-        C_Warning(0, BOLD("%s") " couldn't be saved.", savegame_file);
+        M_UpdateSaveGameName(quicksaveslot);
+        M_StringCopy(savedescription, savegamestrings[quicksaveslot], sizeof(savedescription));
     }
-    else
-    {
-        char    *backup_savegame_file = M_StringJoin(savegame_file, ".bak", NULL);
 
-        if (gameaction == ga_autosavegame)
-        {
-            M_UpdateSaveGameName(quicksaveslot);
-            M_StringCopy(savedescription, savegamestrings[quicksaveslot], sizeof(savedescription));
-        }
+    P_WriteSaveGameHeader(savedescription);
 
-        P_WriteSaveGameHeader(savedescription);
+    // number the mobjs before anything that refers to them is archived
+    P_IndexThings();
 
-        P_ArchivePlayer();
-        P_ArchiveWorld();
-        P_ArchiveThinkers();
-        P_ArchiveSpecials();
-        P_ArchiveMap();
+    P_ArchivePlayer();
+    P_ArchiveWorld();
+    P_ArchiveThinkers();
+    P_ArchiveSpecials();
+    P_ArchiveMap();
 
-        P_WriteSaveGameEOF();
+    P_WriteSaveGameEOF();
 
-        P_WriteSaveGameFooter();
+    P_WriteSaveGameFooter();
 
-        // Finish up, close the savegame file.
-        fclose(save_stream);
-
-        if (compresssavegames && !P_CompressSaveGameFile(temp_savegame_file))
-        {
-            free(backup_savegame_file);
-            remove(temp_savegame_file);
-            menuactive = false;
-            C_ShowConsole(false);
-            C_Warning(0, BOLD("%s") " couldn't be saved.", savegame_file);
-        }
-        else
-        {
-            // Now rename the temporary savegame file to the actual savegame
-            // file, backing up the old savegame if there was one there.
-            remove(backup_savegame_file);
-            rename(savegame_file, backup_savegame_file);
-            rename(temp_savegame_file, savegame_file);
+    if (!*savedescription)
+        M_StringCopy(savedescription, maptitle, sizeof(savedescription));
 
-            free(backup_savegame_file);
+    M_StringCopy(savingfile, savegame_file, sizeof(savingfile));
+    M_StringCopy(savingname, savename, sizeof(savingname));
+    M_StringCopy(savingdescription, savedescription, sizeof(savingdescription));
+    savingslot = savegameslot;
+    savingautosave = (gameaction == ga_autosavegame);
+    savingconsole = consoleactive;
+    savingtime = I_GetTimeUS() - starttime;
 
-            if (savegameslot >= 0)
-                savegames = true;
+    P_FinishSaveGame(savegame_file, compresssavegames);
 
-            if (!numconsolestrings || !M_StringStartsWith(console[numconsolestrings - 1].string, "save "))
-                C_Input("save %s", savegame_file);
+    // draw the pattern into the back screen
+    if (viewwidth != SCREENWIDTH)
+        R_FillBackScreen();
 
-            if (!*savedescription)
-                M_StringCopy(savedescription, maptitle, sizeof(savedescription));
+    gameaction = ga_nothing;
+}
 
-            if (consoleactive)
-                C_Output(BOLD("%s") " was saved.", savename);
-            else
-            {
-                static char buffer[1024];
-                char        *temp = titlecase(savedescription);
+//
+// G_SavedGame
+// Called by P_WaitForSaveGame() once the savegame has been written to its file.
+//
+void G_SavedGame(void)
+{
+    if (savingslot >= 0)
+        savegames = true;
 
-                M_snprintf(buffer, sizeof(buffer), (gameaction == ga_autosavegame ? s_GGAUTOSAVED : s_GGSAVED), temp);
-                C_Output(buffer);
-                HU_SetPlayerMessage(buffer, false, false);
-                message_dontfuckwithme = true;
-                free(temp);
+    if (!numconsolestrings || !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "save "))
+        C_Input("save %s", savingfile);
 
-                if (gameaction != ga_autosavegame)
-                    S_StartSound(NULL, sfx_swtchx);
-            }
+    if (savingconsole)
+        C_Output(BOLD("%s") " was saved.", savingname);
+    else
+    {
+        static char buffer[1024];
+        char        *temp = titlecase(savingdescription);
 
-            viewplayer->gamessaved++;
-            stat_gamessaved = SafeAdd(stat_gamessaved, 1);
-            M_SaveCVARs();
+        M_snprintf(buffer, sizeof(buffer), (savingautosave ? s_GGAUTOSAVED : s_GGSAVED), temp);
+        C_Output(buffer);
+        HU_SetPlayerMessage(buffer, false, false);
+        message_dontfuckwithme = true;
+        free(temp);
 
-            // draw the pattern into the back screen
-            if (viewwidth != SCREENWIDTH)
-                R_FillBackScreen();
-        }
+        if (!savingautosave)
+            S_StartSound(NULL, sfx_swtchx);
     }
 
-    gameaction = ga_nothing;
+    if (devparm)
+        C_Output("It took %.2f milliseconds to save.", savingtime / 1000.0);
+
+    viewplayer->gamessaved++;
+    stat_gamessaved = SafeAdd(stat_gamessaved, 1);
+    M_SaveCVARs();
 }
 
 static skill_t  d_skill;
@@ -2228,8 +2302,15 @@ void G_DeferredLoadLevel(skill_t skill, int ep, int map)
 
 static void G_DoNewGame(void)
 {
+    // [BH] A demo only ever records or plays back a single game.
+    if (demofile || demoplayback)
+        G_StopDemo();
+
     I_SetPalette(PLAYPAL);
 
+    if (demorecording)
+        G_BeginRecording();
+
     st_facecount = ST_STRAIGHTFACECOUNT;
     G_InitNew(d_skill, d_episode, d_map);
     gameaction = ga_nothing;
@@ -2330,12 +2411,400 @@ void G_InitNew(skill_t skill, int ep, int map)
     gameskill = skill;
 
     if (numconsolestrings <= 1
-        || (!M_StringCompare(console[numconsolestrings - 2].string, "newgame")
-            && !M_StringStartsWith(console[numconsolestrings - 2].string, "map ")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "load ")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "Warping ")
+        || (!M_StringCompare(CONSOLESTRING(numconsolestrings - 2).string, "newgame")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 2).string, "map ")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "load ")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "Warping ")
             && !autostart))
         C_Input("newgame");
 
     G_DoLoadLevel();
 }
+
+//
+// DEMO RECORDING AND PLAYBACK
+//
+#define DEMOMAGIC       "DRDM"
+#define DEMOVERSION     1
+#define DEMOTICCMDSIZE  12
+
+static void G_WriteDemoLong(byte *p, const int value)
+{
+    p[0] = (value & 0xFF);
+    p[1] = ((value >> 8) & 0xFF);
+    p[2] = ((value >> 16) & 0xFF);
+    p[3] = ((value >> 24) & 0xFF);
+}
+
+static int G_ReadDemoLong(const byte *p)
+{
+    return (int)((unsigned int)p[0] | ((unsigned int)p[1] << 8)
+        | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+//
+// G_ReadDemoTiccmd
+// Replace the player's ticcmd with the next one stored in the demo.
+//
+static void G_ReadDemoTiccmd(ticcmd_t *cmd)
+{
+    if (demo_p + DEMOTICCMDSIZE > demoend)
+    {
+        // end of demo data stream
+        memset(cmd, 0, sizeof(ticcmd_t));
+        G_CheckDemoStatus();
+        return;
+    }
+
+    cmd->forwardmove = (signed char)demo_p[0];
+    cmd->sidemove = (signed char)demo_p[1];
+    cmd->angleturn = (signed short)(demo_p[2] | (demo_p[3] << 8));
+    cmd->buttons = G_ReadDemoLong(&demo_p[4]);
+    cmd->pitch = G_ReadDemoLong(&demo_p[8]);
+    demo_p += DEMOTICCMDSIZE;
+    demotics++;
+
+    // [BH] Never overwrite a savegame while playing back a demo.
+    if ((cmd->buttons & BT_SPECIAL) && (cmd->buttons & BT_SPECIALMASK) == BTS_SAVEGAME)
+        cmd->buttons = 0;
+}
+
+//
+// G_WriteDemoTiccmd
+//
+static void G_WriteDemoTiccmd(const ticcmd_t *cmd)
+{
+    byte    buffer[DEMOTICCMDSIZE];
+
+    if (!demofile)
+        return;
+
+    buffer[0] = (byte)cmd->forwardmove;
+    buffer[1] = (byte)cmd->sidemove;
+    buffer[2] = (cmd->angleturn & 0xFF);
+    buffer[3] = ((cmd->angleturn >> 8) & 0xFF);
+    G_WriteDemoLong(&buffer[4], cmd->buttons);
+    G_WriteDemoLong(&buffer[8], cmd->pitch);
+
+    if (fwrite(buffer, 1, DEMOTICCMDSIZE, demofile) != DEMOTICCMDSIZE)
+    {
+        C_Warning(0, BOLD("%s") " couldn't be recorded.", demoname);
+        G_StopDemo();
+    }
+}
+
+static void G_SetDemoName(const char *name)
+{
+    if (M_StringEndsWith(name, ".lmp") || M_FileExists(name))
+        M_StringCopy(demoname, name, sizeof(demoname));
+    else
+        M_snprintf(demoname, sizeof(demoname), "%s.lmp", name);
+}
+
+//
+// G_RecordDemo
+// Called by the startup code when a -record parameter is found on the command-line.
+// Recording begins once the game starts.
+//
+void G_RecordDemo(const char *name)
+{
+    G_SetDemoName(name);
+    demorecording = true;
+}
+
+//
+// G_BeginRecording
+// Write the demo's header, which stores everything needed to start the game again.
+//
+static void G_BeginRecording(void)
+{
+    byte    header[16 + arrlen(demooptions)];
+    byte    *p = header;
+
+    if (!(demofile = fopen(demoname, "wb")))
+    {
+        C_Warning(0, BOLD("%s") " couldn't be recorded.", demoname);
+        demorecording = false;
+        return;
+    }
+
+    demoseed = (unsigned int)time(NULL);
+
+    memcpy(p, DEMOMAGIC, 4);
+    p += 4;
+    *p++ = DEMOVERSION;
+    *p++ = (byte)d_skill;
+    *p++ = (byte)d_episode;
+    *p++ = (byte)d_map;
+    *p++ = (byte)gamemission;
+    *p++ = (byte)r_blood;
+    *p++ = (byte)arrlen(demooptions);
+
+    for (int i = 0; i < (int)arrlen(demooptions); i++)
+        *p++ = *demooptions[i];
+
+    G_WriteDemoLong(p, (int)demoseed);
+    p += 4;
+
+    if (fwrite(header, 1, p - header, demofile) != (size_t)(p - header))
+    {
+        C_Warning(0, BOLD("%s") " couldn't be recorded.", demoname);
+        G_StopDemo();
+        return;
+    }
+
+    C_Output("Recording the demo " BOLD("%s") "...", demoname);
+}
+
+//
+// G_DeferredPlayDemo
+// Called by the startup code when a -playdemo, -timedemo or -fastdemo parameter is found
+// on the command-line.
+//
+void G_DeferredPlayDemo(const char *name)
+{
+    G_SetDemoName(name);
+    gameaction = ga_playdemo;
+}
+
+static void G_DemoError(const char *string)
+{
+    if (timingdemo)
+        I_Error("%s %s", demoname, string);
+
+    C_Warning(0, BOLD("%s") " %s", demoname, string);
+    free(demobuffer);
+    demobuffer = NULL;
+    D_StartTitle(1);
+}
+
+//
+// G_IsDemoMission
+// [BH] A demo can only be played back using the IWAD it was recorded with, or
+//  with one of the expansions loaded along with DOOM II.
+//
+static bool G_IsDemoMission(const gamemission_t mission)
+{
+    if (mission == gamemission)
+        return true;
+
+    if (gamemission != doom2 && gamemission != pack_nerve && gamemission != pack_masterlevels)
+        return false;
+
+    return (mission == doom2 || (mission == pack_nerve && nerve) || (mission == pack_masterlevels && masterlevels));
+}
+
+static void G_DoPlayDemo(void)
+{
+    FILE            *file;
+    long            length;
+    skill_t         skill;
+    int             episode;
+    int             map;
+    gamemission_t   mission;
+    int             numoptions;
+
+    gameaction = ga_nothing;
+
+    if (!(file = fopen(demoname, "rb")))
+    {
+        G_DemoError("couldn't be found.");
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    demobuffer = I_Malloc(MAX(length, 1));
+
+    if (length < 16 || fread(demobuffer, 1, length, file) != (size_t)length)
+    {
+        fclose(file);
+        G_DemoError("isn't a valid demo.");
+        return;
+    }
+
+    fclose(file);
+
+    demo_p = demobuffer;
+    demoend = demobuffer + length;
+
+    if (memcmp(demo_p, DEMOMAGIC, 4) || demo_p[4] != DEMOVERSION)
+    {
+        G_DemoError("was recorded using an incompatible version of " DOOMRETRO_NAME ".");
+        return;
+    }
+
+    demo_p += 5;
+    skill = (skill_t)*demo_p++;
+    episode = *demo_p++;
+    map = *demo_p++;
+    mission = (gamemission_t)*demo_p++;
+
+    if (!G_IsDemoMission(mission))
+    {
+        G_DemoError("was recorded using a different IWAD.");
+        return;
+    }
+
+    prevgamemission = gamemission;
+    gamemission = mission;
+    prevr_blood = r_blood;
+    r_blood = *demo_p++;
+
+    if ((numoptions = *demo_p++) != (int)arrlen(demooptions) || demo_p + numoptions + 4 > demoend)
+    {
+        gamemission = prevgamemission;
+        r_blood = prevr_blood;
+        G_DemoError("was recorded using an incompatible version of " DOOMRETRO_NAME ".");
+        return;
+    }
+
+    for (int i = 0; i < numoptions; i++)
+    {
+        prevdemooptions[i] = *demooptions[i];
+        *demooptions[i] = *demo_p++;
+    }
+
+    demoseed = (unsigned int)G_ReadDemoLong(demo_p);
+    demo_p += 4;
+
+    demoplayback = true;
+    demotics = 0;
+    array_clear(demoframetimes);
+
+    if (!timingdemo)
+        C_Output("Playing back the demo " BOLD("%s") "...", demoname);
+
+    G_InitNew(skill, episode, map);
+
+    demostarttime = I_GetTimeUS();
+}
+
+//
+// G_AddDemoFrameTime
+// Called once every frame while timing a demo.
+//
+void G_AddDemoFrameTime(const uint64_t time)
+{
+    if (demoplayback)
+        array_push(demoframetimes, (int)time);
+}
+
+static int G_CompareFrameTimes(const void *a, const void *b)
+{
+    return (*(const int *)a - *(const int *)b);
+}
+
+static void G_TimeDemoReport(void)
+{
+    const int       frames = array_size(demoframetimes);
+    const uint64_t  elapsed = MAX(I_GetTimeUS() - demostarttime, 1);
+    double          average = 0.0;
+    int             minimum = 0;
+    int             percentile = 0;
+    char            buffer[512];
+
+    if (frames)
+    {
+        for (int i = 0; i < frames; i++)
+            average += demoframetimes[i];
+
+        average /= frames;
+
+        qsort(demoframetimes, frames, sizeof(int), G_CompareFrameTimes);
+        minimum = demoframetimes[0];
+        percentile = demoframetimes[MIN(frames * 99 / 100, frames - 1)];
+    }
+
+    if (fastdemo)
+        M_snprintf(buffer, sizeof(buffer), "%i tics in %.3f seconds (%.1f tics per second). "
+            "Tic times: min %.3fms, avg %.3fms, p99 %.3fms.",
+            demotics, elapsed / 1000000.0, demotics * 1000000.0 / elapsed,
+            minimum / 1000.0, average / 1000.0, percentile / 1000.0);
+    else
+        M_snprintf(buffer, sizeof(buffer), "%i tics and %i frames in %.3f seconds (%.1f frames per second). "
+            "Frame times: min %.3fms, avg %.3fms, p99 %.3fms.",
+            demotics, frames, elapsed / 1000000.0, frames * 1000000.0 / elapsed,
+            minimum / 1000.0, average / 1000.0, percentile / 1000.0);
+
+    C_Output("%s", buffer);
+
+    // [BH] also print to stdout, since -timedemo and -fastdemo run with the window hidden
+    printf("%s: %s\n", demoname, buffer);
+
+    if (sightchecks)
+    {
+        M_snprintf(buffer, sizeof(buffer), "%" PRIu64 " of %" PRIu64 " line of sight checks (%.1f%%) were cached.",
+            sightcachehits, sightchecks, sightcachehits * 100.0 / sightchecks);
+        C_Output("%s", buffer);
+        printf("%s: %s\n", demoname, buffer);
+    }
+
+    if (frames)
+    {
+        M_snprintf(buffer, sizeof(buffer), "%.1f nodes of the BSP tree were visited and %.1f subtrees were culled per frame.",
+            (double)bspnodesvisited / frames, (double)bspnodesculled / frames);
+        C_Output("%s", buffer);
+        printf("%s: %s\n", demoname, buffer);
+    }
+
+    fflush(stdout);
+}
+
+//
+// G_StopDemo
+// Also called by I_Quit(), so a demo being recorded is closed, and the options
+// changed by a demo being played back are restored before they're saved.
+//
+void G_StopDemo(void)
+{
+    if (demoplayback)
+    {
+        free(demobuffer);
+        demobuffer = NULL;
+        demoplayback = false;
+
+        for (int i = 0; i < (int)arrlen(demooptions); i++)
+            *demooptions[i] = prevdemooptions[i];
+
+        gamemission = prevgamemission;
+        r_blood = prevr_blood;
+    }
+
+    if (demorecording)
+    {
+        if (demofile)
+        {
+            fclose(demofile);
+            demofile = NULL;
+            C_Output("The demo " BOLD("%s") " has been recorded.", demoname);
+        }
+
+        demorecording = false;
+    }
+}
+
+//
+// G_CheckDemoStatus
+// Called after a demo has finished playing back.
+//
+void G_CheckDemoStatus(void)
+{
+    if (timingdemo && demoplayback)
+    {
+        G_TimeDemoReport();
+        G_StopDemo();
+        I_Quit(false);
+    }
+
+    if (demoplayback)
+    {
+        G_StopDemo();
+        C_Output("The demo " BOLD("%s") " has finished playing back.", demoname);
+        D_StartTitle(1);
+    }
+    else if (demorecording)
+        G_StopDemo();
+}
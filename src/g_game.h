@@ -103,6 +103,13 @@ void G_PrevWeapon(void);
 void G_RemoveChoppers(void);
 
 void G_LoadedGameMessage(void);
+void G_SavedGame(void);
+
+void G_RecordDemo(const char *name);
+void G_DeferredPlayDemo(const char *name);
+void G_CheckDemoStatus(void);
+void G_StopDemo(void);
+void G_AddDemoFrameTime(const uint64_t time);
 
 extern fixed_t      forwardmove[2];
 extern fixed_t      sidemove[2];
@@ -125,3 +132,4 @@ extern bool         newpars;
 extern int          pars[10][10];
 extern int          cpars[100];
 extern bool         resetinventory;
+extern unsigned int demoseed;
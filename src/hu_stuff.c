@@ -258,7 +258,7 @@ void HU_Init(void)
     if ((lump = W_CheckNumForName("STTMINUS")) >= 0
         && (W_GetNumLumps("STTMINUS") > 1 || W_GetNumLumps("STTNUM0") == 1))
     {
-        minuspatch = W_CacheLumpNum(lump);
+        minuspatch = W_CacheWritableLumpNum(lump);
         minuspatchwidth = LITTLESHORT(minuspatch->width);
         minuspatch->leftoffset = 0;
 
@@ -40,12 +40,17 @@
 #include "SDL_mixer.h"
 
 #include "c_console.h"
+#include "m_argv.h"
 #include "m_config.h"
 #include "s_sound.h"
 #include "version.h"
 #include "w_wad.h"
 
-#define DMXPADSIZE  16
+#define DMXPADSIZE      16
+
+// [BH] pitch-shifted sounds are kept once they stop playing, until they take
+//  up more than this many bytes
+#define PITCHCACHESIZE  (32 * 1024 * 1024)
 
 typedef struct allocated_sound_s
 {
@@ -63,6 +68,9 @@ static allocated_sound_t        *channels_playing[s_channels_max];
 
 static int                      mixer_freq = MIX_DEFAULT_FREQUENCY;
 
+static size_t                   pitched_sounds_size;
+static bool                     precachepitches;
+
 // Doubly-linked list of allocated sounds.
 // When a sound is played, it is moved to the head, so that the oldest sounds not used recently are at the tail.
 static allocated_sound_t        *allocated_sounds_head;
@@ -96,13 +104,45 @@ static void AllocatedSoundUnlink(allocated_sound_t *snd)
         snd->next->prev = snd->prev;
 }
 
+// Return where the sound made from sfxinfo at pitch is kept, so it can be found without searching
+// the allocated sounds list.
+static void **PitchedSound(const sfxinfo_t *sfxinfo, const int pitch)
+{
+    return (void **)&sfxinfo->pitches[(pitch - (NORM_PITCH - PITCH_RANGE)) / PITCHBUCKETSIZE];
+}
+
 static void FreeAllocatedSound(allocated_sound_t *snd)
 {
+    void    **pitchedsound = PitchedSound(snd->sfxinfo, snd->pitch);
+
+    if (snd->pitch != NORM_PITCH)
+        pitched_sounds_size -= snd->chunk.alen;
+
+    if (*pitchedsound == snd)
+        *pitchedsound = NULL;
+
     // Unlink from linked list.
     AllocatedSoundUnlink(snd);
     free(snd);
 }
 
+// Search from the tail backwards along the allocated sounds list, freeing the pitch-shifted sounds
+// that are not in use until there is room in the cache for length more bytes.
+static void TrimPitchedSounds(const size_t length)
+{
+    allocated_sound_t   *snd = allocated_sounds_tail;
+
+    while (snd && pitched_sounds_size + length > PITCHCACHESIZE)
+    {
+        allocated_sound_t   *prev = snd->prev;
+
+        if (snd->pitch != NORM_PITCH && snd->use_count <= 0)
+            FreeAllocatedSound(snd);
+
+        snd = prev;
+    }
+}
+
 // Search from the tail backwards along the allocated sounds list, find and free a sound that is
 // not in use, to free up memory. Return true for success.
 static bool FindAndFreeSound(void)
@@ -124,8 +164,8 @@ static bool FindAndFreeSound(void)
     return false;
 }
 
-// Allocate a block for a new sound effect.
-static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, const int length)
+// Allocate a block for a new sound effect at a pitch.
+static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, const int length, const int pitch)
 {
     allocated_sound_t   *snd;
 
@@ -143,11 +183,12 @@ static allocated_sound_t *AllocateSound(sfxinfo_t *sfxinfo, const int length)
     snd->chunk.alen = length;
     snd->chunk.allocated = 1;
     snd->chunk.volume = MIX_MAX_VOLUME - 1;
-    snd->pitch = NORM_PITCH;
+    snd->pitch = pitch;
     snd->sfxinfo = sfxinfo;
     snd->use_count = 0;
 
     AllocatedSoundLink(snd);
+    *PitchedSound(sfxinfo, pitch) = snd;
 
     return snd;
 }
@@ -172,17 +213,45 @@ static void UnlockAllocatedSound(allocated_sound_t *snd)
 
 static allocated_sound_t *GetAllocatedSoundBySfxInfoAndPitch(const sfxinfo_t *sfxinfo, const int pitch)
 {
-    allocated_sound_t   *p = allocated_sounds_head;
+    return *PitchedSound(sfxinfo, pitch);
+}
+
+// Resample srclen samples from src, srcstride samples apart, into dstlen samples in dst, dststride
+// samples apart, using linear interpolation in 32.32 fixed point. The last sample is copied outside
+// the loop so that the loop has no branches and can be vectorized.
+static void ResampleLinear(int16_t *dst, const unsigned int dstlen, const int dststride,
+    const int16_t *src, const unsigned int srclen, const int srcstride)
+{
+    uint64_t    step;
+    uint64_t    pos = 0;
 
-    while (p)
+    // a single sample can't be interpolated, so just repeat it
+    if (srclen < 2 || dstlen < 2)
     {
-        if (p->sfxinfo == sfxinfo && p->pitch == pitch)
-            return p;
+        for (unsigned int i = 0; i < dstlen; i++)
+            dst[i * dststride] = src[0];
 
-        p = p->next;
+        return;
+    }
+
+    step = ((uint64_t)(srclen - 1) << 32) / (dstlen - 1);
+
+    for (unsigned int i = 0; i < dstlen - 1; i++, pos += step)
+    {
+        const unsigned int  idx = (unsigned int)(pos >> 32) * srcstride;
+        const int           frac = (int)((pos >> 17) & 0x7FFF);
+        const int           s0 = src[idx];
+        const int           s1 = src[idx + srcstride];
+
+        dst[i * dststride] = (int16_t)(s0 + (((s1 - s0) * frac) >> 15));
     }
 
-    return NULL;
+    dst[(dstlen - 1) * dststride] = src[(srclen - 1) * srcstride];
+}
+
+static int PitchBucket(const int pitch)
+{
+    return (NORM_PITCH + (pitch - NORM_PITCH) / PITCHBUCKETSIZE * PITCHBUCKETSIZE);
 }
 
 // Allocate a new sound chunk and pitch-shift an existing sound up-or-down into it.
@@ -191,36 +260,30 @@ static allocated_sound_t *PitchShift(allocated_sound_t *insnd, const int pitch)
     allocated_sound_t   *outsnd;
     int16_t             *srcbuf;
     int16_t             *dstbuf;
-    const uint32_t      srclen_samples = insnd->chunk.alen / sizeof(int16_t);
+    const uint32_t      srclen_frames = insnd->chunk.alen / (sizeof(int16_t) * 2);
 
     // vanilla-ish behavior: pitch is around NORM_PITCH, treat as semitone-ish ratio
-    const uint32_t      dstlen_samples = (uint32_t)(srclen_samples * ((float)NORM_PITCH / (float)pitch));
-    const uint32_t      dstlen_bytes = dstlen_samples * sizeof(int16_t);
+    const uint32_t      dstlen_frames = (uint32_t)((uint64_t)srclen_frames * NORM_PITCH / pitch);
+    const uint32_t      dstlen_bytes = dstlen_frames * sizeof(int16_t) * 2;
+
+    // sounds too short to pitch-shift are played unchanged
+    if (srclen_frames < 2 || dstlen_frames < 2)
+        return insnd;
 
-    // ensure even number of bytes (SDL_mixer requirement for 16-bit)
-    const uint32_t      alloc_bytes = ((dstlen_bytes & 1) ? dstlen_bytes + 1 : dstlen_bytes);
+    TrimPitchedSounds(dstlen_bytes);
 
-    if (!(outsnd = AllocateSound(insnd->sfxinfo, alloc_bytes)))
+    if (!(outsnd = AllocateSound(insnd->sfxinfo, dstlen_bytes, pitch)))
         return NULL;
 
-    outsnd->pitch = pitch;
+    pitched_sounds_size += dstlen_bytes;
     srcbuf = (int16_t *)insnd->chunk.abuf;
     dstbuf = (int16_t *)outsnd->chunk.abuf;
 
-    // linear interpolation resampling
-    for (uint32_t i = 0; i < dstlen_samples; i++)
-    {
-        const float  src_pos = (float)i / (float)(dstlen_samples - 1) * (srclen_samples - 1);
-        const int    idx     = (int)src_pos;
-        const float  frac    = src_pos - (float)idx;
-
-        const int16_t s0 = srcbuf[idx];
-        const int16_t s1 = (idx + 1 < (int)srclen_samples) ? srcbuf[idx + 1] : s0;
+    // both channels are the same, so resample the left one and copy it to the right
+    ResampleLinear(dstbuf, dstlen_frames, 2, srcbuf, srclen_frames, 2);
 
-        const float   samp = (1.0f - frac) * (float)s0 + frac * (float)s1;
-
-        dstbuf[i] = (int16_t)samp;
-    }
+    for (uint32_t i = 0; i < dstlen_frames * 2; i += 2)
+        dstbuf[i + 1] = dstbuf[i];
 
     return outsnd;
 }
@@ -236,62 +299,74 @@ static void ReleaseSoundOnChannel(const int channel)
 
     channels_playing[channel] = NULL;
     UnlockAllocatedSound(snd);
-
-    // If the sound is a pitch-shift and it's not in use, immediately free it.
-    if (snd->pitch != NORM_PITCH && snd->use_count <= 0)
-        FreeAllocatedSound(snd);
 }
 
 // Generic sound expansion function for any sample rate.
-static void ExpandSoundData(sfxinfo_t *sfxinfo, const byte *data,
+static allocated_sound_t *ExpandSoundData(sfxinfo_t *sfxinfo, const byte *data,
     const int samplerate, const int bits, const int length)
 {
     const unsigned int  samplecount = length / (bits / 8);
-    const unsigned int  expanded_length = (unsigned int)(((uint64_t)samplecount * mixer_freq) / samplerate);
-    allocated_sound_t   *snd = AllocateSound(sfxinfo, expanded_length * 4);
+    const unsigned int  resampled_length = (unsigned int)(((uint64_t)samplecount * mixer_freq) / samplerate);
 
-    if (snd)
-    {
-        int16_t         *expanded = (int16_t *)(&snd->chunk)->abuf;
-        const double    dt = 1.0 / mixer_freq;
-        const double    alpha = dt / (1.0 / (M_PI * samplerate) + dt);
-        const float     src_last = (float)(samplecount - 1);
+    // sounds too short to be resampled are kept as they are
+    const unsigned int  expanded_length = (resampled_length < 2 ? MIN(samplecount, 2) : resampled_length);
+    allocated_sound_t   *snd;
+    int16_t             *expanded;
+    int16_t             *src16 = (int16_t *)data;
+    int                 alpha;
+
+    if (!samplecount || !(snd = AllocateSound(sfxinfo, expanded_length * 4, NORM_PITCH)))
+        return NULL;
+
+    expanded = (int16_t *)snd->chunk.abuf;
 
-        if (bits == 8)
+    // convert 8-bit samples to 16-bit first
+    if (bits == 8)
+    {
+        if (!(src16 = malloc(samplecount * sizeof(int16_t))))
         {
-            for (unsigned int i = 0; i < expanded_length; i++)
-            {
-                const float src_pos = (float)i / (float)(expanded_length - 1) * src_last;
-                const int   idx = (int)src_pos;
-                const float frac = src_pos - (float)idx;
-                const int   s0 = (int)data[idx];
-                const int   s1 = (idx + 1 < (int)samplecount ? (int)data[idx + 1] : s0);
-                const float lin = (1.0f - frac) * (float)s0 + frac * (float)s1;
-                const int   sample = ((int)lin | ((int)lin << 8)) - 32768;
-
-                expanded[i * 2] = expanded[i * 2 + 1] = (int16_t)sample;
-            }
+            FreeAllocatedSound(snd);
+            return NULL;
         }
-        else
-        {
-            const int16_t   *src16 = (const int16_t *)data;
 
-            for (unsigned int i = 0; i < expanded_length; i++)
-            {
-                const float     src_pos = (float)i / (float)(expanded_length - 1) * src_last;
-                const int       idx = (int)src_pos;
-                const float     frac = src_pos - (float)idx;
-                const int16_t   s0 = src16[idx];
-                const int16_t   s1 = (idx + 1 < (int)samplecount ? src16[idx + 1] : s0);
-                const float     sample = (1.0f - frac) * (float)s0 + frac * (float)s1;
-
-                expanded[i * 2] = expanded[i * 2 + 1] = (int16_t)sample;
-            }
-        }
+        for (unsigned int i = 0; i < samplecount; i++)
+            src16[i] = (int16_t)((data[i] | (data[i] << 8)) - 32768);
+    }
+
+    ResampleLinear(expanded, expanded_length, 2, src16, samplecount, 1);
+
+    if (bits == 8)
+        free(src16);
+
+    // Apply low-pass filter to the left channel in Q15 fixed point, and then copy it to the right
+    alpha = (int)(32768.0 / (mixer_freq / (M_PI * samplerate) + 1.0));
+
+    for (unsigned int i = 2; i < expanded_length * 2; i += 2)
+        expanded[i] = (int16_t)(expanded[i - 2] + (((expanded[i] - expanded[i - 2]) * alpha) >> 15));
+
+    for (unsigned int i = 0; i < expanded_length * 2; i += 2)
+        expanded[i + 1] = expanded[i];
+
+    return snd;
+}
+
+// Pitch-shift a sound effect that has just been loaded to every pitch a monster might make it at,
+// for as long as there is room in the cache.
+static void PrecachePitchedSounds(allocated_sound_t *snd)
+{
+    for (int pitch = NORM_PITCH - PITCH_RANGE; pitch <= NORM_PITCH + PITCH_RANGE; pitch += PITCHBUCKETSIZE)
+    {
+        const int   bucket = PitchBucket(pitch);
+
+        if (bucket == NORM_PITCH || GetAllocatedSoundBySfxInfoAndPitch(snd->sfxinfo, bucket))
+            continue;
 
-        // Apply low-pass filter
-        for (unsigned int i = 2; i < expanded_length * 2; i++)
-            expanded[i] = (int16_t)(alpha * expanded[i] + (1.0 - alpha) * expanded[i - 2]);
+        if (pitched_sounds_size + (uint64_t)snd->chunk.alen * NORM_PITCH / bucket > PITCHCACHESIZE
+            || !PitchShift(snd, bucket))
+        {
+            precachepitches = false;
+            return;
+        }
     }
 }
 
@@ -320,8 +395,13 @@ bool CacheSFX(sfxinfo_t *sfxinfo)
 
                 if (bits == 8 || bits == 16)
                 {
-                    ExpandSoundData(sfxinfo, buffer, spec.freq, bits, length);
+                    allocated_sound_t   *snd = ExpandSoundData(sfxinfo, buffer, spec.freq, bits, length);
+
                     SDL_FreeWAV(buffer);
+
+                    if (snd && precachepitches)
+                        PrecachePitchedSounds(snd);
+
                     return true;
                 }
             }
@@ -341,7 +421,12 @@ bool CacheSFX(sfxinfo_t *sfxinfo)
         // needs further investigation to better understand the correct behavior.
         if (length > 48 && length <= lumplen - 8)
         {
-            ExpandSoundData(sfxinfo, data + DMXPADSIZE, (data[2] | (data[3] << 8)), 8, length - DMXPADSIZE * 2);
+            allocated_sound_t   *snd = ExpandSoundData(sfxinfo, data + DMXPADSIZE,
+                                    (data[2] | (data[3] << 8)), 8, length - DMXPADSIZE * 2);
+
+            if (snd && precachepitches)
+                PrecachePitchedSounds(snd);
+
             return true;
         }
     }
@@ -367,34 +452,32 @@ void I_UpdateSoundParms(const int channel, const int vol, const int sep)
 int I_StartSound(const sfxinfo_t *sfxinfo, const int channel, const int vol, const int sep, const int pitch)
 {
     allocated_sound_t   *snd;
+    const int           bucket = (s_randompitch && pitch ?
+                            PitchBucket(BETWEEN(NORM_PITCH - PITCH_RANGE, pitch, NORM_PITCH + PITCH_RANGE)) : NORM_PITCH);
 
     // Release a sound effect if there is already one playing on this channel.
     ReleaseSoundOnChannel(channel);
 
-    if (!(snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, pitch)))
+    if (!(snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, bucket)))
     {
-        // Fetch the base sound effect, un-pitch-shifted.
+        allocated_sound_t   *newsnd;
+
+        // Fetch the base sound effect, un-pitch-shifted, and pitch-shift it if needed.
         if (!(snd = GetAllocatedSoundBySfxInfoAndPitch(sfxinfo, NORM_PITCH)))
             return -1;
 
-        if (s_randompitch && pitch && pitch != NORM_PITCH)
-        {
-            allocated_sound_t   *newsnd = PitchShift(snd, pitch);
-
-            if (newsnd)
-            {
-                LockAllocatedSound(newsnd);
-                UnlockAllocatedSound(snd);
-                snd = newsnd;
-            }
-        }
+        if (bucket != NORM_PITCH && (newsnd = PitchShift(snd, bucket)))
+            snd = newsnd;
     }
-    else
-        LockAllocatedSound(snd);
+
+    LockAllocatedSound(snd);
 
     // Play sound
     if (Mix_PlayChannel(channel, &snd->chunk, 0) == -1)
+    {
+        UnlockAllocatedSound(snd);
         return -1;
+    }
 
     channels_playing[channel] = snd;
 
@@ -466,5 +549,7 @@ bool I_InitSound(void)
     Mix_AllocateChannels(s_channels_max);
     sound_initialized = true;
 
+    precachepitches = (s_randompitch && M_CheckParm("-precachepitches"));
+
     return true;
 }
@@ -48,12 +48,16 @@
 #include "c_console.h"
 #include "d_main.h"
 #include "doomstat.h"
+#include "g_game.h"
 #include "i_controller.h"
 #include "i_discord.h"
 #include "i_system.h"
 #include "m_config.h"
 #include "m_misc.h"
+#include "nano_bsp/nano_bsp.h"
+#include "p_saveg.h"
 #include "p_setup.h"
+#include "r_data.h"
 #include "s_sound.h"
 #include "version.h"
 #include "w_wad.h"
@@ -649,6 +653,9 @@ void I_PrintSystemInfo(void)
 //
 void I_Quit(bool shutdown)
 {
+    P_WaitForSaveGame();
+    G_StopDemo();
+
     if (shutdown)
     {
         D_FadeScreenToBlack();
@@ -671,6 +678,8 @@ void I_Quit(bool shutdown)
 
         I_ShutdownKeyboard();
         I_ShutdownController();
+        BSP_ShutdownThreads();
+        R_ShutdownDrawThreads();
         SDL_Quit();
 
 #if defined(_WIN32)
@@ -678,6 +687,7 @@ void I_Quit(bool shutdown)
 #endif
     }
 
+    R_StopPrecache();
     W_CloseFiles();
 
     exit(0);
@@ -714,6 +724,7 @@ void I_Error(const char *error, ...)
     I_ShutdownKeyboard();
     I_ShutdownController();
 
+    R_StopPrecache();
     W_CloseFiles();
 
 #if defined(_WIN32)
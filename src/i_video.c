@@ -37,6 +37,11 @@
 
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_AVX2
+#include <immintrin.h>
+#endif
+
 #if defined(X11)
 #include <X11/Xlib.h>
 #include <X11/XKBlib.h>
@@ -100,6 +105,16 @@ static byte         *pixels;
 static int          pitch;
 static SDL_Palette  *palette;
 SDL_Color           palettecolors[256];
+
+// [BH] the current palette, already converted to the texture's pixel format
+static SDL_PixelFormat  *textureformat;
+static uint32_t         palettelookup[256];
+static void             (*expandpalette)(uint32_t *dest, const byte *src, const int count);
+
+// [BH] a copy of screens[0] as it was last uploaded, so only the rows that have
+//  changed since are uploaded again
+static byte             *lastscreen;
+static bool             fullupdate = true;
 byte                *PLAYPAL;
 
 byte                *mapscreen;
@@ -664,6 +679,7 @@ static void I_GetEvent(void)
 
                         case SDL_WINDOWEVENT_EXPOSED:
                             SDL_SetPaletteColors(palette, palettecolors, 0, 256);
+                            fullupdate = true;
                             break;
 
                         case SDL_WINDOWEVENT_SIZE_CHANGED:
@@ -707,6 +723,11 @@ static void I_GetEvent(void)
                 }
 
                 break;
+
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                fullupdate = true;
+                break;
         }
     }
 
@@ -959,172 +980,179 @@ static inline void I_DrawPillarboxes(void)
     }
 }
 
-#if defined(_WIN32)
-void I_WindowResizeBlit(void)
+//
+// I_ExpandPalette
+// Converts a row of 8-bit pixels into the texture's pixel format.
+//
+static void I_ExpandPalette(uint32_t *dest, const byte *src, const int count)
 {
-    if (vid_showfps)
-        CalculateFPS();
-
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
+    int i = 0;
 
-    if (nearestlinear)
+    for (; i < count - 7; i += 8)
     {
-        SDL_SetRenderTarget(renderer, texture_upscaled);
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
-        SDL_SetRenderTarget(renderer, NULL);
-        SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+        dest[i] = palettelookup[src[i]];
+        dest[i + 1] = palettelookup[src[i + 1]];
+        dest[i + 2] = palettelookup[src[i + 2]];
+        dest[i + 3] = palettelookup[src[i + 3]];
+        dest[i + 4] = palettelookup[src[i + 4]];
+        dest[i + 5] = palettelookup[src[i + 5]];
+        dest[i + 6] = palettelookup[src[i + 6]];
+        dest[i + 7] = palettelookup[src[i + 7]];
     }
-    else
-        SDL_RenderCopy(renderer, texture, NULL, NULL);
 
-    SDL_RenderPresent(renderer);
+    for (; i < count; i++)
+        dest[i] = palettelookup[src[i]];
 }
-#endif
 
-static void I_Blit(void)
+#if defined(SIMD_AVX2)
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+#endif
+static void I_ExpandPaletteAVX2(uint32_t *dest, const byte *src, const int count)
 {
-    UpdateGrab();
-    I_DrawPillarboxes();
-
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
-}
+    int i = 0;
 
-static void I_Blit_NearestLinear(void)
-{
-    UpdateGrab();
-    I_DrawPillarboxes();
-
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, &dest_rect);
-}
+    for (; i < count - 7; i += 8)
+    {
+        const __m256i   indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)&src[i]));
 
-static void I_Blit_ShowFPS(void)
-{
-    UpdateGrab();
-    I_DrawPillarboxes();
-    CalculateFPS();
+        _mm256_storeu_si256((__m256i *)&dest[i], _mm256_i32gather_epi32((const int *)palettelookup, indices, 4));
+    }
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+    for (; i < count; i++)
+        dest[i] = palettelookup[src[i]];
 }
+#endif
 
-static void I_Blit_NearestLinear_ShowFPS(void)
+static void I_UpdatePaletteLookup(void)
 {
-    UpdateGrab();
-    I_DrawPillarboxes();
-    CalculateFPS();
+    if (textureformat)
+        for (int i = 0; i < 256; i++)
+            palettelookup[i] = SDL_MapRGBA(textureformat, palettecolors[i].r, palettecolors[i].g,
+                palettecolors[i].b, palettecolors[i].a);
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, &dest_rect);
+    fullupdate = true;
 }
 
-static void I_Blit_Shake(void)
+//
+// I_UpdateTexture
+// Expands screens[0] through the palette straight into the streaming texture. Only the band
+//  of rows that has changed since the last update is uploaded, and nothing at all if the
+//  screen hasn't changed. If the texture isn't 32-bit or can't be locked, SDL converts the
+//  screen into a buffer that is then copied into the texture instead.
+//
+static void I_UpdateTexture(void)
 {
-    const int   x = dest_rect.x;
-    const int   y = dest_rect.y;
-
-    UpdateGrab();
-    I_DrawPillarboxes();
-
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
+    const int   srcpitch = surface->pitch;
+    const byte  *src = surface->pixels;
+    int         top = 0;
+    int         bottom = SCREENHEIGHT - 1;
+    SDL_Rect    rect;
+    void        *texturepixels;
+    int         texturepitch;
 
-    dest_rect.x += M_BigRandomInt(-2, 2);
-    dest_rect.y += M_BigRandomInt(-2, 2);
+    if (!fullupdate)
+    {
+        while (top < SCREENHEIGHT && !memcmp(src + top * srcpitch, lastscreen + top * SCREENWIDTH, SCREENWIDTH))
+            top++;
 
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+        if (top == SCREENHEIGHT)
+            return;
 
-    dest_rect.x = x;
-    dest_rect.y = y;
-}
+        while (!memcmp(src + bottom * srcpitch, lastscreen + bottom * SCREENWIDTH, SCREENWIDTH))
+            bottom--;
+    }
 
-static void I_Blit_NearestLinear_Shake(void)
-{
-    const int   x = dest_rect.x;
-    const int   y = dest_rect.y;
+    fullupdate = false;
 
-    UpdateGrab();
-    I_DrawPillarboxes();
+    for (int y = top; y <= bottom; y++)
+        memcpy(lastscreen + y * SCREENWIDTH, src + y * srcpitch, SCREENWIDTH);
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
-    SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
+    rect.x = 0;
+    rect.y = top;
+    rect.w = SCREENWIDTH;
+    rect.h = bottom - top + 1;
+    src += top * srcpitch;
 
-    dest_rect.x += M_BigRandomInt(-2, 2);
-    dest_rect.y += M_BigRandomInt(-2, 2);
+    if (textureformat && SDL_LockTexture(texture, &rect, &texturepixels, &texturepitch) >= 0)
+    {
+        byte    *dest = texturepixels;
 
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, &dest_rect);
+        if (texturepitch == SCREENWIDTH * 4 && srcpitch == SCREENWIDTH)
+            expandpalette((uint32_t *)dest, src, rect.h * SCREENWIDTH);
+        else
+            for (int y = 0; y < rect.h; y++, src += srcpitch, dest += texturepitch)
+                expandpalette((uint32_t *)dest, src, SCREENWIDTH);
 
-    dest_rect.x = x;
-    dest_rect.y = y;
+        SDL_UnlockTexture(texture);
+    }
+    else
+    {
+        SDL_LowerBlit(surface, &rect, buffer, &rect);
+        SDL_UpdateTexture(texture, &rect, pixels + top * pitch, pitch);
+    }
 }
 
-static void I_Blit_ShowFPS_Shake(void)
+#if defined(_WIN32)
+void I_WindowResizeBlit(void)
 {
-    const int   x = dest_rect.x;
-    const int   y = dest_rect.y;
-
-    UpdateGrab();
-    I_DrawPillarboxes();
-    CalculateFPS();
+    if (vid_showfps)
+        CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
+    I_UpdateTexture();
     SDL_RenderClear(renderer);
 
-    dest_rect.x += M_BigRandomInt(-2, 2);
-    dest_rect.y += M_BigRandomInt(-2, 2);
-
-    SDL_RenderCopy(renderer, texture, NULL, &dest_rect);
+    if (nearestlinear)
+    {
+        SDL_SetRenderTarget(renderer, texture_upscaled);
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        SDL_SetRenderTarget(renderer, NULL);
+        SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    }
+    else
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
 
-    dest_rect.x = x;
-    dest_rect.y = y;
+    SDL_RenderPresent(renderer);
 }
+#endif
 
-static void I_Blit_NearestLinear_ShowFPS_Shake(void)
+static bool blitnearestlinear;
+static bool blitshowfps;
+static bool blitshake;
+static bool mapblitnearestlinear;
+
+static void I_Blit(void)
 {
-    const int   x = dest_rect.x;
-    const int   y = dest_rect.y;
+    SDL_Texture *blittexture = texture;
 
     UpdateGrab();
     I_DrawPillarboxes();
-    CalculateFPS();
 
-    SDL_LowerBlit(surface, &src_rect, buffer, &src_rect);
-    SDL_UpdateTexture(texture, NULL, pixels, pitch);
+    if (blitshowfps)
+        CalculateFPS();
+
+    I_UpdateTexture();
     SDL_RenderClear(renderer);
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_SetRenderTarget(renderer, NULL);
 
-    dest_rect.x += M_BigRandomInt(-2, 2);
-    dest_rect.y += M_BigRandomInt(-2, 2);
+    if (blitnearestlinear)
+    {
+        SDL_SetRenderTarget(renderer, texture_upscaled);
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+        SDL_SetRenderTarget(renderer, NULL);
+        blittexture = texture_upscaled;
+    }
+
+    if (blitshake)
+    {
+        SDL_Rect    rect = dest_rect;
 
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, &dest_rect);
+        rect.x += M_BigRandomInt(-2, 2);
+        rect.y += M_BigRandomInt(-2, 2);
 
-    dest_rect.x = x;
-    dest_rect.y = y;
+        SDL_RenderCopy(renderer, blittexture, NULL, &rect);
+    }
+    else
+        SDL_RenderCopy(renderer, blittexture, NULL, &dest_rect);
 }
 
 static void I_Blit_Automap(void)
@@ -1132,19 +1160,17 @@ static void I_Blit_Automap(void)
     SDL_LowerBlit(mapsurface, &map_rect, mapbuffer, &map_rect);
     SDL_UpdateTexture(maptexture, &map_rect, mappixels, mappitch);
     SDL_RenderClear(maprenderer);
-    SDL_RenderCopy(maprenderer, maptexture, NULL, NULL);
-    SDL_RenderPresent(maprenderer);
-}
 
-static void I_Blit_Automap_NearestLinear(void)
-{
-    SDL_LowerBlit(mapsurface, &map_rect, mapbuffer, &map_rect);
-    SDL_UpdateTexture(maptexture, &map_rect, mappixels, mappitch);
-    SDL_RenderClear(maprenderer);
-    SDL_SetRenderTarget(maprenderer, maptexture_upscaled);
-    SDL_RenderCopy(maprenderer, maptexture, NULL, NULL);
-    SDL_SetRenderTarget(maprenderer, NULL);
-    SDL_RenderCopy(maprenderer, maptexture_upscaled, NULL, NULL);
+    if (mapblitnearestlinear)
+    {
+        SDL_SetRenderTarget(maprenderer, maptexture_upscaled);
+        SDL_RenderCopy(maprenderer, maptexture, NULL, NULL);
+        SDL_SetRenderTarget(maprenderer, NULL);
+        SDL_RenderCopy(maprenderer, maptexture_upscaled, NULL, NULL);
+    }
+    else
+        SDL_RenderCopy(maprenderer, maptexture, NULL, NULL);
+
     SDL_RenderPresent(maprenderer);
 }
 
@@ -1155,24 +1181,12 @@ void I_RenderPresent(void)
 
 void I_UpdateBlitFunc(const bool shaking)
 {
-    if (nearestlinear && (displayheight % VANILLAHEIGHT))
-    {
-        if (shaking && !software)
-            blitfunc = (vid_showfps ? &I_Blit_NearestLinear_ShowFPS_Shake : &I_Blit_NearestLinear_Shake);
-        else
-            blitfunc = (vid_showfps && !splashscreen ? &I_Blit_NearestLinear_ShowFPS : &I_Blit_NearestLinear);
-
-        mapblitfunc = (mapwindow ? &I_Blit_Automap_NearestLinear : &nullfunc);
-    }
-    else
-    {
-        if (shaking && !software)
-            blitfunc = (vid_showfps ? &I_Blit_ShowFPS_Shake : &I_Blit_Shake);
-        else
-            blitfunc = (vid_showfps && !splashscreen ? &I_Blit_ShowFPS : &I_Blit);
-
-        mapblitfunc = (mapwindow ? &I_Blit_Automap : &nullfunc);
-    }
+    blitnearestlinear = (nearestlinear && (displayheight % VANILLAHEIGHT));
+    blitshake = (shaking && !software);
+    blitshowfps = (vid_showfps && (blitshake || !splashscreen));
+    blitfunc = &I_Blit;
+    mapblitnearestlinear = blitnearestlinear;
+    mapblitfunc = (mapwindow ? &I_Blit_Automap : &nullfunc);
 }
 
 void I_StartPillarboxAnimation(bool expanding)
@@ -1342,6 +1356,7 @@ void I_SetPalette(const byte *playpal)
     }
 
     SDL_SetPaletteColors(palette, palettecolors, 0, 256);
+    I_UpdatePaletteLookup();
 
     if (vid_pillarboxes)
         SDL_SetRenderDrawColor(renderer, palettecolors[BLACK].r, palettecolors[BLACK].g,
@@ -1461,11 +1476,10 @@ bool I_CreateExternalAutomap(void)
         if (!(maptexture_upscaled = SDL_CreateTexture(maprenderer, pixelformat,
             SDL_TEXTUREACCESS_TARGET, upscaledwidth * MAPWIDTH, upscaledheight * MAPHEIGHT)))
             I_SDLError("SDL_CreateTexture", -2);
-
-        mapblitfunc = &I_Blit_Automap_NearestLinear;
     }
-    else
-        mapblitfunc = &I_Blit_Automap;
+
+    mapblitnearestlinear = nearestlinear;
+    mapblitfunc = &I_Blit_Automap;
 
     if (!(mappalette = SDL_AllocPalette(256)))
         I_SDLError("SDL_AllocPalette", -1);
@@ -1695,7 +1709,7 @@ static void SetVideoMode(const bool createwindow, const bool output)
             ITALICS(DOOMRETRO_NAME) " in widescreen.", displayindex + 1);
     }
 
-    if (vid_vsync || vid_motionblur)
+    if ((vid_vsync || vid_motionblur) && !timingdemo)
         rendererflags |= SDL_RENDERER_PRESENTVSYNC;
 
     if (M_StringCompare(vid_scalefilter, vid_scalefilter_nearest_linear))
@@ -1727,6 +1741,10 @@ static void SetVideoMode(const bool createwindow, const bool output)
     if (M_StringStartsWith(vid_scaleapi, "opengl"))
         windowflags |= SDL_WINDOW_OPENGL;
 
+    // [BH] hide the window while timing a demo so it can run headless
+    if (timingdemo)
+        windowflags |= SDL_WINDOW_HIDDEN;
+
     GetWindowPosition();
     GetWindowSize();
     GetScreenResolution();
@@ -2181,6 +2199,8 @@ static void SetVideoMode(const bool createwindow, const bool output)
         I_SDLError("SDL_CreateRGBSurface", -1);
 
     screens[0] = surface->pixels;
+    lastscreen = I_Realloc(lastscreen, SCREENAREA);
+    fullupdate = true;
 
     if ((pixelformat = SDL_GetWindowPixelFormat(window)) == SDL_PIXELFORMAT_UNKNOWN)
         I_SDLError("SDL_GetWindowPixelFormat", -1);
@@ -2200,6 +2220,22 @@ static void SetVideoMode(const bool createwindow, const bool output)
     if (!(texture = SDL_CreateTexture(renderer, pixelformat, SDL_TEXTUREACCESS_STREAMING, SCREENWIDTH, SCREENHEIGHT)))
         I_SDLError("SDL_CreateTexture", -1);
 
+    if (textureformat)
+    {
+        SDL_FreeFormat(textureformat);
+        textureformat = NULL;
+    }
+
+    if (SDL_BYTESPERPIXEL(pixelformat) == 4 && !SDL_ISPIXELFORMAT_FOURCC(pixelformat))
+    {
+        textureformat = SDL_AllocFormat(pixelformat);
+#if defined(SIMD_AVX2)
+        expandpalette = (SDL_HasAVX2() ? &I_ExpandPaletteAVX2 : &I_ExpandPalette);
+#else
+        expandpalette = &I_ExpandPalette;
+#endif
+    }
+
     if (nearestlinear)
     {
         SDL_SetHintWithPriority(SDL_HINT_RENDER_SCALE_QUALITY, vid_scalefilter_linear, SDL_HINT_OVERRIDE);
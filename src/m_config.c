@@ -200,6 +200,7 @@ bool        r_percolumnlighting = r_percolumnlighting_default;
 bool        r_pickupeffect = r_pickupeffect_default;
 bool        r_playerweapon = r_playerweapon_default;
 bool        r_playerweapon_translucency = r_playerweapon_translucency_default;
+bool        r_pvs = r_pvs_default;
 bool        r_radiallighting = r_radiallighting_default;
 bool        r_radsuiteffect = r_radsuiteffect_default;
 bool        r_randomstartframes = r_randomstartframes_default;
@@ -216,6 +217,7 @@ bool        r_sprites_translucency = r_sprites_translucency_default;
 bool        r_teleportzoom = r_teleportzoom_default;
 bool        r_textures = r_textures_default;
 bool        r_textures_translucency = r_textures_translucency_default;
+int         r_threads = r_threads_default;
 int         s_channels = s_channels_default;
 bool        s_fullsfx = s_fullsfx_default;
 bool        s_lowermenumusic = s_lowermenumusic_default;
@@ -257,6 +259,7 @@ char        *vid_scaleapi = vid_scaleapi_default;
 char        *vid_scalefilter = vid_scalefilter_default;
 char        *vid_screenresolution = vid_screenresolution_default;
 bool        vid_showfps = vid_showfps_default;
+bool        vid_showprofile = vid_showprofile_default;
 int         vid_vsync = vid_vsync_default;
 bool        vid_widescreen = vid_widescreen_default;
 char        *vid_windowpos = vid_windowpos_default;
@@ -311,8 +314,9 @@ uint64_t    stat_skilllevel_nightmare = 0;
 uint64_t    stat_suicides = 0;
 uint64_t    stat_timeplayed = 0;
 
-static bool cvarsloaded;
-static int  widestcvar;
+static bool         cvarsloaded;
+static int          widestcvar;
+static stringhash_t cvarhash;
 
 #define COMMENT(text)                                   { text "\n", "",     NULL,  DEFAULT_OTHER,         0     }
 #define BLANKLINE                                       { "",        "",     NULL,  DEFAULT_OTHER,         0     }
@@ -473,6 +477,7 @@ static default_t cvars[] =
     CVAR_BOOL         (r_pickupeffect,                   r_pickupeffect,                        r_pickupeffect,                        BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_playerweapon,                   r_playersprites,                       r_playerweapon,                        BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_playerweapon_translucency,      r_playerweapon_translucency,           r_playerweapon_translucency,           BOOLVALUEALIAS         ),
+    CVAR_BOOL         (r_pvs,                            r_pvs,                                 r_pvs,                                 BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_radiallighting,                 r_radiallighting,                      r_radiallighting,                      BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_radsuiteffect,                  r_radsuiteffect,                       r_radsuiteffect,                       BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_randomstartframes,              r_randomstartframes,                   r_randomstartframes,                   BOOLVALUEALIAS         ),
@@ -489,6 +494,7 @@ static default_t cvars[] =
     CVAR_BOOL         (r_teleportzoom,                   r_teleportzoom,                        r_teleportzoom,                        BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_textures,                       r_textures,                            r_textures,                            BOOLVALUEALIAS         ),
     CVAR_BOOL         (r_textures_translucency,          r_textures_translucency,               r_textures_translucency,               BOOLVALUEALIAS         ),
+    CVAR_INT          (r_threads,                        r_threads,                             r_threads,                             0                      ),
     CVAR_INT          (s_channels,                       s_channels,                            s_channels,                            0                      ),
     CVAR_BOOL         (s_fullsfx,                        s_fullsfx,                             s_fullsfx,                             BOOLVALUEALIAS         ),
     CVAR_BOOL         (s_lowermenumusic,                 s_lowermenumusic,                      s_lowermenumusic,                      BOOLVALUEALIAS         ),
@@ -530,6 +536,7 @@ static default_t cvars[] =
     CVAR_STRING       (vid_scalefilter,                  vid_scalefilter,                       vid_scalefilter,                       0                      ),
     CVAR_OTHER        (vid_screenresolution,             vid_screenresolution,                  vid_screenresolution,                  0                      ),
     CVAR_BOOL         (vid_showfps,                      vid_showfps,                           vid_showfps,                           BOOLVALUEALIAS         ),
+    CVAR_BOOL         (vid_showprofile,                  vid_showprofile,                       vid_showprofile,                       BOOLVALUEALIAS         ),
     CVAR_INT          (vid_vsync,                        vid_vsync,                             vid_vsync,                             VSYNCVALUEALIAS        ),
     CVAR_BOOL         (vid_widescreen,                   vid_widescreen,                        vid_widescreen,                        BOOLVALUEALIAS         ),
     CVAR_OTHER        (vid_windowpos,                    vid_windowposition,                    vid_windowpos,                         0                      ),
@@ -1302,6 +1309,21 @@ void M_LoadCVARs(const char *filename)
     // read the file in, overriding any set defaults
     FILE        *file = fopen(filename, "rb");
 
+    // [BH] hash the names of all CVARs the first time a file is loaded
+    if (!cvarhash.buckets)
+    {
+        M_InitStringHash(&cvarhash, numcvars * 2);
+
+        for (int i = 0; i < numcvars; i++)
+            if (*cvars[i].name && cvars[i].name[0] != ';')
+            {
+                M_AddToStringHash(&cvarhash, cvars[i].name, i);
+
+                if (!M_StringCompare(cvars[i].oldname, cvars[i].name))
+                    M_AddToStringHash(&cvarhash, cvars[i].oldname, i);
+            }
+    }
+
     if (!file)
     {
         C_Output("All settings will be saved in " BOLD("%s") ".", filename);
@@ -1355,6 +1377,8 @@ void M_LoadCVARs(const char *filename)
         char    line[1024] = "";
         char    cvar[64] = "";
         char    value[256] = "";
+        int     indices[MAXCMDMATCHES];
+        int     count;
 
         if (!fgets(line, sizeof(line), file))
             continue;
@@ -1397,10 +1421,11 @@ void M_LoadCVARs(const char *filename)
         }
 
         // Find the setting in the list
-        for (int i = 0; i < numcvars; i++)
+        count = M_FindAllInStringHash(&cvarhash, cvar, indices, MAXCMDMATCHES);
+
+        for (int j = 0; j < count; j++)
         {
-            if (!M_StringCompare(cvar, cvars[i].name) && !M_StringCompare(cvar, cvars[i].oldname))
-                continue;       // not this one
+            const int   i = indices[j];
 
             // parameter found
             switch (cvars[i].type)
@@ -188,6 +188,7 @@ extern bool     r_percolumnlighting;
 extern bool     r_pickupeffect;
 extern bool     r_playerweapon;
 extern bool     r_playerweapon_translucency;
+extern bool     r_pvs;
 extern bool     r_radiallighting;
 extern bool     r_radsuiteffect;
 extern bool     r_randomstartframes;
@@ -204,6 +205,7 @@ extern bool     r_sprites_translucency;
 extern bool     r_teleportzoom;
 extern bool     r_textures;
 extern bool     r_textures_translucency;
+extern int      r_threads;
 extern int      s_channels;
 extern bool     s_fullsfx;
 extern bool     s_lowermenumusic;
@@ -244,6 +246,7 @@ extern char     *vid_scaleapi;
 extern char     *vid_scalefilter;
 extern char     *vid_screenresolution;
 extern bool     vid_showfps;
+extern bool     vid_showprofile;
 extern int      vid_vsync;
 extern bool     vid_widescreen;
 extern char     *vid_windowpos;
@@ -838,6 +841,8 @@ enum
 
 #define r_playerweapon_translucency_default true
 
+#define r_pvs_default                       false
+
 #define r_radiallighting_default            true
 
 #define r_radsuiteffect_default             true
@@ -874,6 +879,10 @@ enum
 
 #define r_textures_translucency_default     true
 
+#define r_threads_min                       1
+#define r_threads_default                   1
+#define r_threads_max                       16
+
 #define s_channels_min                      8
 #define s_channels_default                  32
 #define s_channels_max                      64
@@ -1009,6 +1018,7 @@ enum
 #define vid_screenresolution_default        vid_screenresolution_desktop
 
 #define vid_showfps_default                 false
+#define vid_showprofile_default             false
 
 #if defined(__APPLE__)
 #define vid_vsync_min                       vid_vsync_off
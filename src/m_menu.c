@@ -1670,6 +1670,7 @@ static void M_DeleteSaveGameResponse(int key)
 
         M_StringCopy(buffer, P_SaveGameFile(itemon), sizeof(buffer));
         temp = titlecase(savegamestrings[itemon]);
+        P_WaitForSaveGame();
 
         if (remove(buffer))
         {
@@ -2383,7 +2384,7 @@ static void M_DrawOptions(void)
         if (M_MSGON)
         {
             short   width = LITTLESHORT(((patch_t *)W_CacheLumpName(OptionsMenu[msgs].name))->width);
-            patch_t *patch = W_CacheLumpName("M_MSGON");
+            patch_t *patch = W_CacheWritableLumpName("M_MSGON");
 
             patch->leftoffset = 0;
 
@@ -2406,7 +2407,7 @@ static void M_DrawOptions(void)
         if (M_MSGOFF)
         {
             short   width = LITTLESHORT(((patch_t *)W_CacheLumpName(OptionsMenu[msgs].name))->width);
-            patch_t *patch = W_CacheLumpName("M_MSGOFF");
+            patch_t *patch = W_CacheWritableLumpName("M_MSGOFF");
 
             patch->leftoffset = 0;
 
@@ -2430,7 +2431,7 @@ static void M_DrawOptions(void)
         if (M_GDLOW)
         {
             short   width = LITTLESHORT(((patch_t *)W_CacheLumpName(OptionsMenu[detail].name))->width);
-            patch_t *patch = W_CacheLumpName("M_GDLOW");
+            patch_t *patch = W_CacheWritableLumpName("M_GDLOW");
 
             patch->leftoffset = 0;
 
@@ -2453,7 +2454,7 @@ static void M_DrawOptions(void)
         if (M_GDHIGH)
         {
             short   width = LITTLESHORT(((patch_t *)W_CacheLumpName(OptionsMenu[detail].name))->width);
-            patch_t *patch = W_CacheLumpName("M_GDHIGH");
+            patch_t *patch = W_CacheWritableLumpName("M_GDHIGH");
 
             patch->leftoffset = 0;
 
@@ -2581,7 +2582,7 @@ static void M_EndGameResponse(int key)
     if (gamemission == pack_nerve || gamemission == pack_masterlevels)
         gamemission = doom2;
 
-    if (!numconsolestrings || !M_StringCompare(console[numconsolestrings - 1].string, "endgame"))
+    if (!numconsolestrings || !M_StringCompare(CONSOLESTRING(numconsolestrings - 1).string, "endgame"))
         C_Input("endgame");
 
     C_AddConsoleDivider();
@@ -5381,7 +5382,7 @@ void M_Drawer(void)
                     }
                     else if (W_GetNumLumps(name) > 1 || lumpinfo[W_GetNumForName(name)]->wadfile->type == PWAD)
                     {
-                        patch_t *patch = W_CacheLumpName(name);
+                        patch_t *patch = W_CacheWritableLumpName(name);
                         int     width = LITTLESHORT(patch->width);
 
                         if (eviternity)
@@ -685,6 +685,89 @@ bool M_StringCompare(const char *str1, const char *str2)
     return (str2 && !strcasecmp(str1, str2));
 }
 
+// Case-insensitive FNV-1a hash of a string, so that strings that M_StringCompare() considers the
+// same have the same hash.
+unsigned int M_StringHash(const char *s)
+{
+    unsigned int    hash = 2166136261U;
+
+    while (*s)
+    {
+        hash ^= (unsigned char)tolower((unsigned char)*s++);
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+// Create an empty hash table with room for maxentries keys, and at least twice as many buckets.
+void M_InitStringHash(stringhash_t *hash, const int maxentries)
+{
+    unsigned int    size = 16;
+
+    while (size < (unsigned int)maxentries * 2)
+        size <<= 1;
+
+    hash->buckets = I_Malloc(size * sizeof(*hash->buckets));
+    hash->entries = I_Malloc(maxentries * sizeof(*hash->entries));
+    hash->numentries = 0;
+    hash->maxentries = maxentries;
+    hash->mask = size - 1;
+
+    for (unsigned int i = 0; i < size; i++)
+        hash->buckets[i] = -1;
+}
+
+// Add a key to a hash table. The same key may be added more than once with different values.
+// Keys are not copied, so must remain valid for as long as the hash table is used.
+void M_AddToStringHash(stringhash_t *hash, const char *key, const int value)
+{
+    const unsigned int  bucket = M_StringHash(key) & hash->mask;
+    stringhashentry_t   *entry;
+
+    if (hash->numentries == hash->maxentries)
+        I_Error("Too many keys were added to a hash table.");
+
+    entry = &hash->entries[hash->numentries];
+    entry->key = key;
+    entry->value = value;
+    entry->next = hash->buckets[bucket];
+    hash->buckets[bucket] = hash->numentries++;
+}
+
+// Returns the lowest value added to a hash table with the specified key, or -1 if there isn't one.
+int M_FindInStringHash(const stringhash_t *hash, const char *key)
+{
+    int result = -1;
+
+    for (int i = hash->buckets[M_StringHash(key) & hash->mask]; i != -1; i = hash->entries[i].next)
+        if ((result == -1 || hash->entries[i].value < result) && M_StringCompare(key, hash->entries[i].key))
+            result = hash->entries[i].value;
+
+    return result;
+}
+
+// Finds up to maxvalues of the values added to a hash table with the specified key, and returns
+// how many there are, in ascending order.
+int M_FindAllInStringHash(const stringhash_t *hash, const char *key, int *values, const int maxvalues)
+{
+    int count = 0;
+
+    for (int i = hash->buckets[M_StringHash(key) & hash->mask]; i != -1 && count < maxvalues; i = hash->entries[i].next)
+        if (M_StringCompare(key, hash->entries[i].key))
+        {
+            const int   value = hash->entries[i].value;
+            int         j = count++;
+
+            for (; j > 0 && values[j - 1] > value; j--)
+                values[j] = values[j - 1];
+
+            values[j] = value;
+        }
+
+    return count;
+}
+
 // Returns true if string begins with the specified prefix.
 bool M_StringStartsWith(const char *s, const char *prefix)
 {
@@ -1333,16 +1416,6 @@ void M_BritishToAmericanEnglish(char *string)
         M_Translate(string, words[i][1], words[i][0]);
 }
 
-void M_TranslateAutocomplete(void)
-{
-    if (english == english_american)
-        for (int i = 0; *autocompletelist[i].text; i++)
-            M_BritishToAmericanEnglish(autocompletelist[i].text);
-    else
-        for (int i = 0; *autocompletelist[i].text; i++)
-            M_AmericanToBritishEnglish(autocompletelist[i].text);
-}
-
 const char *dayofweek(int day, int month, int year)
 {
     const int   adjustment = (14 - month) / 12;
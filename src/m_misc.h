@@ -54,6 +54,24 @@ typedef enum
     reflexive
 } pronoun_t;
 
+// [BH] case-insensitive string hash table, mapping keys to the indices of the
+//  tables they were found in
+typedef struct
+{
+    const char  *key;
+    int         value;
+    int         next;
+} stringhashentry_t;
+
+typedef struct
+{
+    int                 *buckets;
+    stringhashentry_t   *entries;
+    int                 numentries;
+    int                 maxentries;
+    unsigned int        mask;
+} stringhash_t;
+
 void M_MakeDirectory(const char *path);
 bool M_FileExists(const char *filename);
 bool M_FolderExists(const char *folder);
@@ -95,6 +113,11 @@ void M_snprintf(char *buf, int buf_len, const char *s, ...);
 char *M_SubString(const char *str, size_t begin, size_t len);
 char *M_StringDuplicate(const char *orig);
 bool M_StringCompare(const char *str1, const char *str2);
+unsigned int M_StringHash(const char *s);
+void M_InitStringHash(stringhash_t *hash, const int maxentries);
+void M_AddToStringHash(stringhash_t *hash, const char *key, const int value);
+int M_FindInStringHash(const stringhash_t *hash, const char *key);
+int M_FindAllInStringHash(const stringhash_t *hash, const char *key, int *values, const int maxvalues);
 char *uppercase(const char *str);
 char *lowercase(char *str);
 void capitalizeword(char *source, const char *substring);
@@ -127,5 +150,4 @@ const char *pronoun(const pronoun_t type);
 bool isdefaultplayername(void);
 void M_AmericanToBritishEnglish(char *string);
 void M_BritishToAmericanEnglish(char *string);
-void M_TranslateAutocomplete(void);
 const char *dayofweek(int day, int month, int year);
@@ -23,6 +23,12 @@
 //
 //----------------------------------------------------------------------------
 
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+
+#include "../i_system.h"
 #include "../m_bbox.h"
 #include "../r_defs.h"
 #include "../p_setup.h"
@@ -43,6 +49,22 @@
 // (I am not sure exactly why). higher values are okay.
 #define SPLIT_COST      11
 
+// [BH] both sides of a partition with at least this many segs are built at
+// the same time on different threads, and the candidates BSP_PickNode_Slow()
+// evaluates are split across threads in ranges of at least this many.
+#define PARALLEL_SEGS   256
+#define PARALLEL_EVAL   32
+
+#define MAX_THREADS     16
+
+// [BH] the threads recurse through BSP_SubdivideSegs(), so don't rely on the
+// size of the stack SDL gives them by default (only 512 KB on macOS)
+#define STACK_SIZE      (8 * 1024 * 1024)
+
+// [BH] size of each block of memory that nodes, segs and vertexes are
+// allocated from. each thread allocates from its own blocks.
+#define BLOCK_SIZE      65536
+
 typedef struct Nanode   nanode_t;
 
 struct Nanode
@@ -62,32 +84,298 @@ struct Nanode
     struct Nanode   *left;
 };
 
-vertex_t *BSP_NewVertex(fixed_t x, fixed_t y)
+typedef struct Nanoblock nanoblock_t;
+
+struct Nanoblock
+{
+    struct Nanoblock    *next;
+    size_t              used;
+    byte                data[BLOCK_SIZE];
+};
+
+// [BH] the memory allocated by one thread
+typedef struct
+{
+    nanoblock_t *blocks;
+    int         num_vertexes;
+} nanoarena_t;
+
+// [BH] a vertex created by splitting a seg. it's given an index into the
+// final vertexes when it's first written, so it isn't written twice.
+typedef struct
+{
+    vertex_t    v;
+    int         index;
+} nanovertex_t;
+
+// [BH] some work queued to be done by one of the threads in the pool. if no
+// thread has started it by the time it's waited for, the thread waiting for
+// it does it instead.
+typedef struct Nanotask nanotask_t;
+
+typedef enum
 {
-    vertex_t    *vert = Z_Malloc(sizeof(vertex_t), PU_LEVEL, NULL);
+    TASK_QUEUED,
+    TASK_RUNNING,
+    TASK_DONE
+} taskstate_t;
 
-    vert->x = x;
-    vert->y = y;
+struct Nanotask
+{
+    void                (*func)(void *data);
+    void                *data;
+    taskstate_t         state;
+    struct Nanotask     *next;
+};
+
+static SDL_Thread   *nano_threads[MAX_THREADS];
+static int          nano_num_threads;
+static bool         nano_threads_init;
+static bool         nano_threads_quit;
+static SDL_mutex    *nano_mutex;
+static SDL_cond     *nano_queued;
+static SDL_cond     *nano_done;
+static nanotask_t   *nano_tasks;
+
+// [BH] set if memory couldn't be allocated on any thread, so the nodes can
+// stop being built and the error can be reported on the main thread.
+static SDL_atomic_t nano_failed;
+
+void *BSP_Alloc(nanoarena_t *arena, size_t size)
+{
+    nanoblock_t *block = arena->blocks;
+    void        *result;
+
+    size = (size + 7) & ~7;
+
+    if (!block || block->used + size > BLOCK_SIZE)
+    {
+        if (!(block = malloc(sizeof(nanoblock_t))))
+        {
+            SDL_AtomicSet(&nano_failed, 1);
+            return NULL;
+        }
+
+        block->next = arena->blocks;
+        block->used = 0;
+        arena->blocks = block;
+    }
 
-    return vert;
+    result = &block->data[block->used];
+    block->used += size;
+
+    return memset(result, 0, size);
 }
 
-seg_t *BSP_NewSeg(void)
+void BSP_MergeArenas(nanoarena_t *dest, nanoarena_t *src)
 {
-    seg_t   *seg = Z_Malloc(sizeof(seg_t), PU_LEVEL, NULL);
+    nanoblock_t *block = src->blocks;
+
+    if (!block)
+        return;
+
+    while (block->next)
+        block = block->next;
 
-    memset(seg, 0, sizeof(*seg));
+    block->next = dest->blocks;
+    dest->blocks = src->blocks;
+    dest->num_vertexes += src->num_vertexes;
 
-    return seg;
+    src->blocks = NULL;
+    src->num_vertexes = 0;
 }
 
-nanode_t *BSP_NewNode(void)
+void BSP_FreeArena(nanoarena_t *arena)
 {
-    nanode_t    *node = Z_Malloc(sizeof(nanode_t), PU_LEVEL, NULL);
+    while (arena->blocks)
+    {
+        nanoblock_t *next = arena->blocks->next;
 
-    memset(node, 0, sizeof(*node));
+        free(arena->blocks);
+        arena->blocks = next;
+    }
 
-    return node;
+    arena->num_vertexes = 0;
+}
+
+vertex_t *BSP_NewVertex(nanoarena_t *arena, fixed_t x, fixed_t y)
+{
+    nanovertex_t    *vert = BSP_Alloc(arena, sizeof(nanovertex_t));
+
+    if (!vert)
+        return NULL;
+
+    vert->v.x = x;
+    vert->v.y = y;
+    vert->index = -1;
+
+    arena->num_vertexes++;
+
+    return &vert->v;
+}
+
+seg_t *BSP_NewSeg(nanoarena_t *arena)
+{
+    return BSP_Alloc(arena, sizeof(seg_t));
+}
+
+nanode_t *BSP_NewNode(nanoarena_t *arena)
+{
+    return BSP_Alloc(arena, sizeof(nanode_t));
+}
+
+static int SDLCALL BSP_PoolThread(void *data)
+{
+    SDL_LockMutex(nano_mutex);
+
+    while (true)
+    {
+        nanotask_t  *task;
+
+        while (!nano_tasks && !nano_threads_quit)
+            SDL_CondWait(nano_queued, nano_mutex);
+
+        if (nano_threads_quit)
+            break;
+
+        task = nano_tasks;
+        nano_tasks = task->next;
+        task->state = TASK_RUNNING;
+        SDL_UnlockMutex(nano_mutex);
+
+        task->func(task->data);
+
+        SDL_LockMutex(nano_mutex);
+        task->state = TASK_DONE;
+        SDL_CondBroadcast(nano_done);
+    }
+
+    SDL_UnlockMutex(nano_mutex);
+
+    return 0;
+}
+
+//
+// [BH] Start the pool of threads the nodes are built with, using up to one
+// thread for each CPU core. The threads are kept until BSP_ShutdownThreads()
+// is called, rather than being started each time nodes are built.
+//
+void BSP_InitThreads(void)
+{
+    const int   threads = MIN(SDL_GetCPUCount(), MAX_THREADS) - 1;
+
+    if (nano_threads_init)
+        return;
+
+    nano_threads_init = true;
+
+    if (threads <= 0
+        || !(nano_mutex = SDL_CreateMutex())
+        || !(nano_queued = SDL_CreateCond())
+        || !(nano_done = SDL_CreateCond()))
+        return;
+
+    nano_threads_quit = false;
+
+    while (nano_num_threads < threads)
+    {
+        SDL_Thread  *thread = SDL_CreateThreadWithStackSize(&BSP_PoolThread, "BSP_PoolThread", STACK_SIZE, NULL);
+
+        if (!thread)
+            break;
+
+        nano_threads[nano_num_threads++] = thread;
+    }
+}
+
+void BSP_ShutdownThreads(void)
+{
+    if (nano_mutex)
+    {
+        SDL_LockMutex(nano_mutex);
+        nano_threads_quit = true;
+        SDL_CondBroadcast(nano_queued);
+        SDL_UnlockMutex(nano_mutex);
+    }
+
+    for (int i = 0; i < nano_num_threads; i++)
+        SDL_WaitThread(nano_threads[i], NULL);
+
+    if (nano_done)
+        SDL_DestroyCond(nano_done);
+
+    if (nano_queued)
+        SDL_DestroyCond(nano_queued);
+
+    if (nano_mutex)
+        SDL_DestroyMutex(nano_mutex);
+
+    nano_num_threads = 0;
+    nano_done = NULL;
+    nano_queued = NULL;
+    nano_mutex = NULL;
+    nano_threads_init = false;
+}
+
+//
+// [BH] Queue some work to be done by the next thread in the pool that's free.
+// BSP_WaitForTask() must be called before the task goes out of scope.
+//
+void BSP_QueueTask(nanotask_t *task, void (*func)(void *data), void *data)
+{
+    task->func = func;
+    task->data = data;
+
+    if (!nano_num_threads)
+    {
+        task->state = TASK_QUEUED;
+        return;
+    }
+
+    SDL_LockMutex(nano_mutex);
+    task->state = TASK_QUEUED;
+    task->next = nano_tasks;
+    nano_tasks = task;
+    SDL_CondSignal(nano_queued);
+    SDL_UnlockMutex(nano_mutex);
+}
+
+//
+// [BH] Wait for a task queued by BSP_QueueTask() to be done, doing it on this
+// thread if no thread in the pool has started it yet. so a thread is never
+// left waiting for a task that no other thread is doing.
+//
+void BSP_WaitForTask(nanotask_t *task)
+{
+    if (!nano_num_threads)
+    {
+        task->func(task->data);
+        task->state = TASK_DONE;
+        return;
+    }
+
+    SDL_LockMutex(nano_mutex);
+
+    if (task->state == TASK_QUEUED)
+    {
+        nanotask_t  **link = &nano_tasks;
+
+        while (*link != task)
+            link = &(*link)->next;
+
+        *link = task->next;
+        task->state = TASK_RUNNING;
+        SDL_UnlockMutex(nano_mutex);
+
+        task->func(task->data);
+        task->state = TASK_DONE;
+        return;
+    }
+
+    while (task->state != TASK_DONE)
+        SDL_CondWait(nano_done, nano_mutex);
+
+    SDL_UnlockMutex(nano_mutex);
 }
 
 void BSP_CalcOffset(seg_t *seg)
@@ -134,7 +422,7 @@ void BSP_MergeBounds(fixed_t *out, fixed_t *box1, fixed_t *box2)
     out[BOXTOP] = MAX(box1[BOXTOP], box2[BOXTOP]);
 }
 
-void BSP_SegForLineSide(int i, int side, seg_t **list_var)
+void BSP_SegForLineSide(nanoarena_t *arena, int i, int side, seg_t **list_var)
 {
     line_t  *ld = &lines[i];
     seg_t   *seg;
@@ -142,7 +430,8 @@ void BSP_SegForLineSide(int i, int side, seg_t **list_var)
     if (ld->sidenum[side] == NO_INDEX)  // [FG]
         return;
 
-    seg = BSP_NewSeg();
+    if (!(seg = BSP_NewSeg(arena)))
+        return;
 
     if (side)
     {
@@ -178,22 +467,25 @@ void BSP_SegForLineSide(int i, int side, seg_t **list_var)
     *list_var = seg;
 }
 
-seg_t *BSP_CreateSegs(void)
+seg_t *BSP_CreateSegs(nanoarena_t *arena)
 {
     seg_t   *list = NULL;
 
     for (int i = 0; i < numlines; i++)
     {
-        BSP_SegForLineSide(i, 0, &list);
-        BSP_SegForLineSide(i, 1, &list);
+        BSP_SegForLineSide(arena, i, 0, &list);
+        BSP_SegForLineSide(arena, i, 1, &list);
     }
 
     return list;
 }
 
-nanode_t *BSP_CreateLeaf(seg_t *soup)
+nanode_t *BSP_CreateLeaf(nanoarena_t *arena, seg_t *soup)
 {
-    nanode_t    *node = BSP_NewNode();
+    nanode_t    *node = BSP_NewNode(arena);
+
+    if (!node)
+        return NULL;
 
     node->segs = soup;
 
@@ -422,32 +714,120 @@ seg_t *BSP_PickNode_Fast(seg_t *soup)
     return NULL;
 }
 
+// [BH] a range of the candidates evaluated by BSP_PickNode_Slow()
+struct PickRange
+{
+    seg_t       **parts;
+    int         start;
+    int         end;
+    seg_t       *soup;
+
+    int         best;
+    int         best_cost;
+    nanotask_t  task;
+};
+
+void BSP_PickFromRange(void *data)
+{
+    struct PickRange    *range = data;
+
+    range->best = -1;
+    range->best_cost = (1 << 30);
+
+    for (int i = range->start; i < range->end; i++)
+    {
+        struct NodeEval eval;
+
+        if (BSP_EvalPartition(range->parts[i], range->soup, &eval))
+        {
+            int cost = ABS(eval.left - eval.right) * 2 + eval.split * SPLIT_COST;
+
+            if (cost < range->best_cost)
+            {
+                range->best = i;
+                range->best_cost = cost;
+            }
+        }
+    }
+}
+
 //
 // Evaluate *every* seg in the list as a partition candidate,
 // returning the best one, or NULL if none found (which means
 // the remaining segs form a subsector).
 //
+// [BH] When there are enough candidates, they are split into ranges that
+// are evaluated by the threads in the pool. The first range with the lowest cost
+// wins, so the same seg is picked no matter how many threads there are.
+//
 seg_t *BSP_PickNode_Slow(seg_t *soup)
 {
-    seg_t   *best  = NULL;
-    int     best_cost = (1 << 30);
+    seg_t               *best  = NULL;
+    int                 best_cost = (1 << 30);
+    int                 count = 0;
+    seg_t               **parts;
+    struct PickRange    ranges[MAX_THREADS];
+    int                 num_ranges;
 
-    for (seg_t *part = soup; part; part = part->next)
-    {
-        struct NodeEval eval;
+    for (seg_t *S = soup; S; S = S->next)
+        count++;
 
-        if (BSP_EvalPartition(part, soup, &eval))
+    num_ranges = MIN(nano_num_threads + 1, count / PARALLEL_EVAL);
+
+    if (num_ranges < 2 || !(parts = malloc(count * sizeof(*parts))))
+    {
+        for (seg_t *part = soup; part; part = part->next)
         {
-            int cost = ABS(eval.left - eval.right) * 2 + eval.split * SPLIT_COST;
+            struct NodeEval eval;
 
-            if (cost < best_cost)
+            if (BSP_EvalPartition(part, soup, &eval))
             {
-                best = part;
-                best_cost = cost;
+                int cost = ABS(eval.left - eval.right) * 2 + eval.split * SPLIT_COST;
+
+                if (cost < best_cost)
+                {
+                    best = part;
+                    best_cost = cost;
+                }
             }
         }
+
+        return best;
+    }
+
+    count = 0;
+
+    for (seg_t *S = soup; S; S = S->next)
+        parts[count++] = S;
+
+    for (int i = 0; i < num_ranges; i++)
+    {
+        ranges[i].parts = parts;
+        ranges[i].start = (int)((int64_t)count * i / num_ranges);
+        ranges[i].end = (int)((int64_t)count * (i + 1) / num_ranges);
+        ranges[i].soup = soup;
+    }
+
+    // the first range is evaluated on this thread
+    for (int i = 1; i < num_ranges; i++)
+        BSP_QueueTask(&ranges[i].task, &BSP_PickFromRange, &ranges[i]);
+
+    BSP_PickFromRange(&ranges[0]);
+
+    for (int i = 0; i < num_ranges; i++)
+    {
+        if (i)
+            BSP_WaitForTask(&ranges[i].task);
+
+        if (ranges[i].best >= 0 && ranges[i].best_cost < best_cost)
+        {
+            best = parts[ranges[i].best];
+            best_cost = ranges[i].best_cost;
+        }
     }
 
+    free(parts);
+
     return best;
 }
 
@@ -534,7 +914,7 @@ void BSP_ComputeIntersection(seg_t *part, seg_t *seg, fixed_t *x, fixed_t *y)
 // correct output list (`lefts` or `rights`).  otherwise split the seg
 // at the intersection point, one piece goes left, the other right.
 //
-void BSP_SplitSegs(seg_t *part, seg_t *soup, seg_t **lefts, seg_t **rights)
+void BSP_SplitSegs(nanoarena_t *arena, seg_t *part, seg_t *soup, seg_t **lefts, seg_t **rights)
 {
     while (soup)
     {
@@ -565,8 +945,15 @@ void BSP_SplitSegs(seg_t *part, seg_t *soup, seg_t **lefts, seg_t **rights)
         // we must split this seg
         BSP_ComputeIntersection(part, S, &ix, &iy);
 
-        iv = BSP_NewVertex(ix, iy);
-        T = BSP_NewSeg();
+        // [BH] if memory couldn't be allocated, leave the seg unsplit.
+        // BSP_SubdivideSegs() stops building the nodes.
+        if (!(iv = BSP_NewVertex(arena, ix, iy)) || !(T = BSP_NewSeg(arena)))
+        {
+            S->next = *lefts;
+            *lefts = S;
+
+            continue;
+        }
 
         T->v2 = S->v2;
         T->v1 = iv;
@@ -602,21 +989,52 @@ void BSP_SplitSegs(seg_t *part, seg_t *soup, seg_t **lefts, seg_t **rights)
     }
 }
 
-nanode_t *BSP_SubdivideSegs(seg_t *soup)
+// [BH] the right side of a partition, built by a thread in the pool
+struct SubdivideTask
+{
+    seg_t       *soup;
+    nanoarena_t arena;
+    nanode_t    *result;
+};
+
+nanode_t *BSP_SubdivideSegs(nanoarena_t *arena, seg_t *soup);
+
+void BSP_SubdivideRight(void *data)
 {
-    seg_t       *part = BSP_PickNode_Fast(soup);
+    struct SubdivideTask    *sub = data;
+
+    sub->result = BSP_SubdivideSegs(&sub->arena, sub->soup);
+}
+
+bool BSP_HasSegs(seg_t *soup, int count)
+{
+    for (seg_t *S = soup; S; S = S->next)
+        if (--count <= 0)
+            return true;
+
+    return false;
+}
+
+nanode_t *BSP_SubdivideSegs(nanoarena_t *arena, seg_t *soup)
+{
+    seg_t       *part;
     nanode_t    *N;
     fixed_t     min_size = 64 * FRACUNIT;
     seg_t       *lefts = NULL;
     seg_t       *rights = NULL;
 
-    if (!part)
+    // [BH] stop if memory couldn't be allocated on any thread
+    if (SDL_AtomicGet(&nano_failed))
+        return NULL;
+
+    if (!(part = BSP_PickNode_Fast(soup)))
         part = BSP_PickNode_Slow(soup);
 
     if (!part)
-        return BSP_CreateLeaf(soup);
+        return BSP_CreateLeaf(arena, soup);
 
-    N = BSP_NewNode();
+    if (!(N = BSP_NewNode(arena)))
+        return NULL;
 
     N->x = part->v1->x;
     N->y = part->v1->y;
@@ -633,15 +1051,57 @@ nanode_t *BSP_SubdivideSegs(seg_t *soup)
     }
 
     // these are the new lists (after splitting)
-    BSP_SplitSegs(part, soup, &lefts, &rights);
+    BSP_SplitSegs(arena, part, soup, &lefts, &rights);
 
-    N->right = BSP_SubdivideSegs(rights);
-    N->left = BSP_SubdivideSegs(lefts);
+    // [BH] the two sides share no segs, so if they're both big enough, queue
+    // the right side for another thread while this one builds the left side
+    if (nano_num_threads && BSP_HasSegs(rights, PARALLEL_SEGS) && BSP_HasSegs(lefts, PARALLEL_SEGS))
+    {
+        struct SubdivideTask    sub = { rights, { NULL, 0 }, NULL };
+        nanotask_t              task;
+
+        BSP_QueueTask(&task, &BSP_SubdivideRight, &sub);
+        N->left = BSP_SubdivideSegs(arena, lefts);
+        BSP_WaitForTask(&task);
+
+        BSP_MergeArenas(arena, &sub.arena);
+        N->right = sub.result;
+    }
+    else
+    {
+        N->right = BSP_SubdivideSegs(arena, rights);
+        N->left = BSP_SubdivideSegs(arena, lefts);
+    }
 
     return N;
 }
 
-static int  nano_seg_index;
+static int      nano_seg_index;
+static vertex_t *nano_vertexes;
+static int      nano_num_vertexes;
+
+//
+// [BH] Return the vertex a seg should use. Vertexes created by splitting segs
+// are copied into one array, in the order the segs are written, so they are
+// always the same no matter which threads created them.
+//
+vertex_t *BSP_WriteVertex(vertex_t *vert)
+{
+    nanovertex_t    *nv;
+
+    if (vert >= vertexes && vert < vertexes + numvertexes)
+        return vert;
+
+    nv = (nanovertex_t *)vert;
+
+    if (nv->index < 0)
+    {
+        nv->index = nano_num_vertexes++;
+        nano_vertexes[nv->index] = nv->v;
+    }
+
+    return &nano_vertexes[nv->index];
+}
 
 void BSP_CountStuff(nanode_t *N)
 {
@@ -681,9 +1141,10 @@ void BSP_WriteSubsector(nanode_t *N)
         N->segs = seg->next;
         seg->next = NULL;
 
-        // copy and free it
+        // copy it (it's freed along with the rest of the arena)
         memcpy(&segs[nano_seg_index], seg, sizeof(seg_t));
-        Z_Free(seg);
+        segs[nano_seg_index].v1 = BSP_WriteVertex(seg->v1);
+        segs[nano_seg_index].v2 = BSP_WriteVertex(seg->v2);
 
         nano_seg_index++;
         out->numlines++;
@@ -720,17 +1181,30 @@ unsigned int BSP_WriteNode(nanode_t *N, fixed_t *bbox)
         BSP_MergeBounds(bbox, out->bbox[0], out->bbox[1]);
     }
 
-    Z_Free(N);
-
     return index;
 }
 
 void BSP_BuildNodes(void)
 {
-    seg_t       *list = BSP_CreateSegs();
-    nanode_t    *root = BSP_SubdivideSegs(list);
+    nanoarena_t arena = { NULL, 0 };
+    seg_t       *list;
+    nanode_t    *root;
     fixed_t     dummy[4];
 
+    BSP_InitThreads();
+    SDL_AtomicSet(&nano_failed, 0);
+
+    list = BSP_CreateSegs(&arena);
+    root = BSP_SubdivideSegs(&arena, list);
+
+    // [BH] report memory that couldn't be allocated on any thread here, on
+    // the main thread
+    if (SDL_AtomicGet(&nano_failed))
+    {
+        BSP_FreeArena(&arena);
+        I_Error("BSP_BuildNodes: Failure trying to allocate %lu bytes", (unsigned long)sizeof(nanoblock_t));
+    }
+
     // determine total number of nodes, subsectors and segs
     numnodes = 0;
     numsubsectors = 0;
@@ -749,6 +1223,10 @@ void BSP_BuildNodes(void)
 
     nano_seg_index = 0;
 
-    // this also frees stuff as it goes
+    nano_vertexes = (arena.num_vertexes ? Z_Malloc(arena.num_vertexes * sizeof(vertex_t), PU_LEVEL, NULL) : NULL);
+    nano_num_vertexes = 0;
+
     BSP_WriteNode(root, dummy);
+
+    BSP_FreeArena(&arena);
 }
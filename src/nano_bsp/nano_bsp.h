@@ -26,6 +26,10 @@
 #ifndef __NANO_BSP_H__
 #define __NANO_BSP_H__
 
+// [BH] increase whenever a change to NanoBSP changes the nodes it builds
+#define NANOBSP_VERSION 1
+
 void BSP_BuildNodes(void);
+void BSP_ShutdownThreads(void);
 
 #endif
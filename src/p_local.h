@@ -150,6 +150,9 @@ void P_SetPlayerViewHeight(void);
 void P_LookForCards(void);
 void P_InitCards(void);
 
+mobj_t *P_AllocMobj(void);
+void P_FreeMobj(mobj_t *mobj);
+void P_ClearMobjPool(void);
 mobj_t *P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type);
 void P_SetShadowColumnFunction(mobj_t *mobj);
 int P_FindDoomedNum(const int type);
@@ -279,6 +282,7 @@ bool P_CheckLineSide(const mobj_t *actor, const fixed_t x, const fixed_t y);
 bool P_TeleportMove(mobj_t *thing, const fixed_t x, const fixed_t y, const fixed_t z, const bool boss);
 void P_SlideMove(mobj_t *mo);
 bool P_CheckSight(mobj_t *t1, mobj_t *t2);
+void P_ClearSightCache(void);
 bool P_CheckFOV(const mobj_t *t1, const mobj_t *t2, const angle_t fov);
 bool P_DoorClosed(const line_t *line);
 void P_UseLines(void);
@@ -288,6 +292,13 @@ void P_CreateSecNodeList(mobj_t *thing, const fixed_t x, const fixed_t y);
 void P_FreeSecNodeList(void);
 void P_DelSeclist(msecnode_t *node);
 
+//
+// P_SIGHT
+//
+extern bool     checksight;
+extern uint64_t sightchecks;
+extern uint64_t sightcachehits;
+
 extern mobj_t   *linetarget;    // who got hit (or NULL)
 
 fixed_t P_AimLineAttack(mobj_t *t1, angle_t angle, const fixed_t distance, const int mask);
@@ -2303,6 +2303,9 @@ bool P_ChangeSector(sector_t *sector, const bool crunch)
     nofit = false;
     crushchange = crunch;
 
+    // [BH] the sector has moved, so any cached sight checks may be wrong now
+    P_ClearSightCache();
+
     // Mark all things invalid
     for (n = sector->touching_thinglist; n; n = n->m_snext)
         n->visited = false;
@@ -494,6 +494,7 @@ bool P_BlockThingsIterator(const int x, const int y, bool func(mobj_t *), bool b
 // killough 01/11/98: Intercept limit removed
 static intercept_t  *intercepts;
 static intercept_t  *intercept_p;
+static intercept_t  **interceptheap;
 
 // Check for limit and double size if necessary -- killough
 void P_CheckIntercepts(void)
@@ -505,6 +506,7 @@ void P_CheckIntercepts(void)
     {
         num_intercepts = (num_intercepts ? num_intercepts * 2 : 128);
         intercepts = I_Realloc(intercepts, num_intercepts * sizeof(*intercepts));
+        interceptheap = I_Realloc(interceptheap, num_intercepts * sizeof(*interceptheap));
         intercept_p = intercepts + offset;
     }
 }
@@ -655,33 +657,70 @@ static bool PIT_AddThingIntercepts(mobj_t *thing)
     return true;
 }
 
+//
+// P_InterceptBefore
+// [BH] Intercepts are visited in order of their distance along the trace, and
+// intercepts at the same distance in the order they were added.
+//
+static inline bool P_InterceptBefore(const intercept_t *in1, const intercept_t *in2)
+{
+    return (in1->frac < in2->frac || (in1->frac == in2->frac && in1 < in2));
+}
+
+static void P_SiftInterceptDown(const int count, int i)
+{
+    intercept_t *in = interceptheap[i];
+
+    while (true)
+    {
+        int child = i * 2 + 1;
+
+        if (child >= count)
+            break;
+
+        if (child + 1 < count && P_InterceptBefore(interceptheap[child + 1], interceptheap[child]))
+            child++;
+
+        if (!P_InterceptBefore(interceptheap[child], in))
+            break;
+
+        interceptheap[i] = interceptheap[child];
+        i = child;
+    }
+
+    interceptheap[i] = in;
+}
+
 //
 // P_TraverseIntercepts
 // Returns true if the traverser function returns true for all lines.
 //
+// [BH] Rather than rescanning every intercept for the nearest one each time,
+// the intercepts in range are put into a binary heap and popped in order.
+//
 static bool P_TraverseIntercepts(traverser_t func, const fixed_t maxfrac)
 {
-    size_t      count = intercept_p - intercepts;
-    intercept_t *in = NULL;
+    int count = 0;
 
-    while (count--)
-    {
-        fixed_t dist = FIXED_MAX;
+    for (intercept_t *scan = intercepts; scan < intercept_p; scan++)
+        if (scan->frac <= maxfrac)
+            interceptheap[count++] = scan;
 
-        for (intercept_t *scan = intercepts; scan < intercept_p; scan++)
-            if (scan->frac < dist)
-            {
-                dist = scan->frac;
-                in = scan;
-            }
+    for (int i = count / 2 - 1; i >= 0; i--)
+        P_SiftInterceptDown(count, i);
+
+    while (count)
+    {
+        intercept_t *in = interceptheap[0];
 
-        if (dist > maxfrac)
-            return true;    // checked everything in range
+        if (--count)
+        {
+            interceptheap[0] = interceptheap[count];
+            P_SiftInterceptDown(count, 0);
+        }
 
         if (!func(in))
             return false;   // don't bother going farther
-
-        in->frac = FIXED_MAX;
     }
 
     return true;            // everything was traversed
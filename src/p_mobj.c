@@ -824,12 +824,65 @@ void P_SetShadowColumnFunction(mobj_t *mobj)
         mobj->shadowcolfunc = (r_shadows_translucency ? &R_DrawShadowColumn : &R_DrawSolidShadowColumn);
 }
 
+//
+// [BH] Mobjs are allocated from a pool of contiguous chunks rather than one at
+//  a time, so they stay together in memory apart from other level data, and
+//  are linked through thinker.next while free.
+//
+#define MOBJPOOLCHUNK   256
+
+static mobj_t   *mobjpool;
+
+//
+// P_AllocMobj
+// Returns a cleared mobj from the pool, allocating another chunk if it's empty.
+//
+mobj_t *P_AllocMobj(void)
+{
+    mobj_t  *mobj;
+
+    if (!mobjpool)
+    {
+        mobj_t  *chunk = Z_Malloc(MOBJPOOLCHUNK * sizeof(*chunk), PU_LEVEL, NULL);
+
+        // link in reverse so mobjs are handed out in address order
+        for (int i = MOBJPOOLCHUNK - 1; i >= 0; i--)
+        {
+            chunk[i].thinker.next = &mobjpool->thinker;
+            mobjpool = &chunk[i];
+        }
+    }
+
+    mobj = mobjpool;
+    mobjpool = (mobj_t *)mobj->thinker.next;
+    return memset(mobj, 0, sizeof(*mobj));
+}
+
+//
+// P_FreeMobj
+// Returns a mobj to the pool. Called by P_RemoveThinkerDelayed().
+//
+void P_FreeMobj(mobj_t *mobj)
+{
+    mobj->thinker.next = &mobjpool->thinker;
+    mobjpool = mobj;
+}
+
+//
+// P_ClearMobjPool
+// Empties the pool. Called by P_SetupLevel() once the chunks have been freed.
+//
+void P_ClearMobjPool(void)
+{
+    mobjpool = NULL;
+}
+
 //
 // P_SpawnMobj
 //
 mobj_t *P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type)
 {
-    mobj_t      *mobj = Z_Calloc(1, sizeof(*mobj), PU_LEVEL, NULL);
+    mobj_t      *mobj = P_AllocMobj();
     mobjinfo_t  *info = &mobjinfo[type];
     state_t     *st = &states[info->spawnstate];
     sector_t    *sector;
@@ -1448,7 +1501,7 @@ mobj_t *P_SpawnMapThing(mapthing_t *mthing, const bool spawnmonsters)
 
     // [BH] set random pitch for monster sounds when spawned
     mobj->pitch = ((flags & MF_SHOOTABLE) && type != Barrel ?
-        NORM_PITCH + M_BigRandomInt(-16, 16) : NORM_PITCH);
+        NORM_PITCH + M_BigRandomInt(-PITCH_RANGE, PITCH_RANGE) : NORM_PITCH);
 
     // [BH] initialize bobbing things
     if (!(flags2 & MF2_NOLIQUIDBOB))
@@ -1477,7 +1530,7 @@ mobj_t *P_SpawnMapThing(mapthing_t *mthing, const bool spawnmonsters)
 //
 void P_SpawnPuff(const fixed_t x, const fixed_t y, const fixed_t z, const angle_t angle)
 {
-    mobj_t      *th = Z_Calloc(1, sizeof(*th), PU_LEVEL, NULL);
+    mobj_t      *th = P_AllocMobj();
     mobjinfo_t  *info = &mobjinfo[MT_PUFF];
     state_t     *st = &states[info->spawnstate];
     sector_t    *sector;
@@ -1562,7 +1615,7 @@ void P_SpawnBlood(const fixed_t x, const fixed_t y, const fixed_t z, angle_t ang
         for (int i = 0; i < count; i++)
         {
             const int   momentum = (count == 1 ? blood : blood - (i * (blood - 1)) / (count - 1));
-            mobj_t      *th = Z_Calloc(1, sizeof(*th), PU_LEVEL, NULL);
+            mobj_t      *th = P_AllocMobj();
             sector_t    *sector;
 
             th->type = MT_BLOOD;
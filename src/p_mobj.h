@@ -550,6 +550,9 @@ typedef struct mobj_s
     int                 id;
     int                 musicid;
 
+    // [BH] position in the list of mobjs when the game was last saved
+    int                 saveindex;
+
     char                name[33];
 
     bool                madesound;
@@ -0,0 +1,1346 @@
+/*
+==============================================================================
+
+                                 DOOM Retro
+           The classic, refined DOOM source port. For Windows PC.
+
+==============================================================================
+
+    Copyright © 1993-2026 by id Software LLC, a ZeniMax Media company.
+    Copyright © 2013-2026 by Brad Harding <mailto:brad@doomretro.com>.
+
+    This file is a part of DOOM Retro.
+
+    DOOM Retro is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the
+    Free Software Foundation, either version 3 of the license, or (at your
+    option) any later version.
+
+    DOOM Retro is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DOOM Retro. If not, see <https://www.gnu.org/licenses/>.
+
+    DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+    company, in the US and/or other countries, and is used without
+    permission. All other trademarks are the property of their respective
+    holders. DOOM Retro is in no way affiliated with nor endorsed by
+    id Software.
+
+==============================================================================
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
+#include "c_console.h"
+#include "doomstat.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_bbox.h"
+#include "m_config.h"
+#include "m_misc.h"
+#include "p_local.h"
+#include "p_pvs.h"
+#include "sha1.h"
+#include "version.h"
+#include "w_file.h"
+#include "z_zone.h"
+
+//
+// POTENTIALLY VISIBLE SET
+//
+// [BH] For every pair of sectors, whether any part of one may be seen from
+// anywhere in the other. Only one-sided lines block sight, and the heights of
+// sectors are ignored, so the set is conservative: if a sector isn't in it,
+// neither P_CheckSight() nor the renderer could ever see it.
+//
+// It's built much like the PVS of a QUAKE map. The convex subsectors of the
+// BSP tree are the cells, and the parts of the partition lines between them
+// that aren't covered by walls are the portals. First, a quick flood through
+// the portals in front of each portal works out which sectors might be seen
+// through it. Then a flow through each portal in turn clips the portals it
+// reaches against the lines separating the portal it was seen through from
+// the portal the flow started at, and stops as soon as nothing more can be
+// seen. A sector can see the sectors seen through the portals of its
+// subsectors.
+//
+
+// map units each portal is extended by, to allow for the rounding in P_CheckSight()
+#define PVSEPSILON      4.0
+
+// map units of slack given when clipping, to allow for the rounding of doubles
+#define PVSCLIPEPSILON  0.01
+
+// map units a seg may be from a partition line and still be on it
+#define PVSSEGEPSILON   0.5
+
+#define PVSMAXDEPTH     1024
+#define PVSMAXRANGES    64
+#define PVSMAXVISITS    4
+#define PVSMAXSTEPS     (1 << 20)
+#define PVSMAXSECTORS   16384
+#define PVSMAXMEMORY    (128 * 1024 * 1024)
+
+#define PVSMAGIC        "DRPVS2"
+
+// the edges of a cell that aren't on a partition line
+#define PVSBOUNDARY     -1
+#define PVSWALL         -2
+
+typedef struct
+{
+    double          x1, y1;
+    double          x2, y2;
+} pvswinding_t;
+
+// a convex cell, with each edge tagged with the partition line it's on
+typedef struct
+{
+    int             numpoints;
+    double          *x;
+    double          *y;
+    int             *tag;
+} pvscell_t;
+
+// an edge of a cell on a partition line, as a range along that line
+typedef struct
+{
+    int             node;
+    int             leaf;
+    bool            front;
+    double          t1, t2;
+} pvsedge_t;
+
+// the parts of the source and pass portals a flow reached a portal through,
+// as ranges along each of them, and the sectors it might still have seen
+typedef struct
+{
+    int             flow;
+    double          s1, s2;
+    double          t1, t2;
+    byte            *might;
+} pvsvisit_t;
+
+// a portal is oriented so that the subsector it leads into is on its left
+typedef struct
+{
+    pvswinding_t    winding;
+    int             edge;
+    int             source;
+    int             leaf;
+    int             sector;
+    int             mightcount;
+    byte            *mightsee;
+    byte            *vis;
+    bool            done;
+    pvsvisit_t      visits[PVSMAXVISITS];
+    int             nextvisit;
+} pvsportal_t;
+
+const byte          *pvsmatrix;
+const byte          *pvsreject;
+int                 pvsgeneration;
+
+static int          pvslumpnum = -1;
+static byte         pvsdigest[SHA1_DIGEST_SIZE];
+static bool         pvsemptyreject;
+static const byte   *maprejectmatrix;
+
+static int          pvsnumsectors;
+static int          pvsnumleaves;
+static int          pvsnumportals;
+static int          pvsnumedges;
+static size_t       pvsrowsize;
+static int          *pvsleafsector;
+static int          *pvsfirstportal;
+static pvsportal_t  *pvsportals;
+static int          *pvsorder;
+static byte         *pvsportalbits;
+static byte         *pvsmight;
+static byte         *pvsvisitbits;
+static int          *pvsleafstamp;
+static int          *pvsqueue;
+static byte         *pvsvisible;
+static int          pvsstamp;
+static int          pvssteps;
+static bool         pvsoverflow;
+static uint64_t     pvsbuildtime;
+
+static SDL_Thread   *pvsthread;
+static SDL_atomic_t pvsdone;
+static SDL_atomic_t pvsquit;
+
+#define PVSBIT(sector1, sector2)        ((size_t)(sector1) * pvsnumsectors + (sector2))
+#define SETPVSBIT(matrix, sector1, sector2) \
+    matrix[PVSBIT(sector1, sector2) >> 3] |= (1 << (PVSBIT(sector1, sector2) & 7))
+#define PVSBITSET(matrix, sector1, sector2) \
+    (matrix[PVSBIT(sector1, sector2) >> 3] & (1 << (PVSBIT(sector1, sector2) & 7)))
+
+#define SETROWBIT(row, sector)          row[(sector) >> 3] |= (1 << ((sector) & 7))
+#define ROWBITSET(row, sector)          (row[(sector) >> 3] & (1 << ((sector) & 7)))
+
+//
+// P_WindingSide
+// Returns how far (x, y) is to the left of a winding.
+//
+static double P_WindingSide(const pvswinding_t *winding, const double x, const double y)
+{
+    const double    dx = winding->x2 - winding->x1;
+    const double    dy = winding->y2 - winding->y1;
+    const double    length = sqrt(dx * dx + dy * dy);
+
+    return (length < 0.001 ? 0.0 : (dx * (y - winding->y1) - dy * (x - winding->x1)) / length);
+}
+
+//
+// P_ClipWinding
+// Clips a winding to the side of the line through (x, y) in the direction
+// (dx, dy) given by left, keeping anything within PVSCLIPEPSILON of it.
+// Returns false if nothing of the winding is left.
+//
+static bool P_ClipWinding(pvswinding_t *winding, const double x, const double y,
+    double dx, double dy, const bool left)
+{
+    const double    length = sqrt(dx * dx + dy * dy);
+    double          d1, d2;
+
+    // can't clip to a degenerate line
+    if (length < 0.001)
+        return true;
+
+    if (!left)
+    {
+        dx = -dx;
+        dy = -dy;
+    }
+
+    d1 = (dx * (winding->y1 - y) - dy * (winding->x1 - x)) / length;
+    d2 = (dx * (winding->y2 - y) - dy * (winding->x2 - x)) / length;
+
+    if (d1 < -PVSCLIPEPSILON && d2 < -PVSCLIPEPSILON)
+        return false;
+
+    if (d1 < -PVSCLIPEPSILON)
+    {
+        const double    t = (-PVSCLIPEPSILON - d1) / (d2 - d1);
+
+        winding->x1 += t * (winding->x2 - winding->x1);
+        winding->y1 += t * (winding->y2 - winding->y1);
+    }
+    else if (d2 < -PVSCLIPEPSILON)
+    {
+        const double    t = (-PVSCLIPEPSILON - d2) / (d1 - d2);
+
+        winding->x2 += t * (winding->x1 - winding->x2);
+        winding->y2 += t * (winding->y1 - winding->y2);
+    }
+
+    return true;
+}
+
+//
+// P_ClipToSeparators
+// Clips target to the lines that separate windings a and b, so that all that
+// is left of it could be reached by a straight line passing through a and
+// then b. Returns false if nothing of target is left.
+//
+static bool P_ClipToSeparators(const pvswinding_t *a, const pvswinding_t *b, pvswinding_t *target)
+{
+    const double    ax[2] = { a->x1, a->x2 };
+    const double    ay[2] = { a->y1, a->y2 };
+    const double    bx[2] = { b->x1, b->x2 };
+    const double    by[2] = { b->y1, b->y2 };
+
+    for (int i = 0; i < 2; i++)
+        for (int j = 0; j < 2; j++)
+        {
+            const double    dx = bx[j] - ax[i];
+            const double    dy = by[j] - ay[i];
+            const double    sidea = dx * (ay[i ^ 1] - ay[i]) - dy * (ax[i ^ 1] - ax[i]);
+            const double    sideb = dx * (by[j ^ 1] - ay[i]) - dy * (bx[j ^ 1] - ax[i]);
+
+            // only a line with a and b on opposite sides of it separates them
+            if ((sidea <= 0.0 && sideb <= 0.0) || (sidea >= 0.0 && sideb >= 0.0))
+                continue;
+
+            // anything seen through a and then b is on b's side of the line
+            if (!P_ClipWinding(target, ax[i], ay[i], dx, dy, (sideb > 0.0)))
+                return false;
+        }
+
+    return true;
+}
+
+//
+// P_BasePortalVis
+// Floods through the portals in front of a portal to work out which sectors
+// might be seen through it. A straight line passing through portal p and then
+// portal q can only do so if part of q is in front of p, and part of p is
+// behind q.
+//
+static void P_BasePortalVis(pvsportal_t *portal)
+{
+    const pvswinding_t  *w = &portal->winding;
+    int                 head = 0;
+    int                 tail = 0;
+
+    pvsstamp++;
+    pvsleafstamp[portal->leaf] = pvsstamp;
+    pvsqueue[tail++] = portal->leaf;
+    SETROWBIT(portal->mightsee, portal->sector);
+
+    while (head < tail)
+    {
+        const int   leaf = pvsqueue[head++];
+
+        for (int i = pvsfirstportal[leaf]; i < pvsfirstportal[leaf + 1]; i++)
+        {
+            const pvsportal_t   *target = &pvsportals[i];
+            const pvswinding_t  *tw = &target->winding;
+
+            if (pvsleafstamp[target->leaf] == pvsstamp || target->edge == portal->edge)
+                continue;
+
+            if ((P_WindingSide(w, tw->x1, tw->y1) > PVSCLIPEPSILON
+                || P_WindingSide(w, tw->x2, tw->y2) > PVSCLIPEPSILON)
+                && (P_WindingSide(tw, w->x1, w->y1) < -PVSCLIPEPSILON
+                    || P_WindingSide(tw, w->x2, w->y2) < -PVSCLIPEPSILON))
+            {
+                pvsleafstamp[target->leaf] = pvsstamp;
+                pvsqueue[tail++] = target->leaf;
+                SETROWBIT(portal->mightsee, target->sector);
+            }
+        }
+    }
+
+    for (int i = 0; i < pvsnumsectors; i++)
+        if (ROWBITSET(portal->mightsee, i))
+            portal->mightcount++;
+}
+
+static void P_WindingRange(const pvswinding_t *winding, const pvswinding_t *part, double *t1, double *t2)
+{
+    const double    dx = winding->x2 - winding->x1;
+    const double    dy = winding->y2 - winding->y1;
+    const double    length2 = dx * dx + dy * dy;
+
+    *t1 = ((part->x1 - winding->x1) * dx + (part->y1 - winding->y1) * dy) / length2;
+    *t2 = ((part->x2 - winding->x1) * dx + (part->y2 - winding->y1) * dy) / length2;
+
+    if (*t1 > *t2)
+    {
+        const double    temp = *t1;
+
+        *t1 = *t2;
+        *t2 = temp;
+    }
+}
+
+//
+// P_AlreadyVisited
+// Returns true if the flow from base has already reached portal through at
+// least as much of the source and pass portals, and with at least as many
+// sectors it might still see, in which case anything that could be seen from
+// there has already been seen.
+//
+static bool P_AlreadyVisited(const pvsportal_t *base, pvsportal_t *portal,
+    const pvswinding_t *source, const pvswinding_t *pass, const byte *might)
+{
+    const int   flow = (int)(base - pvsportals);
+    double      s1, s2;
+    double      t1, t2;
+    pvsvisit_t  *visit;
+
+    P_WindingRange(&base->winding, source, &s1, &s2);
+    P_WindingRange(&portal->winding, pass, &t1, &t2);
+
+    for (int i = 0; i < PVSMAXVISITS; i++)
+    {
+        visit = &portal->visits[i];
+
+        if (visit->flow == flow && visit->s1 <= s1 && visit->s2 >= s2 && visit->t1 <= t1 && visit->t2 >= t2)
+        {
+            bool    more = false;
+
+            for (size_t j = 0; j < pvsrowsize; j++)
+                if (might[j] & ~visit->might[j])
+                {
+                    more = true;
+                    break;
+                }
+
+            if (!more)
+                return true;
+        }
+    }
+
+    visit = &portal->visits[portal->nextvisit];
+    portal->nextvisit = (portal->nextvisit + 1) % PVSMAXVISITS;
+    visit->flow = flow;
+    visit->s1 = s1;
+    visit->s2 = s2;
+    visit->t1 = t1;
+    visit->t2 = t2;
+    memcpy(visit->might, might, pvsrowsize);
+
+    return false;
+}
+
+//
+// P_RecursiveFlow
+// Marks every sector that can be seen through base from the portals of leaf,
+// having already passed through the source and pass windings.
+//
+static void P_RecursiveFlow(pvsportal_t *base, const int leaf, const pvswinding_t *sourcewinding,
+    const pvswinding_t *pass, const int depth)
+{
+    const byte  *might = &pvsmight[depth * pvsrowsize];
+    byte        *newmight = &pvsmight[(depth + 1) * pvsrowsize];
+
+    if (++pvssteps > PVSMAXSTEPS || depth + 1 >= PVSMAXDEPTH
+        || (!(pvssteps & 1023) && SDL_AtomicGet(&pvsquit)))
+    {
+        pvsoverflow = true;
+        return;
+    }
+
+    for (int i = pvsfirstportal[leaf]; i < pvsfirstportal[leaf + 1]; i++)
+    {
+        pvsportal_t         *portal = &pvsportals[i];
+        const byte          *test = (portal->done ? portal->vis : portal->mightsee);
+        pvswinding_t        target;
+        pvswinding_t        newsource;
+        bool                more = false;
+
+        if (!ROWBITSET(might, portal->sector))
+            continue;
+
+        // stop if nothing more can be seen this way
+        for (size_t j = 0; j < pvsrowsize; j++)
+        {
+            newmight[j] = (might[j] & test[j]);
+
+            if (newmight[j] & ~base->vis[j])
+                more = true;
+        }
+
+        if (!more && ROWBITSET(base->vis, portal->sector))
+            continue;
+
+        // anything seen through the pass portal is beyond it, and a portal in
+        // line with it can't be reached from it
+        target = portal->winding;
+
+        if ((P_WindingSide(pass, target.x1, target.y1) <= PVSCLIPEPSILON
+            && P_WindingSide(pass, target.x2, target.y2) <= PVSCLIPEPSILON)
+            || !P_ClipWinding(&target, pass->x1, pass->y1, pass->x2 - pass->x1, pass->y2 - pass->y1, true)
+            || !P_ClipToSeparators(sourcewinding, pass, &target))
+            continue;
+
+        // only the part of the source portal that can see the target is still needed
+        newsource = *sourcewinding;
+
+        if (!P_ClipToSeparators(&target, pass, &newsource))
+            continue;
+
+        SETROWBIT(base->vis, portal->sector);
+
+        if (P_AlreadyVisited(base, portal, &newsource, &target, newmight))
+            continue;
+
+        P_RecursiveFlow(base, portal->leaf, &newsource, &target, depth + 1);
+
+        if (pvsoverflow)
+            return;
+    }
+}
+
+static void P_PortalFlow(pvsportal_t *portal)
+{
+    pvssteps = 0;
+    pvsoverflow = false;
+
+    SETROWBIT(portal->vis, portal->sector);
+    memcpy(pvsmight, portal->mightsee, pvsrowsize);
+
+    P_RecursiveFlow(portal, portal->leaf, &portal->winding, &portal->winding, 0);
+
+    // if the flow took too long, fall back on what might be seen
+    if (pvsoverflow)
+        memcpy(portal->vis, portal->mightsee, pvsrowsize);
+
+    portal->done = true;
+}
+
+static int P_CompareMightCount(const void *a, const void *b)
+{
+    return (pvsportals[*(const int *)a].mightcount - pvsportals[*(const int *)b].mightcount);
+}
+
+static void P_FinishPVS(void)
+{
+    for (int i = 0; i < pvsnumleaves; i++)
+    {
+        const int   sector = pvsleafsector[i];
+
+        SETPVSBIT(pvsvisible, sector, sector);
+
+        for (int j = pvsfirstportal[i]; j < pvsfirstportal[i + 1]; j++)
+            for (int k = 0; k < pvsnumsectors; k++)
+                if (ROWBITSET(pvsportals[j].vis, k))
+                    SETPVSBIT(pvsvisible, sector, k);
+    }
+
+    // anything one sector can see can also see it
+    for (int i = 0; i < pvsnumsectors; i++)
+        for (int j = i + 1; j < pvsnumsectors; j++)
+            if (PVSBITSET(pvsvisible, i, j) || PVSBITSET(pvsvisible, j, i))
+            {
+                SETPVSBIT(pvsvisible, i, j);
+                SETPVSBIT(pvsvisible, j, i);
+            }
+}
+
+static int SDLCALL P_PVSThread(void *data)
+{
+    const uint64_t  start = I_GetTimeUS();
+
+    for (int i = 0; i < pvsnumportals; i++)
+    {
+        if (SDL_AtomicGet(&pvsquit))
+            return 0;
+
+        P_BasePortalVis(&pvsportals[i]);
+        pvsorder[i] = i;
+    }
+
+    // the portals that might see the least are done first, to narrow down the rest
+    qsort(pvsorder, pvsnumportals, sizeof(int), &P_CompareMightCount);
+
+    for (int i = 0; i < pvsnumportals; i++)
+    {
+        if (SDL_AtomicGet(&pvsquit))
+            return 0;
+
+        P_PortalFlow(&pvsportals[pvsorder[i]]);
+    }
+
+    P_FinishPVS();
+
+    pvsbuildtime = I_GetTimeUS() - start;
+    SDL_AtomicSet(&pvsdone, 1);
+
+    return 0;
+}
+
+//
+// P_FreePVSPortals
+//
+static void P_FreePVSPortals(void)
+{
+    free(pvsleafsector);
+    free(pvsfirstportal);
+    free(pvsportals);
+    free(pvsorder);
+    free(pvsportalbits);
+    free(pvsmight);
+    free(pvsvisitbits);
+    free(pvsleafstamp);
+    free(pvsqueue);
+
+    pvsleafsector = NULL;
+    pvsfirstportal = NULL;
+    pvsportals = NULL;
+    pvsorder = NULL;
+    pvsportalbits = NULL;
+    pvsmight = NULL;
+    pvsvisitbits = NULL;
+    pvsleafstamp = NULL;
+    pvsqueue = NULL;
+}
+
+static pvscell_t *P_NewPVSCell(const int numpoints)
+{
+    pvscell_t   *cell = malloc(sizeof(*cell));
+
+    if (!cell)
+        return NULL;
+
+    cell->numpoints = 0;
+    cell->x = malloc(numpoints * sizeof(double));
+    cell->y = malloc(numpoints * sizeof(double));
+    cell->tag = malloc(numpoints * sizeof(int));
+
+    if (!cell->x || !cell->y || !cell->tag)
+    {
+        free(cell->x);
+        free(cell->y);
+        free(cell->tag);
+        free(cell);
+        return NULL;
+    }
+
+    return cell;
+}
+
+static void P_FreePVSCell(pvscell_t *cell)
+{
+    if (cell)
+    {
+        free(cell->x);
+        free(cell->y);
+        free(cell->tag);
+        free(cell);
+    }
+}
+
+//
+// P_ClipPVSCell
+// Returns the part of a cell to the right of the line through (x, y) in the
+// direction (dx, dy), or to its left if left is true, keeping anything within
+// epsilon of it. Any new edge is tagged with tag.
+//
+static pvscell_t *P_ClipPVSCell(const pvscell_t *cell, const double x, const double y,
+    double dx, double dy, const bool left, const double epsilon, const int tag)
+{
+    const double    length = sqrt(dx * dx + dy * dy);
+    pvscell_t       *newcell = P_NewPVSCell(cell->numpoints + 1);
+    double          *side;
+
+    if (!newcell)
+        return NULL;
+
+    if (length < 0.001 || !(side = malloc(cell->numpoints * sizeof(double))))
+    {
+        memcpy(newcell->x, cell->x, cell->numpoints * sizeof(double));
+        memcpy(newcell->y, cell->y, cell->numpoints * sizeof(double));
+        memcpy(newcell->tag, cell->tag, cell->numpoints * sizeof(int));
+        newcell->numpoints = cell->numpoints;
+        return newcell;
+    }
+
+    if (!left)
+    {
+        dx = -dx;
+        dy = -dy;
+    }
+
+    for (int i = 0; i < cell->numpoints; i++)
+        side[i] = (dx * (cell->y[i] - y) - dy * (cell->x[i] - x)) / length + epsilon;
+
+    for (int i = 0; i < cell->numpoints; i++)
+    {
+        const int   j = (i + 1) % cell->numpoints;
+
+        if (side[i] >= 0.0)
+        {
+            newcell->x[newcell->numpoints] = cell->x[i];
+            newcell->y[newcell->numpoints] = cell->y[i];
+            newcell->tag[newcell->numpoints++] = cell->tag[i];
+        }
+
+        if ((side[i] >= 0.0) != (side[j] >= 0.0))
+        {
+            const double    t = side[i] / (side[i] - side[j]);
+
+            newcell->x[newcell->numpoints] = cell->x[i] + t * (cell->x[j] - cell->x[i]);
+            newcell->y[newcell->numpoints] = cell->y[i] + t * (cell->y[j] - cell->y[i]);
+            newcell->tag[newcell->numpoints++] = ((side[i] >= 0.0) ? tag : cell->tag[i]);
+        }
+    }
+
+    free(side);
+
+    return newcell;
+}
+
+//
+// P_AddPVSEdges
+// Clips a subsector's cell to the right of each of its segs, and adds the
+// edges of what's left that are on partition lines. If the subsector isn't
+// convex, its whole cell is used instead, since that's sure to enclose it.
+//
+static bool P_AddPVSEdges(const pvscell_t *cell, const int leaf, pvsedge_t **edges, int *maxedges)
+{
+    const subsector_t   *subsector = &subsectors[leaf];
+    pvscell_t           *clipped = NULL;
+    const pvscell_t     *result = cell;
+    double              cx = 0.0;
+    double              cy = 0.0;
+
+    for (int i = 0; i < subsector->numlines; i++)
+    {
+        const seg_t     *seg = &segs[subsector->firstline + i];
+        const double    x1 = FIXED2DOUBLE(seg->v1->x);
+        const double    y1 = FIXED2DOUBLE(seg->v1->y);
+        pvscell_t       *newcell = P_ClipPVSCell((clipped ? clipped : cell), x1, y1,
+                            FIXED2DOUBLE(seg->v2->x) - x1, FIXED2DOUBLE(seg->v2->y) - y1,
+                            false, PVSSEGEPSILON, PVSWALL);
+
+        P_FreePVSCell(clipped);
+
+        if (!(clipped = newcell))
+            return false;
+    }
+
+    if (clipped)
+    {
+        bool    convex = (clipped->numpoints >= 3);
+
+        for (int i = 0; i < subsector->numlines && convex; i++)
+        {
+            const seg_t *seg = &segs[subsector->firstline + i];
+
+            for (int j = 0; j < 2 && convex; j++)
+            {
+                const vertex_t  *v = (j ? seg->v2 : seg->v1);
+                const double    x = FIXED2DOUBLE(v->x);
+                const double    y = FIXED2DOUBLE(v->y);
+
+                for (int k = 0; k < clipped->numpoints; k++)
+                {
+                    const int       l = (k + 1) % clipped->numpoints;
+                    const double    dx = clipped->x[l] - clipped->x[k];
+                    const double    dy = clipped->y[l] - clipped->y[k];
+                    const double    length = sqrt(dx * dx + dy * dy);
+
+                    if (length >= 0.001
+                        && (dx * (y - clipped->y[k]) - dy * (x - clipped->x[k])) / length > PVSSEGEPSILON * 2.0)
+                    {
+                        convex = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (convex)
+            result = clipped;
+    }
+
+    for (int i = 0; i < result->numpoints; i++)
+    {
+        cx += result->x[i] / result->numpoints;
+        cy += result->y[i] / result->numpoints;
+    }
+
+    for (int i = 0; i < result->numpoints; i++)
+    {
+        const int   j = (i + 1) % result->numpoints;
+        const int   node = result->tag[i];
+        node_t      *bsp;
+        double      nx, ny, dx, dy, length2;
+        pvsedge_t   *edge;
+
+        if (node < 0)
+            continue;
+
+        if (pvsnumedges == *maxedges)
+        {
+            pvsedge_t   *newedges = realloc(*edges, (*maxedges = MAX(*maxedges * 2, 256)) * sizeof(pvsedge_t));
+
+            if (!newedges)
+            {
+                P_FreePVSCell(clipped);
+                return false;
+            }
+
+            *edges = newedges;
+        }
+
+        bsp = &nodes[node];
+        nx = FIXED2DOUBLE(bsp->x);
+        ny = FIXED2DOUBLE(bsp->y);
+        dx = FIXED2DOUBLE(bsp->dx);
+        dy = FIXED2DOUBLE(bsp->dy);
+        length2 = dx * dx + dy * dy;
+
+        edge = &(*edges)[pvsnumedges++];
+        edge->node = node;
+        edge->leaf = leaf;
+        edge->front = (dx * (cy - ny) - dy * (cx - nx) < 0.0);
+        edge->t1 = ((result->x[i] - nx) * dx + (result->y[i] - ny) * dy) / length2;
+        edge->t2 = ((result->x[j] - nx) * dx + (result->y[j] - ny) * dy) / length2;
+
+        if (edge->t1 > edge->t2)
+        {
+            const double    temp = edge->t1;
+
+            edge->t1 = edge->t2;
+            edge->t2 = temp;
+        }
+    }
+
+    P_FreePVSCell(clipped);
+
+    return true;
+}
+
+//
+// P_AddPVSCells
+// Works out the cell of every subsector below a node by clipping the cell of
+// the node to each side of its partition line.
+//
+static bool P_AddPVSCells(const int bspnum, const pvscell_t *cell, pvsedge_t **edges, int *maxedges)
+{
+    const node_t    *bsp;
+    bool            result = true;
+
+    if (bspnum & NF_SUBSECTOR)
+        return P_AddPVSEdges(cell, (bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR)), edges, maxedges);
+
+    bsp = &nodes[bspnum];
+
+    for (int side = 0; side < 2 && result; side++)
+    {
+        pvscell_t   *child = P_ClipPVSCell(cell, FIXED2DOUBLE(bsp->x), FIXED2DOUBLE(bsp->y),
+                        FIXED2DOUBLE(bsp->dx), FIXED2DOUBLE(bsp->dy), (side == 1), 0.0, bspnum);
+
+        result = (child && P_AddPVSCells(bsp->children[side], child, edges, maxedges));
+        P_FreePVSCell(child);
+    }
+
+    return result;
+}
+
+static int P_CompareEdges(const void *a, const void *b)
+{
+    const pvsedge_t *edge1 = a;
+    const pvsedge_t *edge2 = b;
+
+    return (edge1->node != edge2->node ? edge1->node - edge2->node : edge2->front - edge1->front);
+}
+
+//
+// P_RemoveWalls
+// Removes the parts of the range t1 to t2 along a partition line that are
+// covered by the one-sided segs of a subsector on it.
+//
+static int P_RemoveWalls(double *t1, double *t2, int count, const int leaf, const node_t *bsp)
+{
+    const subsector_t   *subsector = &subsectors[leaf];
+    const double        nx = FIXED2DOUBLE(bsp->x);
+    const double        ny = FIXED2DOUBLE(bsp->y);
+    const double        dx = FIXED2DOUBLE(bsp->dx);
+    const double        dy = FIXED2DOUBLE(bsp->dy);
+    const double        length2 = dx * dx + dy * dy;
+    const double        length = sqrt(length2);
+
+    for (int i = 0; i < subsector->numlines; i++)
+    {
+        const seg_t     *seg = &segs[subsector->firstline + i];
+        const double    x1 = FIXED2DOUBLE(seg->v1->x);
+        const double    y1 = FIXED2DOUBLE(seg->v1->y);
+        const double    x2 = FIXED2DOUBLE(seg->v2->x);
+        const double    y2 = FIXED2DOUBLE(seg->v2->y);
+        double          s1, s2;
+        int             newcount = 0;
+
+        if (!seg->linedef || seg->backsector
+            || fabs(dx * (y1 - ny) - dy * (x1 - nx)) / length > PVSSEGEPSILON
+            || fabs(dx * (y2 - ny) - dy * (x2 - nx)) / length > PVSSEGEPSILON)
+            continue;
+
+        s1 = ((x1 - nx) * dx + (y1 - ny) * dy) / length2;
+        s2 = ((x2 - nx) * dx + (y2 - ny) * dy) / length2;
+
+        if (s1 > s2)
+        {
+            const double    temp = s1;
+
+            s1 = s2;
+            s2 = temp;
+        }
+
+        // the ranges are kept in order, and removing a wall from one splits it in two at most
+        for (int j = 0; j < count && newcount < PVSMAXRANGES - 1; j++)
+        {
+            const double    a = t1[j];
+            const double    b = t2[j];
+
+            if (s2 <= a || s1 >= b)
+            {
+                t1[newcount] = a;
+                t2[newcount++] = b;
+                continue;
+            }
+
+            if (s1 > a)
+            {
+                t1[newcount] = a;
+                t2[newcount++] = s1;
+            }
+
+            if (s2 < b)
+            {
+                t1[newcount] = s2;
+                t2[newcount++] = b;
+            }
+        }
+
+        count = newcount;
+    }
+
+    return count;
+}
+
+static bool P_AddPVSPortal(const pvsedge_t *front, const pvsedge_t *back, const double t1, const double t2,
+    pvsportal_t **portals, int *maxportals)
+{
+    const node_t    *bsp = &nodes[front->node];
+    const double    nx = FIXED2DOUBLE(bsp->x);
+    const double    ny = FIXED2DOUBLE(bsp->y);
+    const double    dx = FIXED2DOUBLE(bsp->dx);
+    const double    dy = FIXED2DOUBLE(bsp->dy);
+    const double    length = sqrt(dx * dx + dy * dy);
+    const double    e = PVSEPSILON / length;
+    const double    x1 = nx + (t1 - e) * dx;
+    const double    y1 = ny + (t1 - e) * dy;
+    const double    x2 = nx + (t2 + e) * dx;
+    const double    y2 = ny + (t2 + e) * dy;
+    pvsportal_t     *portal;
+
+    if (pvsnumportals + 2 > *maxportals)
+    {
+        pvsportal_t *newportals = realloc(*portals, (*maxportals = MAX(*maxportals * 2, 256)) * sizeof(pvsportal_t));
+
+        if (!newportals)
+            return false;
+
+        *portals = newportals;
+    }
+
+    // the back of a partition line is on its left
+    portal = &(*portals)[pvsnumportals];
+    portal->winding.x1 = x1;
+    portal->winding.y1 = y1;
+    portal->winding.x2 = x2;
+    portal->winding.y2 = y2;
+    portal->edge = pvsnumportals / 2;
+    portal->source = front->leaf;
+    portal->leaf = back->leaf;
+    portal->sector = pvsleafsector[back->leaf];
+
+    portal = &(*portals)[pvsnumportals + 1];
+    portal->winding.x1 = x2;
+    portal->winding.y1 = y2;
+    portal->winding.x2 = x1;
+    portal->winding.y2 = y1;
+    portal->edge = pvsnumportals / 2;
+    portal->source = back->leaf;
+    portal->leaf = front->leaf;
+    portal->sector = pvsleafsector[front->leaf];
+
+    pvsnumportals += 2;
+
+    return true;
+}
+
+static int P_CompareSourceLeaf(const void *a, const void *b)
+{
+    return (((const pvsportal_t *)a)->source - ((const pvsportal_t *)b)->source);
+}
+
+//
+// P_InitPVSPortals
+// Works out the portals between the subsectors of the map, so the PVS can be
+// built on another thread.
+//
+static void P_InitPVSPortals(void)
+{
+    const node_t    *root = &nodes[numnodes - 1];
+    const double    left = FIXED2DOUBLE(MIN(root->bbox[0][BOXLEFT], root->bbox[1][BOXLEFT])) - 64.0;
+    const double    right = FIXED2DOUBLE(MAX(root->bbox[0][BOXRIGHT], root->bbox[1][BOXRIGHT])) + 64.0;
+    const double    bottom = FIXED2DOUBLE(MIN(root->bbox[0][BOXBOTTOM], root->bbox[1][BOXBOTTOM])) - 64.0;
+    const double    top = FIXED2DOUBLE(MAX(root->bbox[0][BOXTOP], root->bbox[1][BOXTOP])) + 64.0;
+    pvscell_t       *cell = P_NewPVSCell(4);
+    pvsedge_t       *edges = NULL;
+    int             maxedges = 0;
+    int             maxportals = 0;
+    int             first = 0;
+    bool            result;
+
+    pvsnumsectors = numsectors;
+    pvsnumleaves = numsubsectors;
+    pvsnumedges = 0;
+    pvsnumportals = 0;
+    pvsrowsize = ((size_t)numsectors + 7) / 8;
+
+    if (!cell || !(pvsleafsector = malloc(numsubsectors * sizeof(int))))
+    {
+        P_FreePVSCell(cell);
+        return;
+    }
+
+    for (int i = 0; i < numsubsectors; i++)
+        pvsleafsector[i] = subsectors[i].sector->id;
+
+    // start with a cell around the whole map
+    cell->x[0] = left;
+    cell->y[0] = bottom;
+    cell->x[1] = left;
+    cell->y[1] = top;
+    cell->x[2] = right;
+    cell->y[2] = top;
+    cell->x[3] = right;
+    cell->y[3] = bottom;
+    cell->tag[0] = PVSBOUNDARY;
+    cell->tag[1] = PVSBOUNDARY;
+    cell->tag[2] = PVSBOUNDARY;
+    cell->tag[3] = PVSBOUNDARY;
+    cell->numpoints = 4;
+
+    result = P_AddPVSCells(numnodes - 1, cell, &edges, &maxedges);
+    P_FreePVSCell(cell);
+
+    if (!result)
+    {
+        free(edges);
+        P_FreePVSPortals();
+        return;
+    }
+
+    // match the edges on the front of each partition line with those on its back
+    qsort(edges, pvsnumedges, sizeof(pvsedge_t), &P_CompareEdges);
+
+    while (first < pvsnumedges && result)
+    {
+        int last = first;
+        int back;
+
+        while (last < pvsnumedges && edges[last].node == edges[first].node)
+            last++;
+
+        back = first;
+
+        while (back < last && edges[back].front)
+            back++;
+
+        for (int i = first; i < back && result; i++)
+            for (int j = back; j < last && result; j++)
+            {
+                double  t1[PVSMAXRANGES] = { fmax(edges[i].t1, edges[j].t1) };
+                double  t2[PVSMAXRANGES] = { fmin(edges[i].t2, edges[j].t2) };
+                int     count;
+
+                if (t1[0] >= t2[0])
+                    continue;
+
+                count = P_RemoveWalls(t1, t2, 1, edges[i].leaf, &nodes[edges[i].node]);
+                count = P_RemoveWalls(t1, t2, count, edges[j].leaf, &nodes[edges[j].node]);
+
+                for (int k = 0; k < count && result; k++)
+                    result = P_AddPVSPortal(&edges[i], &edges[j], t1[k], t2[k], &pvsportals, &maxportals);
+            }
+
+        first = last;
+    }
+
+    free(edges);
+
+    // give up on maps that would need too much memory
+    if (!result
+        || ((size_t)pvsnumportals * (2 + PVSMAXVISITS) + PVSMAXDEPTH) * pvsrowsize > PVSMAXMEMORY
+        || !(pvsfirstportal = calloc((size_t)numsubsectors + 1, sizeof(int)))
+        || !(pvsorder = malloc(MAX(pvsnumportals, 1) * sizeof(int)))
+        || !(pvsportalbits = calloc(MAX(pvsnumportals, 1) * 2, pvsrowsize))
+        || !(pvsmight = calloc(PVSMAXDEPTH, pvsrowsize))
+        || !(pvsvisitbits = calloc(MAX(pvsnumportals, 1) * PVSMAXVISITS, pvsrowsize))
+        || !(pvsleafstamp = calloc(numsubsectors, sizeof(int)))
+        || !(pvsqueue = malloc(numsubsectors * sizeof(int))))
+    {
+        P_FreePVSPortals();
+        return;
+    }
+
+    // group the portals by the subsector they lead out of
+    qsort(pvsportals, pvsnumportals, sizeof(pvsportal_t), &P_CompareSourceLeaf);
+
+    for (int i = 0; i < pvsnumportals; i++)
+    {
+        pvsportal_t *portal = &pvsportals[i];
+
+        portal->mightcount = 0;
+        portal->mightsee = &pvsportalbits[i * 2 * pvsrowsize];
+        portal->vis = portal->mightsee + pvsrowsize;
+        portal->done = false;
+        portal->nextvisit = 0;
+
+        for (int j = 0; j < PVSMAXVISITS; j++)
+        {
+            portal->visits[j].flow = -1;
+            portal->visits[j].might = &pvsvisitbits[((size_t)i * PVSMAXVISITS + j) * pvsrowsize];
+        }
+
+        pvsfirstportal[portal->source + 1]++;
+    }
+
+    for (int i = 0; i < numsubsectors; i++)
+        pvsfirstportal[i + 1] += pvsfirstportal[i];
+
+    pvsstamp = 0;
+}
+
+//
+// P_GetPVSFilename
+// The PVS of each map is saved in a file named after a hash of what it's built from.
+//
+static void P_GetPVSFilename(char *filename, const size_t size, const bool createfolder)
+{
+    char    *appdatafolder = M_GetAppDataFolder();
+    char    folder[MAX_PATH];
+    char    digest[SHA1_DIGEST_SIZE * 2 + 1];
+
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++)
+        M_snprintf(&digest[i * 2], 3, "%02x", pvsdigest[i]);
+
+    M_snprintf(folder, sizeof(folder), "%s" DIR_SEPARATOR_S DOOMRETRO_PVSFOLDER, appdatafolder);
+
+    if (createfolder)
+        M_MakeDirectory(folder);
+
+    M_snprintf(filename, size, "%s" DIR_SEPARATOR_S "%s.pvs", folder, digest);
+    free(appdatafolder);
+}
+
+static void P_HashPVSValues(SHA1Context *context, const int *values, const int count)
+{
+    SHA1Update(context, (const byte *)values, count * sizeof(int));
+}
+
+//
+// P_GetPVSDigest
+// Hashes everything the PVS is built from: the BSP tree, the sector of each
+// subsector, and the segs with the walls among them.
+//
+static void P_GetPVSDigest(void)
+{
+    SHA1Context context;
+
+    SHA1Init(&context);
+    SHA1Update(&context, (const byte *)PVSMAGIC, strlen(PVSMAGIC));
+    P_HashPVSValues(&context, (const int []){ numsectors, numnodes, numsubsectors, numsegs }, 4);
+
+    for (int i = 0; i < numnodes; i++)
+    {
+        const node_t    *node = &nodes[i];
+
+        P_HashPVSValues(&context, (const int []){ node->x, node->y, node->dx, node->dy,
+            node->children[0], node->children[1] }, 6);
+    }
+
+    for (int i = 0; i < numsubsectors; i++)
+    {
+        const subsector_t   *subsector = &subsectors[i];
+
+        P_HashPVSValues(&context, (const int []){ subsector->sector->id, subsector->firstline,
+            subsector->numlines }, 3);
+    }
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        const seg_t *seg = &segs[i];
+
+        P_HashPVSValues(&context, (const int []){ seg->v1->x, seg->v1->y, seg->v2->x, seg->v2->y,
+            (seg->linedef && !seg->backsector) }, 5);
+    }
+
+    SHA1Final(pvsdigest, &context);
+}
+
+static size_t P_PVSSize(void)
+{
+    return (((size_t)pvsnumsectors * pvsnumsectors + 7) / 8);
+}
+
+static bool P_LoadPVS(void)
+{
+    char    filename[MAX_PATH];
+    char    magic[sizeof(PVSMAGIC)];
+    int     count;
+    FILE    *file;
+    bool    result = false;
+
+    P_GetPVSFilename(filename, sizeof(filename), false);
+
+    if (!(file = fopen(filename, "rb")))
+        return false;
+
+    if (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && !memcmp(magic, PVSMAGIC, sizeof(magic))
+        && fread(&count, sizeof(count), 1, file) == 1 && count == pvsnumsectors
+        && (pvsvisible = calloc(P_PVSSize(), 1)))
+    {
+        if (!(result = (fread(pvsvisible, 1, P_PVSSize(), file) == P_PVSSize())))
+        {
+            free(pvsvisible);
+            pvsvisible = NULL;
+        }
+    }
+
+    fclose(file);
+
+    return result;
+}
+
+static void P_SavePVS(void)
+{
+    char    filename[MAX_PATH];
+    FILE    *file;
+
+    P_GetPVSFilename(filename, sizeof(filename), true);
+
+    if (!(file = fopen(filename, "wb")))
+        return;
+
+    if (fwrite(PVSMAGIC, 1, sizeof(PVSMAGIC), file) != sizeof(PVSMAGIC)
+        || fwrite(&pvsnumsectors, sizeof(pvsnumsectors), 1, file) != 1
+        || fwrite(pvsvisible, 1, P_PVSSize(), file) != P_PVSSize())
+    {
+        fclose(file);
+        remove(filename);
+        return;
+    }
+
+    fclose(file);
+}
+
+//
+// P_InstallPVS
+// Starts using the PVS, and builds a reject matrix from it if the map has none.
+//
+static void P_InstallPVS(void)
+{
+    pvsmatrix = pvsvisible;
+    pvsgeneration++;
+
+    if (pvsemptyreject)
+    {
+        const size_t    size = P_PVSSize();
+        byte            *reject = Z_Malloc(size, PU_LEVEL, NULL);
+
+        for (size_t i = 0; i < size; i++)
+            reject[i] = ~pvsvisible[i];
+
+        rejectmatrix = pvsreject = reject;
+    }
+}
+
+//
+// P_StopPVS
+// Stops building the PVS, and stops using it.
+//
+void P_StopPVS(void)
+{
+    if (pvsthread)
+    {
+        SDL_AtomicSet(&pvsquit, 1);
+        SDL_WaitThread(pvsthread, NULL);
+        pvsthread = NULL;
+    }
+
+    if (pvsreject && rejectmatrix == pvsreject)
+        rejectmatrix = maprejectmatrix;
+
+    pvsreject = NULL;
+    pvsmatrix = NULL;
+    free(pvsvisible);
+    pvsvisible = NULL;
+    P_FreePVSPortals();
+}
+
+//
+// P_BuildPVS
+// Called by P_SetupLevel() once the map's REJECT lump has been loaded.
+// Loads the PVS of the map if it has been built before, and otherwise
+// starts building it on another thread.
+//
+void P_BuildPVS(const int lumpnum)
+{
+    const size_t    rejectsize = ((size_t)numsectors * numsectors + 7) / 8;
+
+    P_StopPVS();
+    pvslumpnum = lumpnum;
+
+    if (!r_pvs || numnodes <= 0 || numsectors <= 0 || numsectors > PVSMAXSECTORS)
+        return;
+
+    // only replace REJECT lumps that don't reject anything
+    maprejectmatrix = rejectmatrix;
+    pvsemptyreject = true;
+
+    for (size_t i = 0; i < rejectsize; i++)
+        if (maprejectmatrix[i])
+        {
+            pvsemptyreject = false;
+            break;
+        }
+
+    pvsnumsectors = numsectors;
+    P_GetPVSDigest();
+
+    if (P_LoadPVS())
+    {
+        P_InstallPVS();
+        return;
+    }
+
+    P_InitPVSPortals();
+
+    if (!pvsfirstportal || !(pvsvisible = calloc(P_PVSSize(), 1)))
+    {
+        P_FreePVSPortals();
+        return;
+    }
+
+    SDL_AtomicSet(&pvsdone, 0);
+    SDL_AtomicSet(&pvsquit, 0);
+
+    if (!(pvsthread = SDL_CreateThread(&P_PVSThread, "P_PVSThread", NULL)))
+    {
+        free(pvsvisible);
+        pvsvisible = NULL;
+        P_FreePVSPortals();
+    }
+}
+
+//
+// P_UpdatePVS
+// Called every tic to start using the PVS once it has been built.
+//
+void P_UpdatePVS(void)
+{
+    if (!pvsthread || !SDL_AtomicGet(&pvsdone))
+        return;
+
+    SDL_WaitThread(pvsthread, NULL);
+    pvsthread = NULL;
+    P_FreePVSPortals();
+
+    P_InstallPVS();
+    P_SavePVS();
+
+    C_Output("The potentially visible set of sectors in this map was built in %.2f seconds%s.",
+        pvsbuildtime / 1000000.0,
+        (pvsreject ? ", and has replaced its empty " BOLD("REJECT") " lump" : ""));
+}
+
+//
+// P_TogglePVS
+// Called when the r_pvs CVAR is changed.
+//
+void P_TogglePVS(void)
+{
+    if (r_pvs && gamestate == GS_LEVEL && pvslumpnum >= 0)
+        P_BuildPVS(pvslumpnum);
+    else
+        P_StopPVS();
+}
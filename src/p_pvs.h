@@ -0,0 +1,58 @@
+/*
+==============================================================================
+
+                                 DOOM Retro
+           The classic, refined DOOM source port. For Windows PC.
+
+==============================================================================
+
+    Copyright © 1993-2026 by id Software LLC, a ZeniMax Media company.
+    Copyright © 2013-2026 by Brad Harding <mailto:brad@doomretro.com>.
+
+    This file is a part of DOOM Retro.
+
+    DOOM Retro is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by the
+    Free Software Foundation, either version 3 of the license, or (at your
+    option) any later version.
+
+    DOOM Retro is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DOOM Retro. If not, see <https://www.gnu.org/licenses/>.
+
+    DOOM is a registered trademark of id Software LLC, a ZeniMax Media
+    company, in the US and/or other countries, and is used without
+    permission. All other trademarks are the property of their respective
+    holders. DOOM Retro is in no way affiliated with nor endorsed by
+    id Software.
+
+==============================================================================
+*/
+
+#pragma once
+
+#include "r_state.h"
+
+extern const byte   *pvsmatrix;
+extern const byte   *pvsreject;
+extern int          pvsgeneration;
+
+void P_BuildPVS(const int lumpnum);
+void P_StopPVS(void);
+void P_UpdatePVS(void);
+void P_TogglePVS(void);
+
+//
+// P_PotentiallyVisible
+// Returns true if any part of sector2 may be visible from anywhere in sector1.
+//
+inline static bool P_PotentiallyVisible(const int sector1, const int sector2)
+{
+    const int   pnum = sector1 * numsectors + sector2;
+
+    return (pvsmatrix[pnum >> 3] & (1 << (pnum & 7)));
+}
@@ -33,6 +33,9 @@
 ==============================================================================
 */
 
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
 #include "am_map.h"
 #include "c_cmds.h"
 #include "c_console.h"
@@ -40,6 +43,7 @@
 #include "doomstat.h"
 #include "g_game.h"
 #include "i_system.h"
+#include "m_array.h"
 #include "m_config.h"
 #include "m_menu.h"
 #include "m_misc.h"
@@ -59,18 +63,38 @@
 
 #define SAVEGAME_EOF    0x1D
 #define SAVEGAME_MAGIC  "DRSG"
-#define TARGETLIMIT     4192
+
+// initial size of the buffer savegames are written to
+#define SAVEBUFFERSIZE  (256 * 1024)
 
 FILE        *save_stream;
 
+static byte         *savebuffer;
+static size_t       savebufferlen;
+static size_t       savebuffersize;
+
+static SDL_Thread   *savethread;
+static SDL_atomic_t savedone;
+static bool         savecompress;
+static bool         saveresult;
+static char         savefilename[MAX_PATH];
+static char         savetempfilename[MAX_PATH];
+
 static char savegameversion[VERSIONSIZE];
 
-static int  thingindex;
-static int  targets[TARGETLIMIT];
-static int  tracers[TARGETLIMIT];
-static int  lastenemies[TARGETLIMIT];
-static int  soundtargets[TARGETLIMIT];
-static int  attacker;
+// [BH] the mobjs read from a savegame, in order, with the indices of the mobjs
+//  they point to, so P_RestoreTargets() can fix them up once they've all been read
+typedef struct
+{
+    mobj_t  *mobj;
+    int     target;
+    int     tracer;
+    int     lastenemy;
+} loadedthing_t;
+
+static loadedthing_t    *loadedthings;
+static int              *soundtargets;
+static int              attacker;
 
 // Get the filename of a temporary file to write the savegame to. After the
 // file has been successfully saved, it will be renamed to the real file.
@@ -103,9 +127,11 @@ char *P_SaveGameFile(int slot)
 FILE *P_OpenSaveGame(const char *filename)
 {
     byte    header[8];
-    FILE    *stream = fopen(filename, "rb");
+    FILE    *stream;
+
+    P_WaitForSaveGame();
 
-    if (!stream)
+    if (!(stream = fopen(filename, "rb")))
         return NULL;
 
     if (fread(header, 1, sizeof(header), stream) != sizeof(header)
@@ -148,39 +174,131 @@ FILE *P_OpenSaveGame(const char *filename)
     }
 }
 
-bool P_CompressSaveGameFile(const char *filename)
+//
+// P_SaveGameThread
+// Compresses the savegame in the buffer if needed, writes it to a temporary
+// file, and then renames that to the savegame file, backing up the old
+// savegame if there was one there.
+//
+static int SDLCALL P_SaveGameThread(void *data)
 {
-    FILE    *stream = fopen(filename, "rb");
-    bool    result = false;
+    const byte  *output = savebuffer;
+    size_t      outputlen = savebufferlen;
+    byte        *compressed = NULL;
+    const char  *temp_savegame_file = savetempfilename;
+
+    saveresult = false;
 
-    if (stream)
+    if (savecompress)
     {
-        const size_t    inputlen = W_FileLength(stream);
-        byte            *input = malloc(MAX(1, (int)inputlen));
-        mz_ulong        outputlen = mz_compressBound((mz_ulong)inputlen);
-        byte            *output = malloc(sizeof(SAVEGAME_MAGIC) - 1 + sizeof(unsigned int) + outputlen);
-
-        if (input
-            && output
-            && fread(input, 1, inputlen, stream) == inputlen
-            && mz_compress2(output + 8, &outputlen, input, (mz_ulong)inputlen, MZ_BEST_COMPRESSION) == MZ_OK)
+        mz_ulong    compressedlen = mz_compressBound((mz_ulong)savebufferlen);
+
+        if ((compressed = malloc(sizeof(SAVEGAME_MAGIC) - 1 + sizeof(unsigned int) + compressedlen))
+            && mz_compress2(compressed + 8, &compressedlen, savebuffer, (mz_ulong)savebufferlen,
+                MZ_BEST_COMPRESSION) == MZ_OK)
         {
-            memcpy(output, SAVEGAME_MAGIC, 4);
+            memcpy(compressed, SAVEGAME_MAGIC, 4);
 
-            output[4] = inputlen & 0xFF;
-            output[5] = (inputlen >> 8) & 0xFF;
-            output[6] = (inputlen >> 16) & 0xFF;
-            output[7] = (inputlen >> 24) & 0xFF;
+            compressed[4] = savebufferlen & 0xFF;
+            compressed[5] = (savebufferlen >> 8) & 0xFF;
+            compressed[6] = (savebufferlen >> 16) & 0xFF;
+            compressed[7] = (savebufferlen >> 24) & 0xFF;
 
-            result = W_WriteFile(filename, output, outputlen + 8);
+            output = compressed;
+            outputlen = compressedlen + 8;
         }
+        else
+            output = NULL;
+    }
 
-        free(output);
-        free(input);
-        fclose(stream);
+    if (output && W_WriteFile(temp_savegame_file, output, outputlen))
+    {
+        char    *backup_savegame_file = M_StringJoin(savefilename, ".bak", NULL);
+
+        remove(backup_savegame_file);
+        rename(savefilename, backup_savegame_file);
+        rename(temp_savegame_file, savefilename);
+        free(backup_savegame_file);
+
+        saveresult = true;
     }
+    else
+        remove(temp_savegame_file);
 
-    return result;
+    free(compressed);
+    SDL_AtomicSet(&savedone, 1);
+
+    return 0;
+}
+
+//
+// P_BeginSaveGame
+// Empties the buffer for a new savegame to be written to, once the last one
+// has been written to its file.
+//
+void P_BeginSaveGame(void)
+{
+    P_WaitForSaveGame();
+    savebufferlen = 0;
+}
+
+static void P_SaveGameFailed(void)
+{
+    menuactive = false;
+    C_ShowConsole(false);
+    C_Warning(0, BOLD("%s") " couldn't be saved.", savefilename);
+}
+
+//
+// P_FinishSaveGame
+// Starts writing the savegame in the buffer to filename.
+//
+void P_FinishSaveGame(const char *filename, const bool compress)
+{
+    M_StringCopy(savefilename, filename, sizeof(savefilename));
+    M_StringCopy(savetempfilename, P_TempSaveGameFile(), sizeof(savetempfilename));
+    savecompress = compress;
+    SDL_AtomicSet(&savedone, 0);
+
+    if (!(savethread = SDL_CreateThread(&P_SaveGameThread, "P_SaveGameThread", NULL)))
+    {
+        // couldn't create the thread, so write the savegame now instead
+        P_SaveGameThread(NULL);
+
+        if (saveresult)
+            G_SavedGame();
+        else
+            P_SaveGameFailed();
+    }
+}
+
+//
+// P_WaitForSaveGame
+// Waits for the last savegame to be written to its file, and then reports
+// whether it was.
+//
+void P_WaitForSaveGame(void)
+{
+    if (savethread)
+    {
+        SDL_WaitThread(savethread, NULL);
+        savethread = NULL;
+
+        if (saveresult)
+            G_SavedGame();
+        else
+            P_SaveGameFailed();
+    }
+}
+
+//
+// P_UpdateSaveGame
+// Called every tic by G_Ticker() to finish up once the last savegame has been written.
+//
+void P_UpdateSaveGame(void)
+{
+    if (savethread && SDL_AtomicGet(&savedone))
+        P_WaitForSaveGame();
 }
 
 // Endian-safe integer read/write functions
@@ -196,7 +314,10 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    fwrite(&value, 1, 1, save_stream);
+    if (savebufferlen == savebuffersize)
+        savebuffer = I_Realloc(savebuffer, (savebuffersize = (savebuffersize ? savebuffersize * 2 : SAVEBUFFERSIZE)));
+
+    savebuffer[savebufferlen++] = value;
 }
 
 static short saveg_read16(void)
@@ -284,36 +405,32 @@ static void saveg_write_mapthing_t(const mapthing_t *str)
     saveg_write16(str->options);
 }
 
-static int P_ThingToIndex(const mobj_t *thing)
+//
+// P_IndexThings
+// Numbers the mobjs in the order they will be saved in, so P_ThingToIndex()
+// doesn't need to search for them. Mobjs that have been removed but are still
+// referenced get 0.
+//
+void P_IndexThings(void)
 {
     int i = 0;
 
-    if (!thing)
-        return 0;
-
     for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
-    {
-        i++;
+        ((mobj_t *)th)->saveindex = ++i;
 
-        if ((mobj_t *)th == thing)
-            return i;
-    }
+    for (thinker_t *th = thinkers[th_delete].cnext; th != &thinkers[th_delete]; th = th->cnext)
+        if (th->pooled)
+            ((mobj_t *)th)->saveindex = 0;
+}
 
-    return 0;
+static int P_ThingToIndex(const mobj_t *thing)
+{
+    return (thing ? thing->saveindex : 0);
 }
 
 static mobj_t *P_IndexToThing(const int index)
 {
-    int i = 0;
-
-    if (!index)
-        return NULL;
-
-    for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
-        if (++i == index)
-            return (mobj_t *)th;
-
-    return NULL;
+    return (index > 0 && index <= array_size(loadedthings) ? loadedthings[index - 1].mobj : NULL);
 }
 
 //
@@ -321,7 +438,8 @@ static mobj_t *P_IndexToThing(const int index)
 //
 static void saveg_read_mobj_t(mobj_t *str)
 {
-    int state;
+    int             state;
+    loadedthing_t   loadedthing = { str };
 
     str->x = saveg_read32();
     str->y = saveg_read32();
@@ -346,7 +464,7 @@ static void saveg_read_mobj_t(mobj_t *str)
     str->health = saveg_read32();
     str->movedir = saveg_read32();
     str->movecount = saveg_read32();
-    targets[thingindex] = saveg_read32();
+    loadedthing.target = saveg_read32();
     str->reactiontime = saveg_read32();
     str->threshold = saveg_read32();
 
@@ -357,8 +475,9 @@ static void saveg_read_mobj_t(mobj_t *str)
     }
 
     saveg_read_mapthing_t(&str->spawnpoint);
-    tracers[thingindex] = saveg_read32();
-    lastenemies[thingindex] = saveg_read32();
+    loadedthing.tracer = saveg_read32();
+    loadedthing.lastenemy = saveg_read32();
+    array_push(loadedthings, loadedthing);
     str->floatbob = saveg_read32();
     str->shadowoffset = saveg_read32();
     str->gear = saveg_read16();
@@ -1350,6 +1469,8 @@ void P_UnarchiveWorld(void)
     sector_t    *sector = sectors;
     line_t      *line = lines;
 
+    soundtargets = I_Realloc(soundtargets, numsectors * sizeof(*soundtargets));
+
     // do sectors
     for (int i = 0; i < numsectors; i++, sector++)
     {
@@ -1368,7 +1489,7 @@ void P_UnarchiveWorld(void)
         sector->tag = saveg_read16();
         sector->ceilingdata = NULL;
         sector->floordata = NULL;
-        soundtargets[MIN(i, TARGETLIMIT - 1)] = saveg_read32();
+        soundtargets[i] = saveg_read32();
         sector->floorxoffset = saveg_read32();
         sector->flooryoffset = saveg_read32();
         sector->ceilingxoffset = saveg_read32();
@@ -1498,6 +1619,9 @@ void P_UnarchiveThinkers(void)
             P_RemoveMobj((mobj_t *)th);
             P_RemoveThinkerDelayed(th);
         }
+        else if (th->pooled)
+            // [BH] a removed mobj that was still referenced
+            P_FreeMobj((mobj_t *)th);
         else
             Z_Free(th);
 
@@ -1505,12 +1629,11 @@ void P_UnarchiveThinkers(void)
     }
 
     P_InitThinkers();
+    array_free(loadedthings);
 
     bloodsplats_fifo_head = NULL;
     bloodsplats_fifo_tail = NULL;
 
-    thingindex = 0;
-
     totalitems = viewplayer->itemcount;
     totalkills = viewplayer->killcount;
 
@@ -1523,7 +1646,7 @@ void P_UnarchiveThinkers(void)
         {
             case tc_mobj:
             {
-                mobj_t  *mobj = Z_Calloc(1, sizeof(*mobj), PU_LEVEL, NULL);
+                mobj_t  *mobj = P_AllocMobj();
 
                 saveg_read_mobj_t(mobj);
 
@@ -1539,7 +1662,6 @@ void P_UnarchiveThinkers(void)
                 mobj->colfunc = mobj->info->colfunc;
                 mobj->altcolfunc = mobj->info->altcolfunc;
                 P_SetShadowColumnFunction(mobj);
-                thingindex = MIN(thingindex + 1, TARGETLIMIT - 1);
 
                 if ((mobj->flags & MF_COUNTKILL)
                     && mobj->health > 0
@@ -1590,24 +1712,25 @@ void P_UnarchiveThinkers(void)
 void P_RestoreTargets(void)
 {
     sector_t    *sec = sectors;
-    int         targetlimit = MIN(numsectors, TARGETLIMIT - 1);
 
     P_SetNewTarget(&viewplayer->attacker, P_IndexToThing(attacker));
 
-    for (int i = 0; i < targetlimit; i++, sec++)
+    for (int i = 0; i < numsectors; i++, sec++)
         P_SetNewTarget(&sec->soundtarget, P_IndexToThing(soundtargets[i]));
 
-    thingindex = 0;
-
-    for (thinker_t *th = thinkers[th_mobj].cnext; th != &thinkers[th_mobj]; th = th->cnext)
+    for (int i = 0; i < array_size(loadedthings); i++)
     {
-        mobj_t  *mo = (mobj_t *)th;
+        const loadedthing_t *loadedthing = &loadedthings[i];
+        mobj_t              *mo = loadedthing->mobj;
 
-        P_SetNewTarget(&mo->target, P_IndexToThing(targets[thingindex]));
-        P_SetNewTarget(&mo->tracer, P_IndexToThing(tracers[thingindex]));
-        P_SetNewTarget(&mo->lastenemy, P_IndexToThing(lastenemies[thingindex]));
-        thingindex = MIN(thingindex + 1, TARGETLIMIT - 1);
+        P_SetNewTarget(&mo->target, P_IndexToThing(loadedthing->target));
+        P_SetNewTarget(&mo->tracer, P_IndexToThing(loadedthing->tracer));
+        P_SetNewTarget(&mo->lastenemy, P_IndexToThing(loadedthing->lastenemy));
     }
+
+    array_free(loadedthings);
+    free(soundtargets);
+    soundtargets = NULL;
 }
 
 //
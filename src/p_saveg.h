@@ -72,7 +72,13 @@ char *P_TempSaveGameFile(void);
 char *P_SaveGameFile(int slot);
 
 FILE *P_OpenSaveGame(const char *filename);
-bool P_CompressSaveGameFile(const char *filename);
+
+// Savegames are written to a buffer, which is then compressed and written to
+// the savegame file on a separate thread
+void P_BeginSaveGame(void);
+void P_FinishSaveGame(const char *filename, const bool compress);
+void P_WaitForSaveGame(void);
+void P_UpdateSaveGame(void);
 
 // Savegame file header read/write functions
 bool P_ReadSaveGameHeader(char *description);
@@ -88,6 +94,8 @@ void P_WriteSaveGameFooter(void);
 
 // Persistent storage/archiving.
 // These are the load/save game routines.
+// P_IndexThings() must be called before any of the P_Archive*() functions.
+void P_IndexThings(void);
 void P_ArchivePlayer(void);
 void P_UnarchivePlayer(void);
 void P_ArchiveWorld(void);
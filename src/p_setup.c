@@ -36,12 +36,15 @@
 #include <math.h>
 #include <ctype.h>
 
+#include "SDL_thread.h"
+
 #include "am_map.h"
 #include "c_cmds.h"
 #include "c_console.h"
 #include "d_deh.h"
 #include "d_main.h"
 #include "doomstat.h"
+#include "g_game.h"
 #include "i_swap.h"
 #include "i_system.h"
 #include "i_timer.h"
@@ -56,12 +59,16 @@
 #include "nano_bsp/nano_bsp.h"
 #include "p_fix.h"
 #include "p_local.h"
+#include "p_pvs.h"
 #include "p_setup.h"
 #include "p_tick.h"
 #include "r_sky.h"
 #include "r_state.h"
 #include "s_sound.h"
+#include "sha1.h"
 #include "st_stuff.h"
+#include "version.h"
+#include "w_file.h"
 #include "w_wad.h"
 #include "z_zone.h"
 
@@ -193,6 +200,33 @@ bool            mbfcompatible = false;
 bool            mbf21compatible = false;
 bool            blockmaprebuilt;
 
+static SDL_Thread   *blockmapthread;
+static int          blockmaplumpnum;
+static int          blockmapwarning;
+
+// [BH] stages of loading a map, timed and shown in the console when the
+//  vid_showprofile CVAR is on
+enum
+{
+    LOADSTAGE_MAPDATA,
+    LOADSTAGE_BLOCKMAP,
+    LOADSTAGE_NODES,
+    LOADSTAGE_LINES,
+    LOADSTAGE_THINGS,
+    LOADSTAGE_PRECACHE,
+    LOADSTAGE_MUSIC,
+    NUMLOADSTAGES
+};
+
+static const char *loadstagenames[NUMLOADSTAGES] =
+{
+    "map data", "blockmap", "nodes", "lines and segs", "things and specials", "textures and sprites", "music"
+};
+
+static uint64_t     loadstagetimes[NUMLOADSTAGES];
+static uint64_t     loadstagestart;
+static uint64_t     loadstarttime;
+
 const char *linespecials[NUMLINESPECIALS] =
 {
     "",
@@ -1969,6 +2003,364 @@ static void P_LoadZNodes(int lump, nodeformat_t format)
     P_CheckLinedefs();
 }
 
+//
+// NODES CACHE
+// [BH] The nodes NanoBSP builds for a map are saved in a file named after a
+//  hash of what they're built from, and loaded from it the next time the map
+//  is loaded rather than being built again. NANOBSP_VERSION is included in
+//  the hash so nodes built by an older version of NanoBSP aren't loaded.
+//
+#define NODESMAGIC  "DRNODES2"
+
+static byte nodesdigest[SHA1_DIGEST_SIZE];
+
+static void P_GetNodesFilename(char *filename, const size_t size, const bool createfolder)
+{
+    char    *appdatafolder = M_GetAppDataFolder();
+    char    folder[MAX_PATH];
+    char    digest[SHA1_DIGEST_SIZE * 2 + 1];
+
+    for (int i = 0; i < SHA1_DIGEST_SIZE; i++)
+        M_snprintf(&digest[i * 2], 3, "%02x", nodesdigest[i]);
+
+    M_snprintf(folder, sizeof(folder), "%s" DIR_SEPARATOR_S DOOMRETRO_NODESFOLDER, appdatafolder);
+
+    if (createfolder)
+        M_MakeDirectory(folder);
+
+    M_snprintf(filename, size, "%s" DIR_SEPARATOR_S "%s.nodes", folder, digest);
+    free(appdatafolder);
+}
+
+static void P_HashNodesValues(SHA1Context *context, const int *values, const int count)
+{
+    SHA1Update(context, (const byte *)values, count * sizeof(int));
+}
+
+//
+// P_GetNodesDigest
+// Hashes the VERTEXES, LINEDEFS, SIDEDEFS and SECTORS lumps of the map, and
+// the vertexes and linedefs as they were loaded, since they may have been fixed.
+//
+static void P_GetNodesDigest(const int lumpnum)
+{
+    const int   maplumps[] = { ML_VERTEXES, ML_LINEDEFS, ML_SIDEDEFS, ML_SECTORS };
+    SHA1Context context;
+
+    SHA1Init(&context);
+    SHA1Update(&context, (const byte *)NODESMAGIC, strlen(NODESMAGIC));
+    P_HashNodesValues(&context, (const int []){ NANOBSP_VERSION }, 1);
+
+    for (int i = 0; i < arrlen(maplumps); i++)
+    {
+        const int   lump = lumpnum + maplumps[i];
+        const int   length = (lump < numlumps ? W_LumpLength(lump) : 0);
+
+        P_HashNodesValues(&context, &length, 1);
+
+        if (length > 0)
+        {
+            SHA1Update(&context, W_CacheLumpNum(lump), length);
+            W_ReleaseLumpNum(lump);
+        }
+    }
+
+    P_HashNodesValues(&context, (const int []){ numvertexes, numlines, numsides, numsectors }, 4);
+
+    for (int i = 0; i < numvertexes; i++)
+        P_HashNodesValues(&context, (const int []){ vertexes[i].x, vertexes[i].y }, 2);
+
+    for (int i = 0; i < numlines; i++)
+    {
+        const line_t    *line = &lines[i];
+
+        P_HashNodesValues(&context, (const int []){ (int)(line->v1 - vertexes), (int)(line->v2 - vertexes),
+            line->sidenum[0], line->sidenum[1], (line->frontsector ? (int)(line->frontsector - sectors) : -1),
+            (line->backsector ? (int)(line->backsector - sectors) : -1) }, 6);
+    }
+
+    SHA1Final(nodesdigest, &context);
+}
+
+static int P_CompareVertexes(const void *a, const void *b)
+{
+    const uintptr_t vertex1 = (uintptr_t)*(const vertex_t **)a;
+    const uintptr_t vertex2 = (uintptr_t)*(const vertex_t **)b;
+
+    return (vertex1 < vertex2 ? -1 : (vertex1 > vertex2));
+}
+
+//
+// P_VertexNum
+// Returns the index of a vertex used by a seg, with the vertexes created by
+// splitting segs following those of the map.
+//
+static int P_VertexNum(vertex_t *vertex, vertex_t **newvertexes, const int numnewvertexes)
+{
+    vertex_t    **newvertex;
+
+    if (vertex >= vertexes && vertex < vertexes + numvertexes)
+        return (int)(vertex - vertexes);
+
+    newvertex = bsearch(&vertex, newvertexes, numnewvertexes, sizeof(*newvertexes), &P_CompareVertexes);
+
+    return (numvertexes + (int)(newvertex - newvertexes));
+}
+
+//
+// P_SaveCachedNodes
+// Saves the nodes, subsectors and segs NanoBSP has just built.
+//
+static void P_SaveCachedNodes(void)
+{
+    char        filename[MAX_PATH];
+    FILE        *file;
+    vertex_t    **newvertexes;
+    int         numnewvertexes = 0;
+    int         *buffer;
+    int         *p;
+    size_t      size;
+
+    if (!(newvertexes = malloc((size_t)numsegs * 2 * sizeof(*newvertexes))))
+        return;
+
+    // find the vertexes created by splitting segs
+    for (int i = 0; i < numsegs; i++)
+    {
+        vertex_t    *seg_vertexes[] = { segs[i].v1, segs[i].v2 };
+
+        for (int j = 0; j < 2; j++)
+            if (seg_vertexes[j] < vertexes || seg_vertexes[j] >= vertexes + numvertexes)
+                newvertexes[numnewvertexes++] = seg_vertexes[j];
+    }
+
+    if (numnewvertexes)
+    {
+        int count = 1;
+
+        qsort(newvertexes, numnewvertexes, sizeof(*newvertexes), &P_CompareVertexes);
+
+        for (int i = 1; i < numnewvertexes; i++)
+            if (newvertexes[i] != newvertexes[count - 1])
+                newvertexes[count++] = newvertexes[i];
+
+        numnewvertexes = count;
+    }
+
+    size = (8 + (size_t)numnewvertexes * 2 + (size_t)numsubsectors * 2 + (size_t)numsegs * 8) * sizeof(int)
+        + (size_t)numnodes * sizeof(node_t);
+
+    if (!(buffer = malloc(size)))
+    {
+        free(newvertexes);
+        return;
+    }
+
+    p = buffer;
+    *p++ = numvertexes;
+    *p++ = numlines;
+    *p++ = numsides;
+    *p++ = numsectors;
+    *p++ = numnewvertexes;
+    *p++ = numnodes;
+    *p++ = numsubsectors;
+    *p++ = numsegs;
+
+    for (int i = 0; i < numnewvertexes; i++)
+    {
+        *p++ = newvertexes[i]->x;
+        *p++ = newvertexes[i]->y;
+    }
+
+    memcpy(p, nodes, (size_t)numnodes * sizeof(node_t));
+    p += (size_t)numnodes * sizeof(node_t) / sizeof(int);
+
+    for (int i = 0; i < numsubsectors; i++)
+    {
+        *p++ = subsectors[i].firstline;
+        *p++ = subsectors[i].numlines;
+    }
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        const seg_t *seg = &segs[i];
+
+        *p++ = P_VertexNum(seg->v1, newvertexes, numnewvertexes);
+        *p++ = P_VertexNum(seg->v2, newvertexes, numnewvertexes);
+        *p++ = seg->offset;
+        *p++ = (int)seg->angle;
+        *p++ = (int)(seg->linedef - lines);
+        *p++ = (int)(seg->sidedef - sides);
+        *p++ = (seg->frontsector ? (int)(seg->frontsector - sectors) : -1);
+        *p++ = (seg->backsector ? (int)(seg->backsector - sectors) : -1);
+    }
+
+    free(newvertexes);
+    P_GetNodesFilename(filename, sizeof(filename), true);
+
+    if ((file = fopen(filename, "wb")))
+    {
+        const bool  result = (fwrite(NODESMAGIC, 1, sizeof(NODESMAGIC), file) == sizeof(NODESMAGIC)
+                        && fwrite(nodesdigest, 1, sizeof(nodesdigest), file) == sizeof(nodesdigest)
+                        && fwrite(buffer, 1, size, file) == size);
+
+        fclose(file);
+
+        if (!result)
+            remove(filename);
+    }
+
+    free(buffer);
+}
+
+//
+// P_LoadCachedNodes
+// Loads the nodes, subsectors and segs NanoBSP built the last time this map was
+// loaded, after checking they're valid. Returns false if they need to be built.
+//
+static bool P_LoadCachedNodes(void)
+{
+    char        filename[MAX_PATH];
+    char        magic[sizeof(NODESMAGIC)];
+    byte        digest[SHA1_DIGEST_SIZE];
+    int         header[8];
+    FILE        *file;
+    int         *buffer = NULL;
+    int         *p;
+    size_t      size;
+    vertex_t    *newvertexes = NULL;
+    int         numnewvertexes;
+    bool        result = false;
+
+    P_GetNodesFilename(filename, sizeof(filename), false);
+
+    if (!(file = fopen(filename, "rb")))
+        return false;
+
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, NODESMAGIC, sizeof(magic))
+        || fread(digest, 1, sizeof(digest), file) != sizeof(digest) || memcmp(digest, nodesdigest, sizeof(digest))
+        || fread(header, sizeof(int), 8, file) != 8
+        || header[0] != numvertexes || header[1] != numlines || header[2] != numsides || header[3] != numsectors
+        || header[4] < 0 || header[5] < 0 || header[6] <= 0 || header[7] <= 0
+        || header[4] > numlines * 64 || header[5] > numlines * 64
+        || header[6] > numlines * 64 || header[7] > numlines * 64)
+    {
+        fclose(file);
+        return false;
+    }
+
+    numnewvertexes = header[4];
+    numnodes = header[5];
+    numsubsectors = header[6];
+    numsegs = header[7];
+
+    size = ((size_t)numnewvertexes * 2 + (size_t)numsubsectors * 2 + (size_t)numsegs * 8) * sizeof(int)
+        + (size_t)numnodes * sizeof(node_t);
+
+    if (!(buffer = malloc(size)) || fread(buffer, 1, size, file) != size || fgetc(file) != EOF)
+    {
+        free(buffer);
+        fclose(file);
+        return false;
+    }
+
+    fclose(file);
+
+    p = buffer;
+
+    if (numnewvertexes)
+    {
+        newvertexes = Z_Malloc(numnewvertexes * sizeof(vertex_t), PU_LEVEL, NULL);
+
+        for (int i = 0; i < numnewvertexes; i++)
+        {
+            newvertexes[i].x = *p++;
+            newvertexes[i].y = *p++;
+        }
+    }
+
+    nodes = Z_Malloc(numnodes * sizeof(node_t), PU_LEVEL, NULL);
+    memcpy(nodes, p, (size_t)numnodes * sizeof(node_t));
+    p += (size_t)numnodes * sizeof(node_t) / sizeof(int);
+
+    subsectors = Z_Calloc(numsubsectors, sizeof(subsector_t), PU_LEVEL, NULL);
+    segs = Z_Calloc(numsegs, sizeof(seg_t), PU_LEVEL, NULL);
+
+    // each child of a node must be a subsector or a node before it, so the
+    // tree can't loop
+    for (int i = 0; i < numnodes; i++)
+        for (int j = 0; j < 2; j++)
+        {
+            const int   child = nodes[i].children[j];
+
+            if ((child & NF_SUBSECTOR) ? (child & ~NF_SUBSECTOR) >= numsubsectors : child < 0 || child >= i)
+                goto done;
+        }
+
+    for (int i = 0; i < numsubsectors; i++)
+    {
+        subsector_t *subsector = &subsectors[i];
+
+        subsector->firstline = *p++;
+        subsector->numlines = *p++;
+
+        if (subsector->firstline < 0 || subsector->numlines <= 0
+            || subsector->firstline > numsegs - subsector->numlines)
+            goto done;
+    }
+
+    for (int i = 0; i < numsegs; i++)
+    {
+        seg_t       *seg = &segs[i];
+        const int   v1 = *p++;
+        const int   v2 = *p++;
+        const int   offset = *p++;
+        const int   angle = *p++;
+        const int   linedef = *p++;
+        const int   sidedef = *p++;
+        const int   frontsector = *p++;
+        const int   backsector = *p++;
+
+        if (v1 < 0 || v1 >= numvertexes + numnewvertexes || v2 < 0 || v2 >= numvertexes + numnewvertexes
+            || linedef < 0 || linedef >= numlines || sidedef < 0 || sidedef >= numsides
+            || frontsector < -1 || frontsector >= numsectors || backsector < -1 || backsector >= numsectors)
+            goto done;
+
+        seg->v1 = (v1 < numvertexes ? &vertexes[v1] : &newvertexes[v1 - numvertexes]);
+        seg->v2 = (v2 < numvertexes ? &vertexes[v2] : &newvertexes[v2 - numvertexes]);
+        seg->offset = offset;
+        seg->angle = (angle_t)angle;
+        seg->linedef = &lines[linedef];
+        seg->sidedef = &sides[sidedef];
+        seg->frontsector = (frontsector >= 0 ? &sectors[frontsector] : NULL);
+        seg->backsector = (backsector >= 0 ? &sectors[backsector] : NULL);
+    }
+
+    result = true;
+
+done:
+    free(buffer);
+
+    if (!result)
+    {
+        Z_Free(segs);
+        Z_Free(subsectors);
+        Z_Free(nodes);
+
+        if (newvertexes)
+            Z_Free(newvertexes);
+
+        segs = NULL;
+        subsectors = NULL;
+        nodes = NULL;
+        numnodes = 0;
+        numsubsectors = 0;
+        numsegs = 0;
+    }
+
+    return result;
+}
+
 //
 // P_LoadThings
 //
@@ -2064,8 +2456,18 @@ static void P_LoadThings(int map, int lump)
         }
     }
 
-    M_Seed((unsigned int)time(NULL));
-    M_BigSeed((unsigned int)time(NULL));
+    if (demorecording || demoplayback)
+    {
+        // [BH] use the seed stored in the demo so it plays back the same
+        M_Seed(demoseed);
+        M_BigSeed(demoseed);
+    }
+    else
+    {
+        M_Seed((unsigned int)time(NULL));
+        M_BigSeed((unsigned int)time(NULL));
+    }
+
     M_Fuzz1Seed((unsigned int)time(NULL));
     M_Fuzz2Seed((unsigned int)time(NULL));
     W_ReleaseLumpNum(lump);
@@ -2688,16 +3090,17 @@ static void P_LoadBlockMap(int lump)
 
     blockmaprebuilt = false;
 
+    blockmapwarning = 0;
+
     if (lump >= numlumps || (lumplen = W_LumpLength(lump)) < 8 || (count = lumplen / 2) >= 0x010000)
     {
         P_CreateBlockMap();
-        C_Warning(2, "The " BOLD("BLOCKMAP") " lump has been rebuilt.");
+        blockmapwarning = 2;
     }
     else if (M_CheckParm("-blockmap"))
     {
         P_CreateBlockMap();
-        C_Warning(1, "A " BOLD("-blockmap") " parameter was found on the command-line. "
-            "The " BOLD("BLOCKMAP") " lump has been rebuilt.");
+        blockmapwarning = 1;
     }
     else
     {
@@ -2731,7 +3134,7 @@ static void P_LoadBlockMap(int lump)
         if (!P_VerifyBlockMap(count))
         {
             P_CreateBlockMap();
-            C_Warning(2, "The " BOLD("BLOCKMAP") " lump has been rebuilt.");
+            blockmapwarning = 2;
         }
     }
 
@@ -2748,6 +3151,71 @@ static void P_LoadBlockMap(int lump)
     blockmapyneg = (bmapheight > 255 ? bmapheight - 512 : -257);
 }
 
+//
+// P_BlockMapThread
+// [BH] The blockmap only depends on the vertexes and linedefs, so it's loaded
+//  or created on another thread while the nodes are loaded or built.
+//
+static int SDLCALL P_BlockMapThread(void *data)
+{
+    const uint64_t  starttime = I_GetTimeUS();
+
+    P_LoadBlockMap(blockmaplumpnum);
+    loadstagetimes[LOADSTAGE_BLOCKMAP] = I_GetTimeUS() - starttime;
+
+    return 0;
+}
+
+//
+// P_FinishBlockMap
+// Waits for the blockmap thread to finish, and shows any warnings it couldn't.
+//
+static void P_FinishBlockMap(void)
+{
+    if (blockmapthread)
+    {
+        SDL_WaitThread(blockmapthread, NULL);
+        blockmapthread = NULL;
+
+        if (blockmaplumpnum < numlumps)
+            W_ReleaseLumpNum(blockmaplumpnum);
+    }
+
+    if (blockmapwarning == 1)
+        C_Warning(1, "A " BOLD("-blockmap") " parameter was found on the command-line. "
+            "The " BOLD("BLOCKMAP") " lump has been rebuilt.");
+    else if (blockmapwarning == 2)
+        C_Warning(2, "The " BOLD("BLOCKMAP") " lump has been rebuilt.");
+
+    blockmapwarning = 0;
+}
+
+static void P_EndLoadStage(const int stage)
+{
+    const uint64_t  now = I_GetTimeUS();
+
+    loadstagetimes[stage] = now - loadstagestart;
+    loadstagestart = now;
+}
+
+// [BH] the blockmap may be loaded at the same time as the nodes, so the total
+//  is measured separately rather than being the sum of the stages
+static void P_ShowLoadStages(const uint64_t total)
+{
+    char    buffer[512] = "";
+
+    for (int i = 0; i < NUMLOADSTAGES; i++)
+    {
+        char    temp[64];
+
+        M_snprintf(temp, sizeof(temp), "%s%s %.1fms", (i ? ", " : ""), loadstagenames[i],
+            loadstagetimes[i] / 1000.0);
+        M_StringCopy(buffer + strlen(buffer), temp, sizeof(buffer) - strlen(buffer));
+    }
+
+    C_Output("The map took %.1fms to load (%s).", total / 1000.0, buffer);
+}
+
 //
 // reject overrun emulation
 //
@@ -3364,27 +3832,23 @@ static nodeformat_t P_CheckNodeFormat(int lumpnum)
         {
             n = W_CacheLumpNum(ssectorlump);
 
-        if (!memcmp(n, "XGLN", 4))
-            format = XGLN;
-        else if (!memcmp(n, "ZGLN", 4))
-            format = ZGLN;
-        else if (!memcmp(n, "XGL2", 4))
-            format = XGL2;
-        else if (!memcmp(n, "ZGL2", 4))
-            format = ZGL2;
-        else if (!memcmp(n, "XGL3", 4))
-            format = XGL3;
-        else if (!memcmp(n, "ZGL3", 4))
-            format = ZGL3;
+            if (!memcmp(n, "XGLN", 4))
+                format = XGLN;
+            else if (!memcmp(n, "ZGLN", 4))
+                format = ZGLN;
+            else if (!memcmp(n, "XGL2", 4))
+                format = XGL2;
+            else if (!memcmp(n, "ZGL2", 4))
+                format = ZGL2;
+            else if (!memcmp(n, "XGL3", 4))
+                format = XGL3;
+            else if (!memcmp(n, "ZGL3", 4))
+                format = ZGL3;
+
+            W_ReleaseLumpNum(ssectorlump);
         }
     }
 
-    if (n)
-    {
-        Z_Free(n);
-        n = NULL;
-    }
-
     if (format == DOOMBSP)
     {
         int nodelump = lumpnum + ML_NODES;
@@ -3399,6 +3863,8 @@ static nodeformat_t P_CheckNodeFormat(int lumpnum)
                 format = XNOD;
             else if (!memcmp(n, "ZNOD", 4))
                 format = ZNOD;
+
+            W_ReleaseLumpNum(nodelump);
         }
         else
             format = NANOBSP;
@@ -3407,12 +3873,6 @@ static nodeformat_t P_CheckNodeFormat(int lumpnum)
     if (subsize == sizeof(mapsubsector_t) && !nodesize)
         format = DOOMBSP;
 
-    if (n)
-    {
-        Z_Free(n);
-        n = NULL;
-    }
-
     return format;
 }
 
@@ -3428,6 +3888,8 @@ void P_SetupLevel(int ep, int map)
 
     id24compatible = false;
 
+    P_ClearSightCache();
+
     nummappedlines = 0;
     totalkills = 0;
     totalitems = 0;
@@ -3445,9 +3907,16 @@ void P_SetupLevel(int ep, int map)
     idclevtics = 0;
     iddttics = 0;
 
-    I_Sleep(400);
+    // [BH] let any sounds still playing finish, rather than always waiting
+    S_WaitForSounds(400);
     S_StopSounds();
+
+    loadstarttime = loadstagestart = I_GetTimeUS();
+    memset(loadstagetimes, 0, sizeof(loadstagetimes));
+
+    P_StopPVS();
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    P_ClearMobjPool();
 
     if (rejectlump != -1)
     {
@@ -3482,18 +3951,30 @@ void P_SetupLevel(int ep, int map)
             if (map == 31 || map == 32 || (map == 33 && bfgedition) || (gamemission == pack_nerve && map == 9))
                 secretmap = true;
 
-            for (int i = 0; i < numlumps; i++)
-                if (!strncasecmp(lumpinfo[i]->name, lumpname, 8))
+            // [BH] find the last lump of each kind with this name, from last to first
+            for (int i = W_CheckNumForName(lumpname); i >= 0; i = W_NextNumForName(i, lumpname))
+            {
+                if (D_IsDOOM2IWAD(lumpinfo[i]->wadfile->path))
                 {
-                    if (D_IsDOOM2IWAD(lumpinfo[i]->wadfile->path))
+                    if (iwadlump == -1)
                         iwadlump = i;
-                    else if (D_IsNERVEWAD(lumpinfo[i]->wadfile->path))
+                }
+                else if (D_IsNERVEWAD(lumpinfo[i]->wadfile->path))
+                {
+                    if (nervelump == -1)
                         nervelump = i;
-                    else if (D_IsMasterLevelsWAD(lumpinfo[i]->wadfile->path))
+                }
+                else if (D_IsMasterLevelsWAD(lumpinfo[i]->wadfile->path))
+                {
+                    if (masterlevelslump == -1)
                         masterlevelslump = i;
-                    else if (lumpinfo[i]->wadfile->type == PWAD && !D_IsResourceWAD(lumpinfo[i]->wadfile->path))
+                }
+                else if (lumpinfo[i]->wadfile->type == PWAD && !D_IsResourceWAD(lumpinfo[i]->wadfile->path))
+                {
+                    if (pwadlump == -1)
                         pwadlump = i;
                 }
+            }
 
             if (gamemission == pack_nerve && nervelump >= 0)
                 lumpnum = nervelump;
@@ -3521,15 +4002,15 @@ void P_SetupLevel(int ep, int map)
         secretmap = P_IsSecret(ep, map);
 
     if ((!numconsolestrings
-        || (!M_StringStartsWith(console[numconsolestrings - 1].string, "map ")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "load ")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "newgame")
-            && !M_StringCompare(console[numconsolestrings - 1].string, "restartmap")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "Warping ")
-            && !M_StringStartsWith(console[numconsolestrings - 1].string, "Restarting ")
+        || (!M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "map ")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "load ")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "newgame")
+            && !M_StringCompare(CONSOLESTRING(numconsolestrings - 1).string, "restartmap")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "Warping ")
+            && !M_StringStartsWith(CONSOLESTRING(numconsolestrings - 1).string, "Restarting ")
             && !autostart))
         && ((numconsolestrings == 1
-            || (!M_StringStartsWith(console[numconsolestrings - 2].string, "map ")
+            || (!M_StringStartsWith(CONSOLESTRING(numconsolestrings - 2).string, "map ")
                 && !autostart))))
     {
         const char  *mapinfolabel = trimwhitespace(P_GetLabel(ep, map));
@@ -3551,7 +4032,8 @@ void P_SetupLevel(int ep, int map)
 
     nodeformat = P_CheckNodeFormat(lumpnum);
 
-    canmodify = ((W_GetNumLumps(lumpname) == 1
+    canmodify = (((W_NextNumForName(W_GetNumForName(lumpname), lumpname) == -1
+            && !(chex || hacx || harmony || REKKRSA))
         || (sigil && gamemission == doom)
         || (sigil2 && gamemission == doom)
         || gamemission == pack_nerve
@@ -3622,12 +4104,36 @@ void P_SetupLevel(int ep, int map)
 
     P_LoadLineDefs2();
 
+    P_EndLoadStage(LOADSTAGE_MAPDATA);
+
     if (!samelevel)
-        P_LoadBlockMap(lumpnum + ML_BLOCKMAP);
+    {
+        blockmaplumpnum = lumpnum + ML_BLOCKMAP;
+
+        // [BH] load the nodes while the blockmap is loaded or created, unless
+        //  loading them replaces the vertexes the blockmap is created from
+        if (nodeformat == DOOMBSP || nodeformat == DEEPBSP || nodeformat >= NANOBSP)
+        {
+            // lock the lump so it can't be purged while it's being read
+            if (blockmaplumpnum < numlumps)
+                W_LockLumpNum(blockmaplumpnum);
+
+            if (!(blockmapthread = SDL_CreateThread(&P_BlockMapThread, "P_BlockMapThread", NULL))
+                && blockmaplumpnum < numlumps)
+                W_ReleaseLumpNum(blockmaplumpnum);
+        }
+
+        if (!blockmapthread)
+        {
+            P_LoadBlockMap(blockmaplumpnum);
+            P_EndLoadStage(LOADSTAGE_BLOCKMAP);
+        }
+    }
     else
     {
         memset(blocklinks, 0, (size_t)bmapwidth * bmapheight * sizeof(*blocklinks));
         memset(bloodsplat_blocklinks, 0, (size_t)bmapwidth * bmapheight * sizeof(*bloodsplat_blocklinks));
+        P_EndLoadStage(LOADSTAGE_BLOCKMAP);
     }
 
     if (nodeformat == DOOMBSP)
@@ -3647,10 +4153,22 @@ void P_SetupLevel(int ep, int map)
     else if (nodeformat >= XGLN && nodeformat <= ZGL3)
         P_LoadZNodes(lumpnum + ML_SSECTORS, nodeformat);
     else if (nodeformat >= NANOBSP)
-        BSP_BuildNodes();
+    {
+        P_GetNodesDigest(lumpnum);
+
+        if (!P_LoadCachedNodes())
+        {
+            BSP_BuildNodes();
+            P_SaveCachedNodes();
+        }
+    }
+
+    P_FinishBlockMap();
+    P_EndLoadStage(LOADSTAGE_NODES);
 
     P_GroupLines();
     P_LoadReject(lumpnum);
+    P_BuildPVS(lumpnum);
 
     P_InitSubsectorLines();
 
@@ -3660,6 +4178,8 @@ void P_SetupLevel(int ep, int map)
     P_CalcSegsLength();
     P_CalcFakeContrast();
 
+    P_EndLoadStage(LOADSTAGE_LINES);
+
     nummarks = 0;
     maxmarks = 0;
     mark = NULL;
@@ -3689,15 +4209,24 @@ void P_SetupLevel(int ep, int map)
 
     P_MapEnd();
 
+    P_EndLoadStage(LOADSTAGE_THINGS);
+
     // preload graphics
     R_PrecacheLevel();
 
+    P_EndLoadStage(LOADSTAGE_PRECACHE);
+
     if (!musinfo.fromsavegame)
         S_Start();
 
     S_ParseMusInfo(lumpname);
     musinfo.fromsavegame = false;
 
+    P_EndLoadStage(LOADSTAGE_MUSIC);
+
+    if (vid_showprofile)
+        P_ShowLoadStages(I_GetTimeUS() - loadstarttime);
+
     compat_corpsegibs = P_GetMapCompatCorpseGibs(ep, map);
     compat_floormove = P_GetMapCompatFloorMove(ep, map);
     compat_light = P_GetMapCompatLight(ep, map);
@@ -33,8 +33,10 @@
 ==============================================================================
 */
 
+#include "i_system.h"
 #include "m_bbox.h"
 #include "p_local.h"
+#include "p_pvs.h"
 
 //
 // P_CheckSight
@@ -56,6 +58,36 @@ typedef struct
 
 static los_t    los;            // cph - made static
 
+// [BH] Cache of the results of P_CheckSight(). Besides the heights of sectors,
+// a result only depends on the exact positions of both things, so those are
+// used as the key. The cache is cleared each tic and whenever a sector moves.
+#define SIGHTCACHESIZE  4096
+
+typedef struct
+{
+    fixed_t         x1, y1, z1;
+    fixed_t         x2, y2, z2;
+    fixed_t         height2;
+    unsigned int    stamp;
+    bool            result;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHESIZE];
+static unsigned int sightcachestamp = 1;
+
+bool                checksight;
+uint64_t            sightchecks;
+uint64_t            sightcachehits;
+
+void P_ClearSightCache(void)
+{
+    if (!++sightcachestamp)
+    {
+        memset(sightcache, 0, sizeof(sightcache));
+        sightcachestamp = 1;
+    }
+}
+
 static int P_DivlineCrossed(fixed_t x1, fixed_t y1, fixed_t x2, fixed_t y2, divline_t *node)
 {
     if (!node->dx)
@@ -199,41 +231,11 @@ static bool P_CrossBSPNode(int bspnum)
 }
 
 //
-// P_CheckSight
-// Returns true if a straight line between t1 and t2 is unobstructed. Uses REJECT.
+// P_CheckLineOfSight
+// Returns true if a straight line from the eyes of t1 to any part of t2 is unobstructed.
 //
-bool P_CheckSight(mobj_t *t1, mobj_t *t2)
+static bool P_CheckLineOfSight(const mobj_t *t1, const mobj_t *t2)
 {
-    const sector_t  *s1 = t1->subsector->sector;
-    const sector_t  *s2 = t2->subsector->sector;
-    const int       pnum = s1->id * numsectors + s2->id;
-
-    // First check for trivial rejection.
-    // Determine subsector entries in REJECT table.
-    // Check in REJECT table.
-    if (rejectmatrix[pnum >> 3] & (1 << (pnum & 7)))
-        return false;
-
-    // killough 04/19/98: make fake floors and ceilings block monster view
-    if ((s1->heightsec
-        && ((t1->z + t1->height <= s1->heightsec->interpfloorheight
-            && t2->z >= s1->heightsec->interpfloorheight)
-            || (t1->z >= s1->heightsec->interpceilingheight
-                && t2->z + t2->height <= s1->heightsec->interpceilingheight)))
-        || (s2->heightsec
-            && ((t2->z + t2->height <= s2->heightsec->interpfloorheight
-                && t1->z >= s2->heightsec->interpfloorheight)
-                || (t2->z >= s2->heightsec->interpceilingheight
-                    && t1->z + t1->height <= s2->heightsec->interpceilingheight))))
-        return false;
-
-    // killough 11/98: shortcut for melee situations
-    // same subsector? obviously visible
-    if (t1->subsector == t2->subsector)
-        return true;
-
-    // An unobstructed LOS is possible.
-    // Now look from eyes of t1 to any part of t2.
     validcount++;
 
     los.sightzstart = t1->z + t1->height - (t1->height >> 2);
@@ -273,6 +275,87 @@ bool P_CheckSight(mobj_t *t1, mobj_t *t2)
     return P_CrossBSPNode(numnodes - 1);
 }
 
+//
+// P_CheckSight
+// Returns true if a straight line between t1 and t2 is unobstructed. Uses REJECT.
+//
+bool P_CheckSight(mobj_t *t1, mobj_t *t2)
+{
+    const sector_t  *s1 = t1->subsector->sector;
+    const sector_t  *s2 = t2->subsector->sector;
+    const int       pnum = s1->id * numsectors + s2->id;
+    fixed_t         sightzstart;
+    unsigned int    hash;
+    sightcache_t    *entry;
+
+    // First check for trivial rejection.
+    // Determine subsector entries in REJECT table.
+    // Check in REJECT table.
+    if (rejectmatrix[pnum >> 3] & (1 << (pnum & 7)))
+    {
+        // [BH] a reject matrix built from the PVS must never reject a line of sight
+        if (checksight && rejectmatrix == pvsreject && P_CheckLineOfSight(t1, t2))
+            I_Error("P_CheckSight: The PVS rejected a line of sight from sector %i to sector %i.",
+                s1->id, s2->id);
+
+        return false;
+    }
+
+    // killough 04/19/98: make fake floors and ceilings block monster view
+    if ((s1->heightsec
+        && ((t1->z + t1->height <= s1->heightsec->interpfloorheight
+            && t2->z >= s1->heightsec->interpfloorheight)
+            || (t1->z >= s1->heightsec->interpceilingheight
+                && t2->z + t2->height <= s1->heightsec->interpceilingheight)))
+        || (s2->heightsec
+            && ((t2->z + t2->height <= s2->heightsec->interpfloorheight
+                && t1->z >= s2->heightsec->interpfloorheight)
+                || (t2->z >= s2->heightsec->interpceilingheight
+                    && t1->z + t1->height <= s2->heightsec->interpceilingheight))))
+        return false;
+
+    // killough 11/98: shortcut for melee situations
+    // same subsector? obviously visible
+    if (t1->subsector == t2->subsector)
+        return true;
+
+    // [BH] Already checked this tic?
+    sightzstart = t1->z + t1->height - (t1->height >> 2);
+    hash = (((unsigned int)t1->x * 0x9E3779B1u) ^ ((unsigned int)t1->y * 0x85EBCA77u)
+        ^ ((unsigned int)t2->x * 0xC2B2AE3Du) ^ ((unsigned int)t2->y * 0x27D4EB2Fu)
+        ^ ((unsigned int)sightzstart * 0x165667B1u) ^ (unsigned int)t2->z);
+    entry = &sightcache[(hash ^ (hash >> 15)) & (SIGHTCACHESIZE - 1)];
+    sightchecks++;
+
+    if (entry->stamp == sightcachestamp
+        && entry->x1 == t1->x && entry->y1 == t1->y && entry->z1 == sightzstart
+        && entry->x2 == t2->x && entry->y2 == t2->y && entry->z2 == t2->z
+        && entry->height2 == t2->height)
+    {
+        sightcachehits++;
+
+        // [BH] -checksight: make sure the cached result is the same as it would've been
+        if (checksight && P_CheckLineOfSight(t1, t2) != entry->result)
+            I_Error("P_CheckSight: The cached result for %s and %s doesn't match.",
+                t1->info->name1, t2->info->name1);
+
+        return entry->result;
+    }
+
+    entry->x1 = t1->x;
+    entry->y1 = t1->y;
+    entry->z1 = sightzstart;
+    entry->x2 = t2->x;
+    entry->y2 = t2->y;
+    entry->z2 = t2->z;
+    entry->height2 = t2->height;
+    entry->stamp = sightcachestamp;
+
+    // An unobstructed LOS is possible.
+    // Now look from eyes of t1 to any part of t2.
+    return (entry->result = P_CheckLineOfSight(t1, t2));
+}
+
 //
 // MBF21: P_CheckFOV
 // Returns true if t2 is within t1's field of view.
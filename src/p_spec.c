@@ -989,7 +989,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                 else
                     M_snprintf(buffer, sizeof(buffer), s_PD_ANY, playername, "s", s_PD_KEYCARDORSKULLKEY);
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1018,7 +1018,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_REDK : s_PD_REDC), playername, "s",
                         (viewplayer->cards[it_redskull] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_KEYCARD));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1047,7 +1047,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_BLUEK : s_PD_BLUEC), playername, "s",
                         (viewplayer->cards[it_blueskull] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_KEYCARD));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1076,7 +1076,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_YELLOWK : s_PD_YELLOWC), playername, "s",
                         (viewplayer->cards[it_yellowskull] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_KEYCARD));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1105,7 +1105,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_REDK : s_PD_REDS), playername, "s",
                         (viewplayer->cards[it_redcard] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_SKULLKEY));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1134,7 +1134,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_BLUEK : s_PD_BLUES), playername, "s",
                         (viewplayer->cards[it_bluecard] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_SKULLKEY));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1163,7 +1163,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                     M_snprintf(buffer, sizeof(buffer), (skulliscard ? s_PD_YELLOWK : s_PD_YELLOWS), playername, "s",
                         (viewplayer->cards[it_yellowcard] == CARDNOTFOUNDYET && skulliscard ? s_PD_KEYCARDORSKULLKEY : s_PD_SKULLKEY));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1190,7 +1190,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                 M_snprintf(buffer, sizeof(buffer), s_PD_ALL6,
                     C_GetPlayerName(), (isdefaultplayername() ? "" : "s"));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -1214,7 +1214,7 @@ bool P_CanUnlockGenDoor(const line_t *line)
                 M_snprintf(buffer, sizeof(buffer), s_PD_ALL3,
                     C_GetPlayerName(), (isdefaultplayername() ? "" : "s"));
 
-                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, console[numconsolestrings - 1].string))
+                if (autousing && numconsolestrings > 0 && M_StringCompare(buffer, CONSOLESTRING(numconsolestrings - 1).string))
                     return false;
 
                 HU_PlayerMessage(buffer, false, false);
@@ -38,6 +38,7 @@
 #include "m_config.h"
 #include "m_menu.h"
 #include "p_local.h"
+#include "p_pvs.h"
 #include "p_tick.h"
 #include "s_sound.h"
 #include "z_zone.h"
@@ -57,6 +58,9 @@ int         totaltime;
 // a special class of thinkers, to allow more efficient searches.
 thinker_t   thinkers[th_all + 1];
 
+// number of thinkers run during the last tic
+int         thinkersrun;
+
 //
 // P_InitThinkers
 //
@@ -102,6 +106,9 @@ void P_AddThinker(thinker_t *thinker)
     // killough 11/98: init reference counter to 0
     thinker->references = 0;
 
+    // [BH] mobjs are always allocated by P_AllocMobj()
+    thinker->pooled = (thinker->function == &P_MobjThinker || thinker->function == &MusInfoThinker);
+
     // killough 08/29/98: set sentinel pointers, and then add to appropriate list
     thinker->cnext = NULL;
     thinker->cprev = NULL;
@@ -149,7 +156,11 @@ void P_RemoveThinkerDelayed(thinker_t *thinker)
 
         // Remove from current thinker class list
         (th->cprev = thinker->cprev)->cnext = th;
-        Z_Free(thinker);
+
+        if (thinker->pooled)
+            P_FreeMobj((mobj_t *)thinker);
+        else
+            Z_Free(thinker);
     }
 }
 
@@ -199,15 +210,22 @@ void P_SetTarget(mobj_t **mop, mobj_t *targ)
 //
 void P_Ticker(void)
 {
+    // [BH] Don't freeze the game while recording or playing back a demo,
+    //  otherwise it won't play back the same.
+    const bool  demo = (demorecording || demoplayback);
+
+    P_UpdatePVS();
+
     if (paused)
         return;
 
+    P_ClearSightCache();
     P_PlayerThink();
 
-    if ((consoleactive && !menuactive) || (helpscreen && !palettescreen))
+    if (((consoleactive && !menuactive) || (helpscreen && !palettescreen)) && !demo)
         return;
 
-    if (menuactive && !(viewplayer->cheats & CF_FREEZE))
+    if (menuactive && !(viewplayer->cheats & CF_FREEZE) && !demo)
     {
         if (!(gametime & 2))
         {
@@ -241,9 +259,14 @@ void P_Ticker(void)
         return;
     }
 
+    thinkersrun = 0;
+
     for (currentthinker = thinkers[th_all].next; currentthinker != &thinkers[th_all]; currentthinker = currentthinker->next)
         if (currentthinker->function)
+        {
             currentthinker->function((mobj_t *)currentthinker);
+            thinkersrun++;
+        }
 
     P_UpdateSpecials();
     T_MAPMusic();
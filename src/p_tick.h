@@ -63,3 +63,4 @@ enum
 };
 
 extern thinker_t    thinkers[];
+extern int          thinkersrun;
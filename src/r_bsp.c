@@ -35,7 +35,9 @@
 
 #include "doomstat.h"
 #include "m_bbox.h"
+#include "i_system.h"
 #include "m_config.h"
+#include "p_pvs.h"
 #include "r_plane.h"
 #include "r_segs.h"
 #include "r_things.h"
@@ -50,11 +52,29 @@ static sector_t     *visiblesector;
 drawseg_t           *drawsegs;
 drawseg_t           *ds_p;
 
+uint64_t            bspnodesvisited;
+uint64_t            bspnodesculled;
+uint64_t            bspsubsectorsvisited;
+
+static byte         *pvsnodes;
+static byte         *pvssubsectors;
+static int          pvsviewsector = -1;
+static int          pvsviewgeneration = -1;
+static bool         pvsculling;
+
 //
 // R_ClearDrawSegs
 //
 void R_ClearDrawSegs(void)
 {
+    const unsigned int  size = R_GrowPool(MAX(maxdrawsegs, MAXDRAWSEGS), (unsigned int)(ds_p - drawsegs));
+
+    if (size != maxdrawsegs)
+    {
+        maxdrawsegs = size;
+        drawsegs = I_Realloc(drawsegs, maxdrawsegs * sizeof(*drawsegs));
+    }
+
     ds_p = drawsegs;
 }
 
@@ -566,6 +586,7 @@ static void R_Subsector(int num)
     seg_t       *line = segs + sub->firstline;
 
     visiblesector = sector;
+    bspsubsectorsvisited++;
 
     // [AM] Interpolate sector movement. Usually only needed when player is standing inside the sector.
     R_InterpolateSector(sector);
@@ -633,6 +654,82 @@ static void R_Subsector(int num)
     frontsector = saved_frontsector;
 }
 
+//
+// R_MarkPVSNode
+// Marks whether any subsector below a given node is in a sector in the PVS
+// of the sector the player is in.
+//
+static bool R_MarkPVSNode(const int bspnum)
+{
+    const node_t    *bsp;
+    bool            visible;
+
+    if (bspnum & NF_SUBSECTOR)
+    {
+        const int   i = (bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR));
+
+        return (pvssubsectors[i] = P_PotentiallyVisible(pvsviewsector, subsectors[i].sector->id));
+    }
+
+    bsp = nodes + bspnum;
+    visible = R_MarkPVSNode(bsp->children[0]);
+    visible |= R_MarkPVSNode(bsp->children[1]);
+
+    return (pvsnodes[bspnum] = visible);
+}
+
+//
+// R_SetupPVS
+// [BH] Called every frame to work out which subtrees of the BSP tree can be
+// skipped, because nothing in them can be seen from the sector the player is in.
+//
+void R_SetupPVS(void)
+{
+    static int  numpvsnodes;
+    static int  numpvssubsectors;
+    int         viewsector;
+
+    if (!r_pvs || !pvsmatrix || !numnodes || (viewplayer->cheats & CF_NOCLIP))
+    {
+        pvsculling = false;
+        return;
+    }
+
+    pvsculling = true;
+    viewsector = R_PointInSubsector(viewx, viewy)->sector->id;
+
+    if (viewsector == pvsviewsector && pvsgeneration == pvsviewgeneration)
+        return;
+
+    if (numnodes > numpvsnodes)
+    {
+        pvsnodes = I_Realloc(pvsnodes, numnodes);
+        numpvsnodes = numnodes;
+    }
+
+    if (numsubsectors > numpvssubsectors)
+    {
+        pvssubsectors = I_Realloc(pvssubsectors, numsubsectors);
+        numpvssubsectors = numsubsectors;
+    }
+
+    pvsviewsector = viewsector;
+    pvsviewgeneration = pvsgeneration;
+    R_MarkPVSNode(numnodes - 1);
+}
+
+static bool R_CullNode(const int bspnum)
+{
+    if (!pvsculling)
+        return false;
+
+    if ((bspnum & NF_SUBSECTOR) ? pvssubsectors[bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR)] : pvsnodes[bspnum])
+        return false;
+
+    bspnodesculled++;
+    return true;
+}
+
 //
 // R_RenderBSPNode
 // Renders all subsectors below a given node, traversing subtree recursively.
@@ -650,6 +747,7 @@ void R_RenderBSPNode(int bspnum)
     {
         const node_t    *bsp;
         int             side;
+        bool            culled = false;
 
         while (!(bspnum & NF_SUBSECTOR))
         {
@@ -661,9 +759,15 @@ void R_RenderBSPNode(int bspnum)
             bspstack[sp] = bspnum;
             sidestack[sp++] = side;
             bspnum = bsp->children[side];
+            bspnodesvisited++;
+
+            // [BH] skip the near side if nothing in it is in the PVS
+            if ((culled = R_CullNode(bspnum)))
+                break;
         }
 
-        R_Subsector(bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR));
+        if (!culled)
+            R_Subsector(bspnum == -1 ? 0 : (bspnum & ~NF_SUBSECTOR));
 
         if (!sp)
             return;
@@ -671,7 +775,7 @@ void R_RenderBSPNode(int bspnum)
         side = sidestack[--sp] ^ 1;
         bsp = nodes + bspstack[sp];
 
-        while (!R_CheckBBox(bsp->bbox[side]))
+        while (R_CullNode(bsp->children[side]) || !R_CheckBBox(bsp->bbox[side]))
         {
             if (!sp)
                 return;
@@ -46,11 +46,16 @@ extern byte         *solidcol;
 
 extern drawseg_t    *ds_p;
 
+extern uint64_t     bspnodesvisited;
+extern uint64_t     bspnodesculled;
+extern uint64_t     bspsubsectorsvisited;
+
 // BSP?
 void R_InitClipSegs(void);
 void R_ClearClipSegs(void);
 void R_ClearDrawSegs(void);
 
+void R_SetupPVS(void);
 void R_RenderBSPNode(int bspnum);
 
 // killough 04/13/98: fake floors/ceilings for deep water/fake ceilings:
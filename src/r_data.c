@@ -33,12 +33,16 @@
 ==============================================================================
 */
 
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+
 #include "c_console.h"
 #include "d_deh.h"
 #include "doomstat.h"
 #include "i_colors.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "m_array.h"
 #include "m_config.h"
 #include "m_misc.h"
 #include "p_local.h"
@@ -1311,7 +1315,7 @@ static void R_InitColormaps(void)
     else
         colormaps = I_Malloc(sizeof(*colormaps));
 
-    dc_colormap[1] = dc_nextcolormap[1] = colormaps[0] = W_CacheLumpName("COLORMAP");
+    dc_colormap[1] = dc_nextcolormap[1] = colormaps[0] = W_CacheWritableLumpName("COLORMAP");
 
     if (numcolormaps == 1)
         C_Output("The " BOLD("COLORMAP") " lump in the %s " BOLD("%s") " is being used.",
@@ -1487,15 +1491,114 @@ int R_TextureNumForName(const char *name)
     return i;
 }
 
+//
+// Background precaching
+//
+typedef struct
+{
+    int         flatnum;
+    const byte  *raw;
+} precacheflat_t;
+
+typedef struct
+{
+    const byte  *data;
+    int         size;
+} precachelump_t;
+
+bool                    precachingflatpatches;
+
+static SDL_Thread       *precachethread;
+static SDL_sem          *precachesem;
+static SDL_atomic_t     precachequit;
+static precacheflat_t   *precacheflats;
+static precachelump_t   *precachelumps;
+
+static int SDLCALL R_PrecacheThread(void *data)
+{
+    volatile byte   touched = 0;
+
+    // Build the flats used as wall textures first, since the main thread
+    // may be waiting on them as soon as the level is drawn.
+    for (int i = 0; i < array_size(precacheflats); i++)
+        R_BuildFlatAsPatch(precacheflats[i].flatnum, precacheflats[i].raw);
+
+    SDL_SemPost(precachesem);
+
+    // Then touch every page of the mapped lumps the level uses, so they're
+    // read from disk now rather than while the level is being played.
+    for (int i = 0; i < array_size(precachelumps) && !SDL_AtomicGet(&precachequit); i++)
+        for (int j = 0; j < precachelumps[i].size; j += 4096)
+            touched ^= precachelumps[i].data[j];
+
+    return 0;
+}
+
+//
+// R_WaitForPrecache
+// Blocks until all flats used as wall textures have been built.
+//
+void R_WaitForPrecache(void)
+{
+    SDL_SemWait(precachesem);
+    precachingflatpatches = false;
+}
+
+//
+// R_StopPrecache
+// Stops the background precaching started by R_PrecacheLevel(). Must be
+// called before the lumps it uses are freed or unmapped.
+//
+void R_StopPrecache(void)
+{
+    if (precachethread)
+    {
+        SDL_AtomicSet(&precachequit, 1);
+        SDL_WaitThread(precachethread, NULL);
+        precachethread = NULL;
+    }
+
+    if (precachesem)
+    {
+        SDL_DestroySemaphore(precachesem);
+        precachesem = NULL;
+    }
+
+    precachingflatpatches = false;
+    array_free(precacheflats);
+    array_free(precachelumps);
+}
+
+static void R_PrecacheLump(const int lumpnum)
+{
+    const lumpinfo_t    *lump = lumpinfo[lumpnum];
+    const byte          *data = W_CacheLumpNum(lumpnum);
+
+    // only lumps used directly from a WAD's mapping still need to be read
+    if (data && data == W_MappedData(lump->wadfile, lump->position, lump->size))
+    {
+        const precachelump_t    precachelump = { data, lump->size };
+
+        array_push(precachelumps, precachelump);
+    }
+}
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
 //
 // Totally rewritten by Lee Killough to use less memory,
 // to avoid using alloca(), and to improve performance.
+//
+// [BH] Sprites and textures are already built by R_InitPatches(), and sound
+// effects by S_Init(). What remains is finished on a separate thread while
+// the screen wipes, and the main thread only waits for it if it needs a flat
+// used as a wall texture before it has been built.
 void R_PrecacheLevel(void)
 {
-    bool    *hitlist = calloc(MAX(MAX(numsectors, numflats), MAX(numsides, numtextures)), sizeof(bool));
+    bool    *hitlist = calloc(MAX(numsectors, numflats), sizeof(bool));
+
+    R_StopPrecache();
 
     if (!hitlist)
         return;
@@ -1512,34 +1615,51 @@ void R_PrecacheLevel(void)
 
     for (int i = 0; i < numflats; i++)
         if (hitlist[i])
-            W_CacheLumpNum(firstflat + i);
+            R_PrecacheLump(firstflat + i);
 
-    // Precache textures.
-    memset(hitlist, false, sizeof(*hitlist));
+    // Precache flats used as wall textures.
+    memset(hitlist, false, (unsigned int)numflats * sizeof(*hitlist));
 
     for (int i = 0; i < numsides; i++)
     {
-        hitlist[sides[i].toptexture] = true;
-        hitlist[sides[i].midtexture] = true;
-        hitlist[sides[i].bottomtexture] = true;
+        if (sides[i].topflat > -1)
+            hitlist[sides[i].topflat] = true;
+
+        if (sides[i].midflat > -1)
+            hitlist[sides[i].midflat] = true;
+
+        if (sides[i].bottomflat > -1)
+            hitlist[sides[i].bottomflat] = true;
     }
 
-    // Sky texture is always present.
-    // Note that F_SKY1 is the name used to
-    //  indicate a sky floor/ceiling as a flat,
-    //  while the sky texture is stored like
-    //  a wall texture, with an episode dependent
-    //  name.
-    hitlist[skytexture] = true;
+    for (int i = 0; i < numflats; i++)
+    {
+        const byte  *raw;
 
-    for (int i = 0; i < numtextures; i++)
-        if (hitlist[i])
+        if (hitlist[i] && (raw = R_AllocFlatAsPatch(i)))
         {
-            texture_t   *texture = textures[i];
+            const precacheflat_t    precacheflat = { i, raw };
 
-            for (int j = 0; j < texture->patchcount; j++)
-                W_CacheLumpNum(texture->patches[j].patch);
+            array_push(precacheflats, precacheflat);
         }
+    }
 
     free(hitlist);
+
+    if (!array_size(precacheflats) && !array_size(precachelumps))
+        return;
+
+    SDL_AtomicSet(&precachequit, 0);
+
+    if ((precachesem = SDL_CreateSemaphore(0))
+        && (precachethread = SDL_CreateThread(&R_PrecacheThread, "R_PrecacheThread", NULL)))
+        precachingflatpatches = true;
+    else
+    {
+        // couldn't create the thread, so build the flats now instead
+        for (int i = 0; i < array_size(precacheflats); i++)
+            R_BuildFlatAsPatch(precacheflats[i].flatnum, precacheflats[i].raw);
+
+        R_StopPrecache();
+    }
 }
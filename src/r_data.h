@@ -124,6 +124,8 @@ byte *R_GetTextureColumn(const rpatch_t *texpatch, int col);
 // I/O, setting up the stuff.
 void R_InitData(void);
 void R_PrecacheLevel(void);
+void R_WaitForPrecache(void);
+void R_StopPrecache(void);
 
 // Retrieval.
 // Floor/ceiling opaque texture tiles, lookup by name. For animation?
@@ -144,6 +146,7 @@ extern texture_t    **textures;
 extern bool         anybossdeath;
 extern bool         fixspriteoffsets;
 extern bool         incompatiblepalette;
+extern bool         precachingflatpatches;
 extern bool         suppresswarnings;
 extern int          numflats;
 extern int          numspritelumps;
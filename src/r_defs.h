@@ -46,7 +46,7 @@
 #define SIL_BOTH    3
 
 #define MAXDRAWSEGS 1280
-#define MAXOPENINGS MAXSCREENAREA
+#define MAXOPENINGS (MAXWIDTH * 64)
 
 //
 // INTERNAL MAP TYPES
@@ -33,7 +33,21 @@
 ==============================================================================
 */
 
+#include "SDL_cpuinfo.h"
+#include "SDL_thread.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2
+#define SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#include "c_console.h"
 #include "i_colors.h"
+#include "m_array.h"
 #include "m_config.h"
 #include "p_local.h"
 #include "r_main.h"
@@ -67,28 +81,28 @@ static byte     *ylookup1[MAXHEIGHT];
 
 static byte     flipindex[256];
 
-lighttable_t    *dc_colormap[2];
-lighttable_t    *dc_nextcolormap[2];
-lighttable_t    *dc_sectorcolormap;
-int             dc_x;
-int             dc_yl;
-int             dc_yh;
-int             dc_z;
-fixed_t         dc_iscale;
-fixed_t         dc_texturemid;
-fixed_t         dc_texheight;
-fixed_t         dc_texturefrac;
-byte            dc_solidbloodcolor;
-byte            *dc_bloodcolor;
-byte            *dc_brightmap;
-int             dc_floorclip;
-int             dc_ceilingclip;
-int             dc_numposts;
-byte            dc_black;
-byte            *dc_black33;
-byte            *dc_black40;
-byte            *dc_source;
-byte            *dc_translation;
+THREADLOCAL lighttable_t    *dc_colormap[2];
+THREADLOCAL lighttable_t    *dc_nextcolormap[2];
+THREADLOCAL lighttable_t    *dc_sectorcolormap;
+THREADLOCAL int             dc_x;
+THREADLOCAL int             dc_yl;
+THREADLOCAL int             dc_yh;
+THREADLOCAL int             dc_z;
+THREADLOCAL fixed_t         dc_iscale;
+THREADLOCAL fixed_t         dc_texturemid;
+THREADLOCAL fixed_t         dc_texheight;
+THREADLOCAL fixed_t         dc_texturefrac;
+THREADLOCAL byte            dc_solidbloodcolor;
+THREADLOCAL byte            *dc_bloodcolor;
+THREADLOCAL byte            *dc_brightmap;
+THREADLOCAL int             dc_floorclip;
+THREADLOCAL int             dc_ceilingclip;
+THREADLOCAL int             dc_numposts;
+THREADLOCAL byte            dc_black;
+THREADLOCAL byte            *dc_black33;
+THREADLOCAL byte            *dc_black40;
+THREADLOCAL byte            *dc_source;
+THREADLOCAL byte            *dc_translation;
 
 int             ditherxoffset;
 
@@ -1450,30 +1464,30 @@ void R_InitTranslationTables(void)
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
 //
-int             ds_x1;
-int             ds_x2;
-int             ds_y;
-int             ds_z;
-
-lighttable_t    *ds_colormap[2];
-lighttable_t    **ds_zlight;
-lighttable_t    *ds_sectorcolormap;
-
-fixed_t         ds_xfrac;
-fixed_t         ds_yfrac;
-fixed_t         ds_xstep;
-fixed_t         ds_ystep;
-float           ds_radiallightdistance;
-float           ds_radiallightdistancestep;
-float           ds_radiallightstep;
-float           ds_radiallightstepstep;
+THREADLOCAL int             ds_x1;
+THREADLOCAL int             ds_x2;
+THREADLOCAL int             ds_y;
+THREADLOCAL int             ds_z;
+
+THREADLOCAL lighttable_t    *ds_colormap[2];
+THREADLOCAL lighttable_t    **ds_zlight;
+THREADLOCAL lighttable_t    *ds_sectorcolormap;
+
+THREADLOCAL fixed_t         ds_xfrac;
+THREADLOCAL fixed_t         ds_yfrac;
+THREADLOCAL fixed_t         ds_xstep;
+THREADLOCAL fixed_t         ds_ystep;
+THREADLOCAL float           ds_radiallightdistance;
+THREADLOCAL float           ds_radiallightdistancestep;
+THREADLOCAL float           ds_radiallightstep;
+THREADLOCAL float           ds_radiallightstepstep;
 
 // start of flat tile image
-byte            *ds_source;
-byte            *ds_brightmap;
+THREADLOCAL byte            *ds_source;
+THREADLOCAL byte            *ds_brightmap;
 
-int             ds_flatwidth;
-int             ds_flatheight;
+THREADLOCAL int             ds_flatwidth;
+THREADLOCAL int             ds_flatheight;
 
 static inline int R_FlatIndex(const fixed_t xfrac, const fixed_t yfrac)
 {
@@ -2492,6 +2506,824 @@ void R_DrawDitheredRadialSolidColorSpan(void)
         [NOTEXTURECOLOR]];
 }
 
+//
+// SIMD span drawing
+// The 64x64 span drawers spend much of their time stepping ds_xfrac and ds_yfrac and
+//  computing the texel index of each pixel. The SIMD versions below compute all of the
+//  indices of a span up front, several at a time, using whichever instruction set is
+//  available at runtime, and then look up the colormaps as before. Everything else is the
+//  same as the scalar drawers, which remain the fallback, so the output is identical.
+//
+static THREADLOCAL int  flatindices[MAXWIDTH + 8];
+
+static void (*R_GetFlatIndices64)(const int count);
+
+#if defined(SIMD_SSE2)
+static void R_GetFlatIndices64SSE2(const int count)
+{
+    const unsigned int  xfrac = ds_xfrac;
+    const unsigned int  yfrac = ds_yfrac;
+    const unsigned int  xstep = ds_xstep;
+    const unsigned int  ystep = ds_ystep;
+    __m128i             x = _mm_setr_epi32(xfrac, xfrac + xstep, xfrac + 2 * xstep, xfrac + 3 * xstep);
+    __m128i             y = _mm_setr_epi32(yfrac, yfrac + ystep, yfrac + 2 * ystep, yfrac + 3 * ystep);
+    const __m128i       xstep4 = _mm_set1_epi32(4 * xstep);
+    const __m128i       ystep4 = _mm_set1_epi32(4 * ystep);
+    const __m128i       xmask = _mm_set1_epi32(63);
+    const __m128i       ymask = _mm_set1_epi32(63 << 6);
+
+    for (int i = 0; i < count; i += 4)
+    {
+        const __m128i   u = _mm_and_si128(_mm_srli_epi32(x, FRACBITS), xmask);
+        const __m128i   v = _mm_and_si128(_mm_srli_epi32(y, FRACBITS - 6), ymask);
+
+        _mm_storeu_si128((__m128i *)&flatindices[i], _mm_or_si128(u, v));
+        x = _mm_add_epi32(x, xstep4);
+        y = _mm_add_epi32(y, ystep4);
+    }
+}
+#endif
+
+#if defined(SIMD_AVX2)
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+#endif
+static void R_GetFlatIndices64AVX2(const int count)
+{
+    const unsigned int  xfrac = ds_xfrac;
+    const unsigned int  yfrac = ds_yfrac;
+    const unsigned int  xstep = ds_xstep;
+    const unsigned int  ystep = ds_ystep;
+    const __m256i       steps = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i             x = _mm256_add_epi32(_mm256_set1_epi32(xfrac),
+                            _mm256_mullo_epi32(steps, _mm256_set1_epi32(xstep)));
+    __m256i             y = _mm256_add_epi32(_mm256_set1_epi32(yfrac),
+                            _mm256_mullo_epi32(steps, _mm256_set1_epi32(ystep)));
+    const __m256i       xstep8 = _mm256_set1_epi32(8 * xstep);
+    const __m256i       ystep8 = _mm256_set1_epi32(8 * ystep);
+    const __m256i       xmask = _mm256_set1_epi32(63);
+    const __m256i       ymask = _mm256_set1_epi32(63 << 6);
+
+    for (int i = 0; i < count; i += 8)
+    {
+        const __m256i   u = _mm256_and_si256(_mm256_srli_epi32(x, FRACBITS), xmask);
+        const __m256i   v = _mm256_and_si256(_mm256_srli_epi32(y, FRACBITS - 6), ymask);
+
+        _mm256_storeu_si256((__m256i *)&flatindices[i], _mm256_or_si256(u, v));
+        x = _mm256_add_epi32(x, xstep8);
+        y = _mm256_add_epi32(y, ystep8);
+    }
+}
+#endif
+
+#if defined(SIMD_NEON)
+static void R_GetFlatIndices64NEON(const int count)
+{
+    const uint32_t      xfrac = ds_xfrac;
+    const uint32_t      yfrac = ds_yfrac;
+    const uint32_t      xstep = ds_xstep;
+    const uint32_t      ystep = ds_ystep;
+    const uint32_t      xinit[4] = { xfrac, xfrac + xstep, xfrac + 2 * xstep, xfrac + 3 * xstep };
+    const uint32_t      yinit[4] = { yfrac, yfrac + ystep, yfrac + 2 * ystep, yfrac + 3 * ystep };
+    uint32x4_t          x = vld1q_u32(xinit);
+    uint32x4_t          y = vld1q_u32(yinit);
+    const uint32x4_t    xstep4 = vdupq_n_u32(4 * xstep);
+    const uint32x4_t    ystep4 = vdupq_n_u32(4 * ystep);
+    const uint32x4_t    xmask = vdupq_n_u32(63);
+    const uint32x4_t    ymask = vdupq_n_u32(63 << 6);
+
+    for (int i = 0; i < count; i += 4)
+    {
+        const uint32x4_t    u = vandq_u32(vshrq_n_u32(x, FRACBITS), xmask);
+        const uint32x4_t    v = vandq_u32(vshrq_n_u32(y, FRACBITS - 6), ymask);
+
+        vst1q_u32((uint32_t *)&flatindices[i], vorrq_u32(u, v));
+        x = vaddq_u32(x, xstep4);
+        y = vaddq_u32(y, ystep4);
+    }
+}
+#endif
+
+static void R_DrawSIMDSpan64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    const lighttable_t  *colormap = ds_colormap[0];
+    const int           *index = flatindices;
+
+    R_GetFlatIndices64(count);
+
+    while (--count)
+        *dest++ = ds_sectorcolormap[colormap[ds_source[*index++]]];
+
+    *dest = ds_sectorcolormap[colormap[ds_source[*index]]];
+}
+
+static void R_DrawSIMDRadialSpan64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    const int           *index = flatindices;
+    int                 radialpixelcount = 4;
+    int                 lightindex;
+    const lighttable_t  *colormap;
+
+    R_GetFlatIndices64(count);
+    R_InitRadialLightDistance();
+
+    lightindex = ds_z;
+    colormap = ds_zlight[lightindex];
+
+    while (--count)
+    {
+        *dest++ = ds_sectorcolormap[colormap[ds_source[*index++]]];
+
+        if (!--radialpixelcount)
+        {
+            R_StepRadialLightDistance(4.0f);
+            R_UpdateRadialLightColormap(&colormap, &lightindex);
+
+            radialpixelcount = 4;
+        }
+    }
+
+    *dest = ds_sectorcolormap[colormap[ds_source[*index]]];
+}
+
+static void R_DrawSIMDSpanWithBrightmap64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    const lighttable_t  *colormap[2] = { ds_colormap[0], fullcolormap };
+    const int           *index = flatindices;
+    byte                dot;
+
+    R_GetFlatIndices64(count);
+
+    while (--count)
+    {
+        dot = ds_source[*index++];
+        *dest++ = ds_sectorcolormap[colormap[ds_brightmap[dot]][dot]];
+    }
+
+    dot = ds_source[*index];
+    *dest = ds_sectorcolormap[colormap[ds_brightmap[dot]][dot]];
+}
+
+static void R_DrawSIMDRadialSpanWithBrightmap64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    const int           *index = flatindices;
+    byte                dot;
+    int                 radialpixelcount = 4;
+    int                 lightindex;
+    const lighttable_t  *colormap;
+
+    R_GetFlatIndices64(count);
+    R_InitRadialLightDistance();
+
+    lightindex = ds_z;
+    colormap = ds_zlight[lightindex];
+
+    while (--count)
+    {
+        dot = ds_source[*index++];
+        *dest++ = ds_sectorcolormap[(ds_brightmap[dot] ? fullcolormap : colormap)[dot]];
+
+        if (!--radialpixelcount)
+        {
+            R_StepRadialLightDistance(4.0f);
+            R_UpdateRadialLightColormap(&colormap, &lightindex);
+
+            radialpixelcount = 4;
+        }
+    }
+
+    dot = ds_source[*index];
+    *dest = ds_sectorcolormap[(ds_brightmap[dot] ? fullcolormap : colormap)[dot]];
+}
+
+static void R_DrawSIMDDitheredSpan64(void)
+{
+    int         count = ds_x2 - ds_x1;
+    byte        *dest = ylookup0[ds_y] + ds_x1;
+    const byte  *dither = ditherspan[ds_y & DITHERMASK][ds_z];
+    int         xphase = (ds_x1 + ditherxoffset) & DITHERMASK;
+    const int   *index = flatindices;
+
+    R_GetFlatIndices64(count);
+
+    while (--count)
+    {
+        *dest++ = ds_sectorcolormap[ds_colormap[dither[xphase]][ds_source[*index++]]];
+        xphase = (xphase + 1) & DITHERMASK;
+    }
+
+    *dest = ds_sectorcolormap[ds_colormap[dither[xphase]][ds_source[*index]]];
+}
+
+static void R_DrawSIMDDitheredRadialSpan64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    const int           yphase = ds_y & DITHERMASK;
+    int                 xphase = (ds_x1 + ditherxoffset) & DITHERMASK;
+    const int           *index = flatindices;
+    int                 lightindex;
+    const lighttable_t  *colormap;
+    const lighttable_t  *nextcolormap;
+    const byte          *dither;
+    int                 radialpixelcount = 4;
+
+    R_GetFlatIndices64(count);
+    R_InitRadialLightDistance();
+
+    lightindex = ds_z;
+    colormap = ds_zlight[lightindex];
+    nextcolormap = ds_zlight[MIN(lightindex + 1, MAXLIGHTZ - 1)];
+    dither = ditherspan[yphase][R_GetRadialLightDitherLevel()];
+
+    while (--count)
+    {
+        *dest++ = ds_sectorcolormap[(dither[xphase] ? nextcolormap : colormap)[ds_source[*index++]]];
+
+        if (!--radialpixelcount)
+        {
+            R_StepRadialLightDistance(4.0f);
+            R_UpdateRadialDitheredLightColormaps(&colormap, &nextcolormap, &lightindex);
+
+            dither = ditherspan[yphase][R_GetRadialLightDitherLevel()];
+            radialpixelcount = 4;
+        }
+
+        xphase = (xphase + 1) & DITHERMASK;
+    }
+
+    *dest = ds_sectorcolormap[(dither[xphase] ? nextcolormap : colormap)[ds_source[*index]]];
+}
+
+static void R_DrawSIMDDitheredSpanWithBrightmap64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    byte                dot;
+    const byte          *dither = ditherspan[ds_y & DITHERMASK][ds_z];
+    int                 xphase = (ds_x1 + ditherxoffset) & DITHERMASK;
+    const int           *index = flatindices;
+    const lighttable_t  *colormap[2][2] = { { ds_colormap[0], ds_colormap[1] },
+                                            { fullcolormap,   fullcolormap   } };
+
+    R_GetFlatIndices64(count);
+
+    while (--count)
+    {
+        dot = ds_source[*index++];
+        *dest++ = ds_sectorcolormap[colormap[ds_brightmap[dot]][dither[xphase]][dot]];
+        xphase = (xphase + 1) & DITHERMASK;
+    }
+
+    dot = ds_source[*index];
+    *dest = ds_sectorcolormap[colormap[ds_brightmap[dot]][dither[xphase]][dot]];
+}
+
+static void R_DrawSIMDDitheredRadialSpanWithBrightmap64(void)
+{
+    int                 count = ds_x2 - ds_x1;
+    byte                *dest = ylookup0[ds_y] + ds_x1;
+    byte                dot;
+    const int           yphase = ds_y & DITHERMASK;
+    int                 xphase = (ds_x1 + ditherxoffset) & DITHERMASK;
+    const int           *index = flatindices;
+    int                 lightindex;
+    const lighttable_t  *colormap;
+    const lighttable_t  *nextcolormap;
+    const byte          *dither;
+    int                 radialpixelcount = 4;
+
+    R_GetFlatIndices64(count);
+    R_InitRadialLightDistance();
+
+    lightindex = ds_z;
+    colormap = ds_zlight[lightindex];
+    nextcolormap = ds_zlight[MIN(lightindex + 1, MAXLIGHTZ - 1)];
+    dither = ditherspan[yphase][R_GetRadialLightDitherLevel()];
+
+    while (--count)
+    {
+        dot = ds_source[*index++];
+        *dest++ = ds_sectorcolormap[(ds_brightmap[dot] ? fullcolormap :
+            (dither[xphase] ? nextcolormap : colormap))[dot]];
+
+        if (!--radialpixelcount)
+        {
+            R_StepRadialLightDistance(4.0f);
+            R_UpdateRadialDitheredLightColormaps(&colormap, &nextcolormap, &lightindex);
+
+            dither = ditherspan[yphase][R_GetRadialLightDitherLevel()];
+            radialpixelcount = 4;
+        }
+
+        xphase = (xphase + 1) & DITHERMASK;
+    }
+
+    dot = ds_source[*index];
+    *dest = ds_sectorcolormap[(ds_brightmap[dot] ? fullcolormap :
+        (dither[xphase] ? nextcolormap : colormap))[dot]];
+}
+
+#if defined(_DEBUG)
+//
+// R_CheckSIMDSpan
+// In debug builds, each span drawn by a SIMD span drawer is also drawn by the scalar span
+//  drawer it replaces, and an error is shown if any of its pixels are different.
+//
+static void R_CheckSIMDSpan(void (*simdfunc)(void));
+
+static void R_CheckSIMDSpan64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDSpan64);
+}
+
+static void R_CheckSIMDRadialSpan64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDRadialSpan64);
+}
+
+static void R_CheckSIMDSpanWithBrightmap64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDSpanWithBrightmap64);
+}
+
+static void R_CheckSIMDRadialSpanWithBrightmap64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDRadialSpanWithBrightmap64);
+}
+
+static void R_CheckSIMDDitheredSpan64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDDitheredSpan64);
+}
+
+static void R_CheckSIMDDitheredRadialSpan64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDDitheredRadialSpan64);
+}
+
+static void R_CheckSIMDDitheredSpanWithBrightmap64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDDitheredSpanWithBrightmap64);
+}
+
+static void R_CheckSIMDDitheredRadialSpanWithBrightmap64(void)
+{
+    R_CheckSIMDSpan(&R_DrawSIMDDitheredRadialSpanWithBrightmap64);
+}
+#endif
+
+static const struct
+{
+    void    (*func)(void);
+    void    (*simdfunc)(void);
+#if defined(_DEBUG)
+    void    (*checkfunc)(void);
+#endif
+} simdspanfuncs[] =
+{
+#if defined(_DEBUG)
+    { &R_DrawSpan64,                              &R_DrawSIMDSpan64,                              &R_CheckSIMDSpan64                              },
+    { &R_DrawRadialSpan64,                        &R_DrawSIMDRadialSpan64,                        &R_CheckSIMDRadialSpan64                        },
+    { &R_DrawSpanWithBrightmap64,                 &R_DrawSIMDSpanWithBrightmap64,                 &R_CheckSIMDSpanWithBrightmap64                 },
+    { &R_DrawRadialSpanWithBrightmap64,           &R_DrawSIMDRadialSpanWithBrightmap64,           &R_CheckSIMDRadialSpanWithBrightmap64           },
+    { &R_DrawDitheredSpan64,                      &R_DrawSIMDDitheredSpan64,                      &R_CheckSIMDDitheredSpan64                      },
+    { &R_DrawDitheredRadialSpan64,                &R_DrawSIMDDitheredRadialSpan64,                &R_CheckSIMDDitheredRadialSpan64                },
+    { &R_DrawDitheredSpanWithBrightmap64,         &R_DrawSIMDDitheredSpanWithBrightmap64,         &R_CheckSIMDDitheredSpanWithBrightmap64         },
+    { &R_DrawDitheredRadialSpanWithBrightmap64,   &R_DrawSIMDDitheredRadialSpanWithBrightmap64,   &R_CheckSIMDDitheredRadialSpanWithBrightmap64   }
+#else
+    { &R_DrawSpan64,                              &R_DrawSIMDSpan64                              },
+    { &R_DrawRadialSpan64,                        &R_DrawSIMDRadialSpan64                        },
+    { &R_DrawSpanWithBrightmap64,                 &R_DrawSIMDSpanWithBrightmap64                 },
+    { &R_DrawRadialSpanWithBrightmap64,           &R_DrawSIMDRadialSpanWithBrightmap64           },
+    { &R_DrawDitheredSpan64,                      &R_DrawSIMDDitheredSpan64                      },
+    { &R_DrawDitheredRadialSpan64,                &R_DrawSIMDDitheredRadialSpan64                },
+    { &R_DrawDitheredSpanWithBrightmap64,         &R_DrawSIMDDitheredSpanWithBrightmap64         },
+    { &R_DrawDitheredRadialSpanWithBrightmap64,   &R_DrawSIMDDitheredRadialSpanWithBrightmap64   }
+#endif
+};
+
+#if defined(_DEBUG)
+static void R_CheckSIMDSpan(void (*simdfunc)(void))
+{
+    const int       count = ds_x2 - ds_x1;
+    byte            *dest = ylookup0[ds_y] + ds_x1;
+    const fixed_t   xfrac = ds_xfrac;
+    const fixed_t   yfrac = ds_yfrac;
+    byte            expected[MAXWIDTH];
+    void            (*func)(void) = NULL;
+
+    for (int i = 0; i < (int)arrlen(simdspanfuncs); i++)
+        if (simdfunc == simdspanfuncs[i].simdfunc)
+        {
+            func = simdspanfuncs[i].func;
+            break;
+        }
+
+    func();
+    memcpy(expected, dest, count);
+
+    // make sure every pixel is drawn again
+    for (int i = 0; i < count; i++)
+        dest[i] = ~expected[i];
+
+    ds_xfrac = xfrac;
+    ds_yfrac = yfrac;
+    simdfunc();
+
+    if (memcmp(dest, expected, count))
+        I_Error("R_CheckSIMDSpan: A span drawn at (%i, %i) by a SIMD span drawer is different.", ds_x1, ds_y);
+}
+#endif
+
+static void R_GetSIMDSpanFunction(void (**func)(void))
+{
+    for (int i = 0; i < (int)arrlen(simdspanfuncs); i++)
+        if (*func == simdspanfuncs[i].func)
+        {
+#if defined(_DEBUG)
+            *func = simdspanfuncs[i].checkfunc;
+#else
+            *func = simdspanfuncs[i].simdfunc;
+#endif
+            break;
+        }
+}
+
+//
+// R_InitSIMDSpanFunctions
+// Called at the end of R_InitColumnFunctions() to replace the 64x64 span drawers it has
+//  chosen with their SIMD versions if the CPU supports them.
+//
+void R_InitSIMDSpanFunctions(void)
+{
+    static bool initialized;
+
+    if (!initialized)
+    {
+#if defined(SIMD_AVX2)
+        if (SDL_HasAVX2())
+            R_GetFlatIndices64 = &R_GetFlatIndices64AVX2;
+        else
+#endif
+#if defined(SIMD_SSE2)
+        if (SDL_HasSSE2())
+            R_GetFlatIndices64 = &R_GetFlatIndices64SSE2;
+#elif defined(SIMD_NEON)
+        if (SDL_HasNEON())
+            R_GetFlatIndices64 = &R_GetFlatIndices64NEON;
+#endif
+
+        initialized = true;
+    }
+
+    if (!R_GetFlatIndices64)
+        return;
+
+    R_GetSIMDSpanFunction(&spanfunc64);
+    R_GetSIMDSpanFunction(&bmapspanfunc64);
+    R_GetSIMDSpanFunction(&altspanfunc64);
+    R_GetSIMDSpanFunction(&altbmapspanfunc64);
+}
+
+//
+// Multithreaded drawing
+// When r_threads is greater than 1, the columns and spans of the walls, floors, ceilings
+//  and skies are queued as the BSP is traversed rather than drawn immediately. The queue
+//  is then drawn in parallel, with the view split into vertical strips. Apart from columns
+//  at the same x, which always end up in the same strip and are drawn in the same order,
+//  no pixel is drawn more than once, so the result is identical to drawing serially.
+//
+typedef struct
+{
+    lighttable_t    *colormap[2];
+    lighttable_t    *nextcolormap[2];
+    lighttable_t    *sectorcolormap;
+    int             x;
+    int             yl;
+    int             yh;
+    int             z;
+    fixed_t         iscale;
+    fixed_t         texturemid;
+    fixed_t         texheight;
+    fixed_t         texturefrac;
+    byte            solidbloodcolor;
+    byte            *bloodcolor;
+    byte            *brightmap;
+    int             floorclip;
+    int             ceilingclip;
+    int             numposts;
+    byte            black;
+    byte            *black33;
+    byte            *black40;
+    byte            *source;
+    byte            *translation;
+} drawcolumn_t;
+
+typedef struct
+{
+    int             x1;
+    int             x2;
+    int             y;
+    int             z;
+    lighttable_t    *colormap[2];
+    lighttable_t    **zlight;
+    lighttable_t    *sectorcolormap;
+    fixed_t         xfrac;
+    fixed_t         yfrac;
+    fixed_t         xstep;
+    fixed_t         ystep;
+    float           radiallightdistance;
+    float           radiallightdistancestep;
+    float           radiallightstep;
+    float           radiallightstepstep;
+    byte            *source;
+    byte            *brightmap;
+    int             flatwidth;
+    int             flatheight;
+} drawspan_t;
+
+typedef struct
+{
+    void            (*func)(void);
+    int             strip;
+    bool            isspan;
+
+    union
+    {
+        drawcolumn_t    column;
+        drawspan_t      span;
+    } data;
+} drawcommand_t;
+
+typedef struct
+{
+    SDL_Thread      *thread;
+    SDL_sem         *start;
+    SDL_sem         *done;
+    int             strip;
+    bool            quit;
+} drawthread_t;
+
+bool                    drawqueue;
+
+static drawcommand_t    *drawcommands;
+static drawthread_t     drawthreads[r_threads_max];
+static int              numdrawthreads = 1;
+
+static void R_SaveColumn(drawcolumn_t *column)
+{
+    column->colormap[0] = dc_colormap[0];
+    column->colormap[1] = dc_colormap[1];
+    column->nextcolormap[0] = dc_nextcolormap[0];
+    column->nextcolormap[1] = dc_nextcolormap[1];
+    column->sectorcolormap = dc_sectorcolormap;
+    column->x = dc_x;
+    column->yl = dc_yl;
+    column->yh = dc_yh;
+    column->z = dc_z;
+    column->iscale = dc_iscale;
+    column->texturemid = dc_texturemid;
+    column->texheight = dc_texheight;
+    column->texturefrac = dc_texturefrac;
+    column->solidbloodcolor = dc_solidbloodcolor;
+    column->bloodcolor = dc_bloodcolor;
+    column->brightmap = dc_brightmap;
+    column->floorclip = dc_floorclip;
+    column->ceilingclip = dc_ceilingclip;
+    column->numposts = dc_numposts;
+    column->black = dc_black;
+    column->black33 = dc_black33;
+    column->black40 = dc_black40;
+    column->source = dc_source;
+    column->translation = dc_translation;
+}
+
+static void R_RestoreColumn(const drawcolumn_t *column)
+{
+    dc_colormap[0] = column->colormap[0];
+    dc_colormap[1] = column->colormap[1];
+    dc_nextcolormap[0] = column->nextcolormap[0];
+    dc_nextcolormap[1] = column->nextcolormap[1];
+    dc_sectorcolormap = column->sectorcolormap;
+    dc_x = column->x;
+    dc_yl = column->yl;
+    dc_yh = column->yh;
+    dc_z = column->z;
+    dc_iscale = column->iscale;
+    dc_texturemid = column->texturemid;
+    dc_texheight = column->texheight;
+    dc_texturefrac = column->texturefrac;
+    dc_solidbloodcolor = column->solidbloodcolor;
+    dc_bloodcolor = column->bloodcolor;
+    dc_brightmap = column->brightmap;
+    dc_floorclip = column->floorclip;
+    dc_ceilingclip = column->ceilingclip;
+    dc_numposts = column->numposts;
+    dc_black = column->black;
+    dc_black33 = column->black33;
+    dc_black40 = column->black40;
+    dc_source = column->source;
+    dc_translation = column->translation;
+}
+
+static void R_SaveSpan(drawspan_t *span)
+{
+    span->x1 = ds_x1;
+    span->x2 = ds_x2;
+    span->y = ds_y;
+    span->z = ds_z;
+    span->colormap[0] = ds_colormap[0];
+    span->colormap[1] = ds_colormap[1];
+    span->zlight = ds_zlight;
+    span->sectorcolormap = ds_sectorcolormap;
+    span->xfrac = ds_xfrac;
+    span->yfrac = ds_yfrac;
+    span->xstep = ds_xstep;
+    span->ystep = ds_ystep;
+    span->radiallightdistance = ds_radiallightdistance;
+    span->radiallightdistancestep = ds_radiallightdistancestep;
+    span->radiallightstep = ds_radiallightstep;
+    span->radiallightstepstep = ds_radiallightstepstep;
+    span->source = ds_source;
+    span->brightmap = ds_brightmap;
+    span->flatwidth = ds_flatwidth;
+    span->flatheight = ds_flatheight;
+}
+
+static void R_RestoreSpan(const drawspan_t *span)
+{
+    ds_x1 = span->x1;
+    ds_x2 = span->x2;
+    ds_y = span->y;
+    ds_z = span->z;
+    ds_colormap[0] = span->colormap[0];
+    ds_colormap[1] = span->colormap[1];
+    ds_zlight = span->zlight;
+    ds_sectorcolormap = span->sectorcolormap;
+    ds_xfrac = span->xfrac;
+    ds_yfrac = span->yfrac;
+    ds_xstep = span->xstep;
+    ds_ystep = span->ystep;
+    ds_radiallightdistance = span->radiallightdistance;
+    ds_radiallightdistancestep = span->radiallightdistancestep;
+    ds_radiallightstep = span->radiallightstep;
+    ds_radiallightstepstep = span->radiallightstepstep;
+    ds_source = span->source;
+    ds_brightmap = span->brightmap;
+    ds_flatwidth = span->flatwidth;
+    ds_flatheight = span->flatheight;
+}
+
+void R_QueueColumn(void (*func)(void))
+{
+    drawcommand_t   command;
+
+    command.func = func;
+    command.strip = dc_x * numdrawthreads / viewwidth;
+    command.isspan = false;
+    R_SaveColumn(&command.data.column);
+    array_push(drawcommands, command);
+}
+
+void R_QueueSpan(void (*func)(void))
+{
+    drawcommand_t   command;
+
+    // [BH] a span is drawn in full by the strip its midpoint is in
+    command.func = func;
+    command.strip = (ds_x1 + ds_x2) / 2 * numdrawthreads / viewwidth;
+    command.isspan = true;
+    R_SaveSpan(&command.data.span);
+    array_push(drawcommands, command);
+}
+
+static void R_DrawQueue(const int strip)
+{
+    const int   count = array_size(drawcommands);
+
+    for (int i = 0; i < count; i++)
+    {
+        const drawcommand_t *command = &drawcommands[i];
+
+        if (command->strip != strip)
+            continue;
+
+        if (command->isspan)
+            R_RestoreSpan(&command->data.span);
+        else
+            R_RestoreColumn(&command->data.column);
+
+        command->func();
+    }
+}
+
+static int SDLCALL R_DrawThread(void *data)
+{
+    drawthread_t    *thread = data;
+
+    while (true)
+    {
+        SDL_SemWait(thread->start);
+
+        if (thread->quit)
+            break;
+
+        R_DrawQueue(thread->strip);
+        SDL_SemPost(thread->done);
+    }
+
+    return 0;
+}
+
+void R_StartDrawQueue(void)
+{
+    drawqueue = (numdrawthreads > 1);
+}
+
+void R_FlushDrawQueue(void)
+{
+    drawcolumn_t    column;
+    drawspan_t      span;
+
+    if (!drawqueue)
+        return;
+
+    drawqueue = false;
+
+    // the main thread draws the first strip itself, so keep its state
+    R_SaveColumn(&column);
+    R_SaveSpan(&span);
+
+    for (int i = 1; i < numdrawthreads; i++)
+        SDL_SemPost(drawthreads[i].start);
+
+    R_DrawQueue(0);
+
+    for (int i = 1; i < numdrawthreads; i++)
+        SDL_SemWait(drawthreads[i].done);
+
+    R_RestoreColumn(&column);
+    R_RestoreSpan(&span);
+    array_clear(drawcommands);
+}
+
+void R_ShutdownDrawThreads(void)
+{
+    for (int i = 1; i < numdrawthreads; i++)
+    {
+        drawthread_t    *thread = &drawthreads[i];
+
+        thread->quit = true;
+        SDL_SemPost(thread->start);
+        SDL_WaitThread(thread->thread, NULL);
+        SDL_DestroySemaphore(thread->start);
+        SDL_DestroySemaphore(thread->done);
+    }
+
+    numdrawthreads = 1;
+}
+
+void R_InitDrawThreads(void)
+{
+    const int   threads = BETWEEN(r_threads_min, r_threads, r_threads_max);
+
+    R_ShutdownDrawThreads();
+
+    for (int i = 1; i < threads; i++)
+    {
+        drawthread_t    *thread = &drawthreads[i];
+
+        thread->strip = i;
+        thread->quit = false;
+        thread->start = SDL_CreateSemaphore(0);
+        thread->done = SDL_CreateSemaphore(0);
+
+        if (!thread->start || !thread->done
+            || !(thread->thread = SDL_CreateThread(&R_DrawThread, "R_DrawThread", thread)))
+        {
+            if (thread->start)
+                SDL_DestroySemaphore(thread->start);
+
+            if (thread->done)
+                SDL_DestroySemaphore(thread->done);
+
+            C_Warning(1, "Only %i of the %i threads used to render the view could be created.", i, threads);
+            break;
+        }
+
+        numdrawthreads++;
+    }
+}
+
 //
 // R_InitBuffer
 //
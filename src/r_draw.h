@@ -45,29 +45,29 @@
 
 #define NOTEXTURECOLOR          nearestcolors[LIGHTGRAY1]
 
-extern lighttable_t     *dc_colormap[2];
-extern lighttable_t     *dc_nextcolormap[2];
-extern lighttable_t     *dc_sectorcolormap;
-extern int              dc_x;
-extern int              dc_yl;
-extern int              dc_yh;
-extern int              dc_z;
-extern fixed_t          dc_iscale;
-extern fixed_t          dc_texturemid;
-extern fixed_t          dc_texheight;
-extern fixed_t          dc_texturefrac;
-extern byte             dc_solidbloodcolor;
-extern byte             *dc_bloodcolor;
-extern byte             *dc_brightmap;
-extern int              dc_floorclip;
-extern int              dc_ceilingclip;
-extern int              dc_numposts;
-extern byte             dc_black;
-extern byte             *dc_black33;
-extern byte             *dc_black40;
+extern THREADLOCAL lighttable_t     *dc_colormap[2];
+extern THREADLOCAL lighttable_t     *dc_nextcolormap[2];
+extern THREADLOCAL lighttable_t     *dc_sectorcolormap;
+extern THREADLOCAL int              dc_x;
+extern THREADLOCAL int              dc_yl;
+extern THREADLOCAL int              dc_yh;
+extern THREADLOCAL int              dc_z;
+extern THREADLOCAL fixed_t          dc_iscale;
+extern THREADLOCAL fixed_t          dc_texturemid;
+extern THREADLOCAL fixed_t          dc_texheight;
+extern THREADLOCAL fixed_t          dc_texturefrac;
+extern THREADLOCAL byte             dc_solidbloodcolor;
+extern THREADLOCAL byte             *dc_bloodcolor;
+extern THREADLOCAL byte             *dc_brightmap;
+extern THREADLOCAL int              dc_floorclip;
+extern THREADLOCAL int              dc_ceilingclip;
+extern THREADLOCAL int              dc_numposts;
+extern THREADLOCAL byte             dc_black;
+extern THREADLOCAL byte             *dc_black33;
+extern THREADLOCAL byte             *dc_black40;
 
 // first pixel in a column
-extern byte             *dc_source;
+extern THREADLOCAL byte             *dc_source;
 
 extern int              fuzz1pos;
 extern int              fuzz2pos;
@@ -142,33 +142,33 @@ void R_DrawDitheredTranslatedColumn(void);
 
 void R_VideoErase(unsigned int offset, int count);
 
-extern int          ds_x1;
-extern int          ds_x2;
-extern int          ds_y;
-extern int          ds_z;
-
-extern lighttable_t *ds_colormap[2];
-extern lighttable_t **ds_zlight;
-extern lighttable_t *ds_sectorcolormap;
-extern byte         *ds_brightmap;
-
-extern fixed_t      ds_xfrac;
-extern fixed_t      ds_yfrac;
-extern fixed_t      ds_xstep;
-extern fixed_t      ds_ystep;
-extern float        ds_radiallightdistance;
-extern float        ds_radiallightdistancestep;
-extern float        ds_radiallightstep;
-extern float        ds_radiallightstepstep;
+extern THREADLOCAL int          ds_x1;
+extern THREADLOCAL int          ds_x2;
+extern THREADLOCAL int          ds_y;
+extern THREADLOCAL int          ds_z;
+
+extern THREADLOCAL lighttable_t *ds_colormap[2];
+extern THREADLOCAL lighttable_t **ds_zlight;
+extern THREADLOCAL lighttable_t *ds_sectorcolormap;
+extern THREADLOCAL byte         *ds_brightmap;
+
+extern THREADLOCAL fixed_t      ds_xfrac;
+extern THREADLOCAL fixed_t      ds_yfrac;
+extern THREADLOCAL fixed_t      ds_xstep;
+extern THREADLOCAL fixed_t      ds_ystep;
+extern THREADLOCAL float        ds_radiallightdistance;
+extern THREADLOCAL float        ds_radiallightdistancestep;
+extern THREADLOCAL float        ds_radiallightstep;
+extern THREADLOCAL float        ds_radiallightstepstep;
 
 // start of flat tile image
-extern byte         *ds_source;
+extern THREADLOCAL byte         *ds_source;
 
-extern int          ds_flatwidth;
-extern int          ds_flatheight;
+extern THREADLOCAL int          ds_flatwidth;
+extern THREADLOCAL int          ds_flatheight;
 
 extern byte         translationtables[256 * 3];
-extern byte         *dc_translation;
+extern THREADLOCAL byte         *dc_translation;
 
 extern int          ditherxoffset;
 
@@ -202,6 +202,20 @@ void R_DrawLowResDitheredRadialSolidColorSpan(void);
 void R_DrawDitheredSolidColorSpan(void);
 void R_DrawDitheredRadialSolidColorSpan(void);
 
+void R_InitSIMDSpanFunctions(void);
+
+extern bool         drawqueue;
+
+#define DRAWCOLUMN(func)    (drawqueue ? R_QueueColumn(func) : func())
+#define DRAWSPAN(func)      (drawqueue ? R_QueueSpan(func) : func())
+
+void R_QueueColumn(void (*func)(void));
+void R_QueueSpan(void (*func)(void));
+void R_StartDrawQueue(void);
+void R_FlushDrawQueue(void);
+void R_InitDrawThreads(void);
+void R_ShutdownDrawThreads(void);
+
 void R_InitBuffer(void);
 
 // Initialize color translation tables,
@@ -937,6 +937,8 @@ void R_InitColumnFunctions(void)
         altspanfunc64 = &R_DrawSolidColorSpan;
     }
 
+    R_InitSIMDSpanFunctions();
+
     for (mobjtype_t i = 0; i < nummobjtypes; i++)
     {
         mobjinfo_t  *info = &mobjinfo[i];
@@ -1094,6 +1096,7 @@ void R_Init(void)
     R_InitSwirlingFlats();
     R_InitColumnFunctions();
     R_InitViewSwirl();
+    R_InitDrawThreads();
 }
 
 //
@@ -1181,9 +1184,10 @@ static void R_SetupFrame(void)
         {
             const fixed_t   amount = FRACUNIT * (fixed_t)(shake - time) / shakeduration;
 
-            viewx += M_RandomInt(-3, 3) * amount;
-            viewy += M_RandomInt(-3, 3) * amount;
-            viewz += M_RandomInt(-2, 2) * amount;
+            // [BH] use a different seed to the game's so demos play back the same
+            viewx += M_Fuzz1RandomInt(-3, 3) * amount;
+            viewy += M_Fuzz1RandomInt(-3, 3) * amount;
+            viewz += M_Fuzz1RandomInt(-2, 2) * amount;
         }
     }
 
@@ -1328,6 +1332,93 @@ static void R_SwirlView(const int swirltic)
     }
 }
 
+//
+// R_GrowPool
+// [BH] Returns how big a pool that's filled while rendering a frame needs to be
+//  for the next frame to use half as much again as the last one without it
+//  having to grow mid-frame.
+//
+unsigned int R_GrowPool(unsigned int size, const unsigned int used)
+{
+    while (size < used + used / 2)
+        size *= 2;
+
+    return size;
+}
+
+//
+// Frame profiler
+//
+profileframe_t  profileframes[PROFILEFRAMES];
+int             numprofileframes;
+int             profileframeindex;
+
+const char *profilestagenames[NUMPROFILESTAGES] =
+{
+    "Setup", "BSP", "Planes", "Masked", "HUD", "Blit", "Present"
+};
+
+const char *profilecounternames[NUMPROFILECOUNTERS] =
+{
+    "Visplanes", "Drawsegs", "Drawseg tests", "Vissprites", "Openings", "Subsectors", "Thinkers"
+};
+
+static profileframe_t   profileframe;
+static uint64_t         profiletime;
+static uint64_t         profilesubsectors;
+
+void R_ClearProfile(void)
+{
+    numprofileframes = 0;
+    profileframeindex = 0;
+}
+
+void R_StartProfileFrame(void)
+{
+    if (!vid_showprofile)
+        return;
+
+    memset(&profileframe, 0, sizeof(profileframe));
+    profilesubsectors = bspsubsectorsvisited;
+    profiletime = I_GetTimeUS();
+}
+
+// [BH] adds the time since the last call to the given stage, so a stage may be timed in more than one part
+void R_ProfileStage(const profilestage_t stage)
+{
+    uint64_t    now;
+
+    if (!vid_showprofile)
+        return;
+
+    now = I_GetTimeUS();
+    profileframe.stages[stage] += (int)(now - profiletime);
+    profiletime = now;
+}
+
+void R_EndProfileFrame(void)
+{
+    if (!vid_showprofile)
+        return;
+
+    if (gamestate == GS_LEVEL)
+    {
+        profileframe.counters[PROFILE_VISPLANES] = numvisplanes;
+        profileframe.counters[PROFILE_DRAWSEGS] = (int)(ds_p - drawsegs);
+        profileframe.counters[PROFILE_DRAWSEGTESTS] = drawsegtests;
+        profileframe.counters[PROFILE_VISSPRITES] = num_vissprite;
+        profileframe.counters[PROFILE_OPENINGS] = R_OpeningsUsed();
+        profileframe.counters[PROFILE_SUBSECTORS] = (int)(bspsubsectorsvisited - profilesubsectors);
+        profileframe.counters[PROFILE_THINKERS] = thinkersrun;
+    }
+
+    profileframes[profileframeindex] = profileframe;
+    profileframeindex = (profileframeindex + 1) % PROFILEFRAMES;
+
+    if (numprofileframes < PROFILEFRAMES)
+        numprofileframes++;
+}
+
 //
 // R_RenderPlayerView
 //
@@ -1340,10 +1431,12 @@ void R_RenderPlayerView(void)
     R_ClearDrawSegs();
     R_ClearPlanes();
     R_ClearSprites();
+    R_SetupPVS();
 
     if (automapactive)
     {
         R_RenderBSPNode(numnodes - 1);
+        R_ProfileStage(PROFILE_BSP);
         return;
     }
 
@@ -1354,12 +1447,21 @@ void R_RenderPlayerView(void)
         V_FillRect(0, viewwindowx, viewwindowy, viewwidth, viewheight,
             nearestblack, 0, false, false, NULL, NULL);
 
+    R_StartDrawQueue();
+
     R_RenderBSPNode(numnodes - 1);  // head node is the last node output
 
     R_DrawNearbySprites();
 
+    R_ProfileStage(PROFILE_BSP);
+
     R_DrawPlanes();
 
+    // [BH] walls queued for the draw threads are drawn here too
+    R_FlushDrawQueue();
+
+    R_ProfileStage(PROFILE_PLANES);
+
     R_DrawMasked();
 
     if (!(viewplayer->cheats & CF_FREEZE) || viewswirltic == -1)
@@ -1378,4 +1480,6 @@ void R_RenderPlayerView(void)
 
     if (!r_textures && viewplayer->fixedcolormap == INVERSECOLORMAP)
         V_InvertScreen();
+
+    R_ProfileStage(PROFILE_MASKED);
 }
@@ -164,3 +164,51 @@ void R_ExecuteSetViewSize(void);
 
 void R_InitColumnFunctions(void);
 void R_UpdateMobjColfunc(mobj_t *mobj);
+
+unsigned int R_GrowPool(unsigned int size, const unsigned int used);
+
+//
+// Frame profiler.
+//
+typedef enum
+{
+    PROFILE_SETUP,
+    PROFILE_BSP,
+    PROFILE_PLANES,
+    PROFILE_MASKED,
+    PROFILE_HUD,
+    PROFILE_BLIT,
+    PROFILE_PRESENT,
+    NUMPROFILESTAGES
+} profilestage_t;
+
+typedef enum
+{
+    PROFILE_VISPLANES,
+    PROFILE_DRAWSEGS,
+    PROFILE_DRAWSEGTESTS,
+    PROFILE_VISSPRITES,
+    PROFILE_OPENINGS,
+    PROFILE_SUBSECTORS,
+    PROFILE_THINKERS,
+    NUMPROFILECOUNTERS
+} profilecounter_t;
+
+#define PROFILEFRAMES   128
+
+typedef struct
+{
+    int stages[NUMPROFILESTAGES];       // in microseconds
+    int counters[NUMPROFILECOUNTERS];
+} profileframe_t;
+
+extern profileframe_t   profileframes[PROFILEFRAMES];
+extern int              numprofileframes;
+extern int              profileframeindex;
+extern const char       *profilestagenames[NUMPROFILESTAGES];
+extern const char       *profilecounternames[NUMPROFILECOUNTERS];
+
+void R_ClearProfile(void);
+void R_StartProfileFrame(void);
+void R_ProfileStage(const profilestage_t stage);
+void R_EndProfileFrame(void);
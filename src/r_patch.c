@@ -756,49 +756,43 @@ void R_InitPatches(void)
         CreateTextureCompositePatch(i);
 }
 
-const rpatch_t *R_CacheFlatAsPatch(const int flatnum)
+//
+// R_AllocFlatAsPatch
+// Allocates the patch used when a flat is drawn as a wall texture, and
+// returns the flat's pixels to be passed to R_BuildFlatAsPatch(), or NULL
+// if the patch has already been allocated. Must be called on the main thread.
+//
+const byte *R_AllocFlatAsPatch(const int flatnum)
 {
     rpatch_t    *patch = &flatpatches[flatnum];
+    const int   lumpnum = firstflat + flatnum;
+    lumpinfo_t  *lump = lumpinfo[lumpnum];
+    const int   lumpsize = lump->size;
+    const byte  *raw;
+    int         width;
+    int         height;
+    int         pixeldatasize;
+    int         columnsdatasize;
+    int         postsdatasize;
+    int         datasize;
+    short       mask;
 
     if (patch->data)
-        return patch;
-    else
-    {
-        const int   lumpnum = firstflat + flatnum;
-        lumpinfo_t  *lump = lumpinfo[lumpnum];
-        const int   lumpsize = lump->size;
-        const byte  *raw;
-        int         width;
-        int         height;
-        int         pixeldatasize;
-        int         columnsdatasize;
-        int         postsdatasize;
-        int         datasize;
-        short       mask;
-
-        W_CacheLumpNum(lumpnum);
-        raw = lump->cache;
-
-        if (lumpsize > 4)
-        {
-            const int   w = (raw[0] | (raw[1] << 8));
-            const int   h = (raw[2] | (raw[3] << 8));
+        return NULL;
 
-            if (w > 0 && h > 0 && w * h + 4 == lumpsize)
-            {
-                width = w;
-                height = h;
-                raw += 4;
-            }
-            else
-            {
-                int side = 1;
+    W_CacheLumpNum(lumpnum);
+    raw = lump->cache;
 
-                while (side * side < lumpsize)
-                    side++;
+    if (lumpsize > 4)
+    {
+        const int   w = (raw[0] | (raw[1] << 8));
+        const int   h = (raw[2] | (raw[3] << 8));
 
-                width = height = side;
-            }
+        if (w > 0 && h > 0 && w * h + 4 == lumpsize)
+        {
+            width = w;
+            height = h;
+            raw += 4;
         }
         else
         {
@@ -809,44 +803,79 @@ const rpatch_t *R_CacheFlatAsPatch(const int flatnum)
 
             width = height = side;
         }
+    }
+    else
+    {
+        int side = 1;
 
-        pixeldatasize = width * height;
-        columnsdatasize = width * sizeof(rcolumn_t);
-        postsdatasize = width * sizeof(rpost_t);
-        datasize = pixeldatasize + columnsdatasize + postsdatasize;
+        while (side * side < lumpsize)
+            side++;
 
-        patch->width = width;
-        patch->height = height;
-        patch->leftoffset = 0;
-        patch->topoffset = 0;
+        width = height = side;
+    }
 
-        for (mask = 1; mask * 2 <= width; mask *= 2);
+    pixeldatasize = width * height;
+    columnsdatasize = width * sizeof(rcolumn_t);
+    postsdatasize = width * sizeof(rpost_t);
+    datasize = pixeldatasize + columnsdatasize + postsdatasize;
 
-        patch->widthmask = mask - 1;
+    patch->width = width;
+    patch->height = height;
+    patch->leftoffset = 0;
+    patch->topoffset = 0;
 
-        patch->data = Z_Calloc(1, datasize, PU_STATIC, (void **)&patch->data);
-        patch->pixels = patch->data;
-        patch->columns = (rcolumn_t *)((byte *)patch->pixels + pixeldatasize);
-        patch->posts = (rpost_t *)((byte *)patch->columns + columnsdatasize);
+    for (mask = 1; mask * 2 <= width; mask *= 2);
 
-        for (int x = 0; x < width; x++)
-        {
-            byte        *col = &patch->pixels[x * height];
-            rcolumn_t   *column = &patch->columns[x];
-            rpost_t     *post = &patch->posts[x];
-
-            for (int y = 0; y < height; y++)
-                col[y] = raw[y * width + x];
-
-            column->pixels = col;
-            column->numposts = 1;
-            column->posts = post;
-            post->topdelta = 0;
-            post->length = height;
-        }
+    patch->widthmask = mask - 1;
+
+    patch->data = Z_Calloc(1, datasize, PU_STATIC, (void **)&patch->data);
+    patch->pixels = patch->data;
+    patch->columns = (rcolumn_t *)((byte *)patch->pixels + pixeldatasize);
+    patch->posts = (rpost_t *)((byte *)patch->columns + columnsdatasize);
+
+    return raw;
+}
+
+//
+// R_BuildFlatAsPatch
+// Copies a flat's pixels into the columns of the patch allocated for it by
+// R_AllocFlatAsPatch(). Doesn't touch the zone, so may be called on any thread.
+//
+void R_BuildFlatAsPatch(const int flatnum, const byte *raw)
+{
+    rpatch_t    *patch = &flatpatches[flatnum];
+    const int   width = patch->width;
+    const int   height = patch->height;
+
+    for (int x = 0; x < width; x++)
+    {
+        byte        *col = &patch->pixels[x * height];
+        rcolumn_t   *column = &patch->columns[x];
+        rpost_t     *post = &patch->posts[x];
+
+        for (int y = 0; y < height; y++)
+            col[y] = raw[y * width + x];
+
+        column->pixels = col;
+        column->numposts = 1;
+        column->posts = post;
+        post->topdelta = 0;
+        post->length = height;
     }
+}
+
+const rpatch_t *R_CacheFlatAsPatch(const int flatnum)
+{
+    const byte  *raw;
+
+    // [BH] wait for any patches still being built by R_PrecacheLevel()
+    if (precachingflatpatches)
+        R_WaitForPrecache();
+
+    if ((raw = R_AllocFlatAsPatch(flatnum)))
+        R_BuildFlatAsPatch(flatnum, raw);
 
-    return patch;
+    return &flatpatches[flatnum];
 }
 
 const rpatch_t *R_CachePatchNum(const int id)
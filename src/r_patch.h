@@ -70,6 +70,8 @@ typedef struct
 const rpatch_t *R_CachePatchNum(const int id);
 const rpatch_t *R_CacheTextureCompositePatchNum(const int id);
 const rpatch_t *R_CacheFlatAsPatch(const int flatnum);
+const byte *R_AllocFlatAsPatch(const int flatnum);
+void R_BuildFlatAsPatch(const int flatnum, const byte *raw);
 const rcolumn_t *R_GetPatchColumnWrapped(const rpatch_t *patch, int columnindex);
 void R_InitPatches(void);
 bool R_CheckIfPatch(const int lump);
@@ -36,6 +36,7 @@
 #include "c_cmds.h"
 #include "c_console.h"
 #include "doomstat.h"
+#include "m_array.h"
 #include "m_config.h"
 #include "m_menu.h"
 #include "r_sky.h"
@@ -44,6 +45,7 @@
 #include "z_zone.h"
 
 #define MAXVISPLANES    1024                    // must be a power of 2
+#define MINVISPLANES    32
 
 // killough -- hash function for visplanes
 // Empirically verified to be fairly uniform:
@@ -51,6 +53,8 @@
     ((unsigned int)((picnum) * 3 + (lightlevel) + (height) * 7 + (colormap) * 11) & (MAXVISPLANES - 1))
 
 static visplane_t   *visplanes[MAXVISPLANES];   // killough
+int                 numvisplanes;
+static unsigned int numvisplanesallocated;
 static visplane_t   *freetail;                  // killough
 static visplane_t   **freehead = &freetail;     // killough
 visplane_t          *floorplane;
@@ -58,8 +62,13 @@ visplane_t          *ceilingplane;
 
 fixed_t             planenum;
 
-int                 openings[MAXOPENINGS];
+int                 *openings;
 int                 *lastopening;               // dropoff overflow
+int                 *openingsend;
+static unsigned int maxopenings;
+static int          *openingsstart;
+static int          **overflowopenings;
+static unsigned int overflowopeningsused;
 
 // Clip values are the solid pixel bounding the range.
 //  floorclip starts out SCREENHEIGHT
@@ -178,9 +187,9 @@ static void R_MapPlane(const int y, const int x1)
         ds_colormap[0] = ds_colormap[1] = fixedcolormap;
 
         if (ds_flatwidth == 64 && ds_flatheight == 64)
-            altspanfunc64();
+            DRAWSPAN(altspanfunc64);
         else
-            altspanfunc();
+            DRAWSPAN(altspanfunc);
     }
     else
     {
@@ -193,16 +202,16 @@ static void R_MapPlane(const int y, const int x1)
                 if (ds_flatwidth == 64 && ds_flatheight == 64)
                 {
                     if (ds_brightmap)
-                        bmapspanfunc64();
+                        DRAWSPAN(bmapspanfunc64);
                     else
-                        spanfunc64();
+                        DRAWSPAN(spanfunc64);
                 }
                 else
                 {
                     if (ds_brightmap)
-                        bmapspanfunc();
+                        DRAWSPAN(bmapspanfunc);
                     else
-                        spanfunc();
+                        DRAWSPAN(spanfunc);
                 }
 
                 return;
@@ -215,16 +224,16 @@ static void R_MapPlane(const int y, const int x1)
                 if (ds_flatwidth == 64 && ds_flatheight == 64)
                 {
                     if (ds_brightmap)
-                        altbmapspanfunc64();
+                        DRAWSPAN(altbmapspanfunc64);
                     else
-                        altspanfunc64();
+                        DRAWSPAN(altspanfunc64);
                 }
                 else
                 {
                     if (ds_brightmap)
-                        altbmapspanfunc();
+                        DRAWSPAN(altbmapspanfunc);
                     else
-                        altspanfunc();
+                        DRAWSPAN(altspanfunc);
                 }
             }
             else
@@ -234,39 +243,61 @@ static void R_MapPlane(const int y, const int x1)
                 if (ds_flatwidth == 64 && ds_flatheight == 64)
                 {
                     if (ds_brightmap)
-                        bmapspanfunc64();
+                        DRAWSPAN(bmapspanfunc64);
                     else
-                        spanfunc64();
+                        DRAWSPAN(spanfunc64);
                 }
                 else
                 {
                     if (ds_brightmap)
-                        bmapspanfunc();
+                        DRAWSPAN(bmapspanfunc);
                     else
-                        spanfunc();
+                        DRAWSPAN(spanfunc);
                 }
             }
         }
         else if (ds_flatwidth == 64 && ds_flatheight == 64)
         {
             if (ds_brightmap)
-                bmapspanfunc64();
+                DRAWSPAN(bmapspanfunc64);
             else
-                spanfunc64();
+                DRAWSPAN(spanfunc64);
         }
         else if (ds_brightmap)
-            bmapspanfunc();
+            DRAWSPAN(bmapspanfunc);
         else
-            spanfunc();
+            DRAWSPAN(spanfunc);
     }
 }
 
+//
+// R_NewOpenings
+// [BH] Called when the openings run out mid-frame. Rather than reallocating them, which would
+//  move the openings drawsegs already point to, more are allocated separately until the next frame.
+//
+void R_NewOpenings(const size_t needed)
+{
+    const size_t    size = (needed > maxopenings / 2 ? needed : maxopenings / 2);
+
+    overflowopeningsused += (unsigned int)(lastopening - openingsstart);
+    openingsstart = lastopening = I_Malloc(size * sizeof(*openings));
+    openingsend = lastopening + size;
+    array_push(overflowopenings, openingsstart);
+}
+
+unsigned int R_OpeningsUsed(void)
+{
+    return (overflowopeningsused + (unsigned int)(lastopening - openingsstart));
+}
+
 //
 // R_ClearPlanes
 // At beginning of frame.
 //
 void R_ClearPlanes(void)
 {
+    unsigned int    size;
+
     // opening/clipping determination
     for (int i = 0; i < viewwidth; i++)
     {
@@ -286,7 +317,41 @@ void R_ClearPlanes(void)
                 freehead = &(*freehead)->next;
         }
 
-    lastopening = openings;
+    // [BH] allocate any more visplanes needed in one block, from how many the last frame used
+    if ((size = R_GrowPool(MAX(numvisplanesallocated, MINVISPLANES), numvisplanes)) > numvisplanesallocated)
+    {
+        const unsigned int  count = size - numvisplanesallocated;
+        visplane_t          *block = calloc(count, sizeof(*block));
+
+        if (block)
+        {
+            for (unsigned int i = 0; i < count - 1; i++)
+                block[i].next = &block[i + 1];
+
+            *freehead = block;
+            freehead = &block[count - 1].next;
+            numvisplanesallocated = size;
+        }
+    }
+
+    // [BH] size the openings from how many the last frame used
+    size = R_GrowPool(MAX(maxopenings, MAXOPENINGS), R_OpeningsUsed());
+
+    for (int i = 0; i < array_size(overflowopenings); i++)
+        free(overflowopenings[i]);
+
+    array_clear(overflowopenings);
+
+    if (size != maxopenings)
+    {
+        free(openings);
+        openings = I_Malloc((maxopenings = size) * sizeof(*openings));
+    }
+
+    lastopening = openingsstart = openings;
+    openingsend = openings + maxopenings;
+    overflowopeningsused = 0;
+    numvisplanes = 0;
 
     // texture calculation
     memset(cachedheight, 0, viewheight * sizeof(*cachedheight));
@@ -297,8 +362,13 @@ static visplane_t *new_visplane(const unsigned int hash)
 {
     visplane_t  *check = freetail;
 
+    // [BH] visplanes are allocated at the start of each frame, so this only happens
+    //  if a frame needs half as many again as the frame before it
     if (!check)
-        check = calloc(1, sizeof(*check));
+    {
+        if ((check = calloc(1, sizeof(*check))))
+            numvisplanesallocated++;
+    }
     else if (!(freetail = freetail->next))
         freehead = &freetail;
 
@@ -306,6 +376,7 @@ static visplane_t *new_visplane(const unsigned int hash)
     {
         check->next = visplanes[hash];
         visplanes[hash] = check;
+        numvisplanes++;
     }
 
     return check;
@@ -590,6 +661,13 @@ byte *R_SwirlingFlat(const int flatnum)
 
     if (!cache)
     {
+        // draw any queued spans still using the flat that is about to be replaced
+        if (drawqueue)
+        {
+            R_FlushDrawQueue();
+            R_StartDrawQueue();
+        }
+
         cache = &swirlcache[oldestcache];
         cache->flatnum = flatnum;
     }
@@ -645,7 +723,7 @@ static void DrawSkyTexture(visplane_t *pl, skytexture_t *skytexture, void func(v
             dc_source = R_GetTextureColumn(R_CacheTextureCompositePatchNum(texture),
                 FixedMul((angle + xtoskyangle[dc_x]) >> ANGLETOSKYSHIFT, skytexture->scalex));
 
-            func();
+            DRAWCOLUMN(func);
         }
 }
 
@@ -687,7 +765,7 @@ void R_DrawPlanes(void)
 
                                     dc_source = R_GetFireColumn((viewangle + xtoskyangle[dc_x]) >> ANGLETOSKYSHIFT);
 
-                                    skycolfunc();
+                                    DRAWCOLUMN(skycolfunc);
                                 }
                         }
                         else
@@ -703,7 +781,7 @@ void R_DrawPlanes(void)
                         // Sky texture not found, draw white
                         for (dc_x = pl->left; dc_x <= pl->right; dc_x++)
                             if ((dc_yl = pl->top[dc_x]) != USHRT_MAX && dc_yl <= (dc_yh = pl->bottom[dc_x]))
-                                R_DrawSolidColorColumn();
+                                DRAWCOLUMN(R_DrawSolidColorColumn);
                     }
                     else
                     {
@@ -724,7 +802,7 @@ void R_DrawPlanes(void)
                                 dc_source = R_GetTextureColumn(patch, (((viewangle + xtoskyangle[dc_x])
                                     / (1 << (ANGLETOSKYSHIFT - FRACBITS))) + skycolumnoffset) / FRACUNIT);
 
-                                skycolfunc();
+                                DRAWCOLUMN(skycolfunc);
                             }
                     }
                 }
@@ -746,7 +824,7 @@ void R_DrawPlanes(void)
                             dc_source = R_GetTextureColumn(patch, (((viewangle + xtoskyangle[dc_x])
                                 / (1 << (ANGLETOSKYSHIFT - FRACBITS))) + skycolumnoffset) / FRACUNIT);
 
-                            R_DrawWallColumn();
+                            DRAWCOLUMN(R_DrawWallColumn);
                         }
                 }
                 else if (picnum & PL_SKYFLAT)
@@ -766,7 +844,7 @@ void R_DrawPlanes(void)
                     {
                         for (dc_x = pl->left; dc_x <= pl->right; dc_x++)
                             if ((dc_yl = pl->top[dc_x]) != USHRT_MAX && dc_yl <= (dc_yh = pl->bottom[dc_x]))
-                                R_DrawSolidColorColumn();
+                                DRAWCOLUMN(R_DrawSolidColorColumn);
                     }
                     else
                     {
@@ -809,7 +887,7 @@ void R_DrawPlanes(void)
                                     ((((angle + xtoskyangle[dc_x]) ^ flip)
                                         / (1 << (ANGLETOSKYSHIFT - FRACBITS))) + skycolumnoffset) / FRACUNIT);
 
-                                skycolfunc();
+                                DRAWCOLUMN(skycolfunc);
                             }
                     }
                 }
@@ -44,14 +44,18 @@
 
 // Visplane related.
 extern int      *lastopening;
+extern int      *openingsend;
 extern int      floorclip[MAXWIDTH];
 extern int      ceilingclip[MAXWIDTH];
 extern fixed_t  *yslope;
 extern fixed_t  yslopes[PITCHES][MAXHEIGHT];
-extern int      openings[MAXOPENINGS];
+extern int      *openings;
 extern fixed_t  planenum;
+extern int      numvisplanes;
 
 void R_ClearPlanes(void);
+void R_NewOpenings(const size_t needed);
+unsigned int R_OpeningsUsed(void);
 void R_DrawPlanes(void);
 visplane_t *R_FindPlane(fixed_t height, const int picnum, int lightlevel,
     const fixed_t x, const fixed_t y, const int colormap, const angle_t angle);
@@ -497,7 +497,7 @@ static void R_RenderSegLoop(void)
             dc_yh = yh;
 
             if (missingmidtexture)
-                missingcolfunc();
+                DRAWCOLUMN(missingcolfunc);
             else
             {
                 dc_source = R_GetTextureColumn((midflatnum >= 0 ? R_CacheFlatAsPatch(midflatnum) :
@@ -512,22 +512,22 @@ static void R_RenderSegLoop(void)
                     if (r_ditheredlighting)
                     {
                         if (samecolormap)
-                            altbmapwallcolfunc();
+                            DRAWCOLUMN(altbmapwallcolfunc);
                         else
-                            bmapwallcolfunc();
+                            DRAWCOLUMN(bmapwallcolfunc);
                     }
                     else
-                        bmapwallcolfunc();
+                        DRAWCOLUMN(bmapwallcolfunc);
                 }
                 else if (r_ditheredlighting)
                 {
                     if (samecolormap)
-                        altwallcolfunc();
+                        DRAWCOLUMN(altwallcolfunc);
                     else
-                        wallcolfunc();
+                        DRAWCOLUMN(wallcolfunc);
                 }
                 else
-                    wallcolfunc();
+                    DRAWCOLUMN(wallcolfunc);
             }
 
             ceilingclip[rw_x] = viewheight;
@@ -549,7 +549,7 @@ static void R_RenderSegLoop(void)
                     dc_yh = mid;
 
                     if (missingtoptexture)
-                        missingcolfunc();
+                        DRAWCOLUMN(missingcolfunc);
                     else
                     {
                         dc_source = R_GetTextureColumn((topflatnum >= 0 ? R_CacheFlatAsPatch(topflatnum) :
@@ -565,22 +565,22 @@ static void R_RenderSegLoop(void)
                             if (r_ditheredlighting)
                             {
                                 if (samecolormap)
-                                    altbmapwallcolfunc();
+                                    DRAWCOLUMN(altbmapwallcolfunc);
                                 else
-                                    bmapwallcolfunc();
+                                    DRAWCOLUMN(bmapwallcolfunc);
                             }
                             else
-                                bmapwallcolfunc();
+                                DRAWCOLUMN(bmapwallcolfunc);
                         }
                         else if (r_ditheredlighting)
                         {
                             if (samecolormap)
-                                altwallcolfunc();
+                                DRAWCOLUMN(altwallcolfunc);
                             else
-                                wallcolfunc();
+                                DRAWCOLUMN(wallcolfunc);
                         }
                         else
-                            wallcolfunc();
+                            DRAWCOLUMN(wallcolfunc);
                     }
 
                     ceilingclip[rw_x] = mid;
@@ -606,7 +606,7 @@ static void R_RenderSegLoop(void)
                     dc_yh = yh;
 
                     if (missingbottomtexture)
-                        missingcolfunc();
+                        DRAWCOLUMN(missingcolfunc);
                     else
                     {
                         dc_source = R_GetTextureColumn(bottomflatnum >= 0 ? R_CacheFlatAsPatch(bottomflatnum) :
@@ -621,22 +621,22 @@ static void R_RenderSegLoop(void)
                             if (r_ditheredlighting)
                             {
                                 if (samecolormap)
-                                    altbmapwallcolfunc();
+                                    DRAWCOLUMN(altbmapwallcolfunc);
                                 else
-                                    bmapwallcolfunc();
+                                    DRAWCOLUMN(bmapwallcolfunc);
                             }
                             else
-                                bmapwallcolfunc();
+                                DRAWCOLUMN(bmapwallcolfunc);
                         }
                         else if (r_ditheredlighting)
                         {
                             if (samecolormap)
-                                altwallcolfunc();
+                                DRAWCOLUMN(altwallcolfunc);
                             else
-                                wallcolfunc();
+                                DRAWCOLUMN(wallcolfunc);
                         }
                         else
-                            wallcolfunc();
+                            DRAWCOLUMN(wallcolfunc);
                     }
 
                     floorclip[rw_x] = mid;
@@ -745,6 +745,8 @@ void R_StoreWallRange(const int start, const int stop)
     topflatnum = midflatnum = bottomflatnum = -1;
 
     // killough 01/98 -- fix 2s line HOM
+    // [BH] drawsegs are grown at the start of each frame, so this only happens
+    //  if a frame needs half as many again as the frame before it
     if (ds_p == drawsegs + maxdrawsegs)
     {
         const size_t    pos = ds_p - drawsegs;
@@ -772,8 +774,10 @@ void R_StoreWallRange(const int start, const int stop)
     rw_stopx = stop + 1;
     span = (int)((int64_t)rw_stopx - start);
 
-    if ((size_t)span * sizeof(*lastopening) + (size_t)(lastopening - openings) > MAXOPENINGS)
-        return;
+    // [BH] a wall needs an opening for each column of its masked midtexture, top silhouette
+    //  and bottom silhouette
+    if ((size_t)span * 3 > (size_t)(openingsend - lastopening))
+        R_NewOpenings((size_t)span * 3);
 
     worldtop = frontsector->interpceilingheight - viewz;
     worldbottom = frontsector->interpfloorheight - viewz;
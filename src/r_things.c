@@ -54,7 +54,12 @@
 #define BASEYCENTER     (VANILLAHEIGHT / 2)
 
 #define MAXVISSPRITES   256
-#define DS_RANGES_COUNT 3
+
+// [BH] drawsegs are binned by the screen columns they cover, so sprites only
+//  need to be tested against the drawsegs in the bins they overlap
+#define DS_BINSHIFT     5
+#define DS_BINS         ((MAXWIDTH >> DS_BINSHIFT) + 1)
+#define DS_MAXMERGE     8
 
 //
 // Sprite rotation 0 is facing the viewer, rotation 1 is one angle turn CLOCKWISE around the axis.
@@ -73,18 +78,21 @@ typedef struct
     drawseg_t                   *user;
 } drawseg_xrange_item_t;
 
-typedef struct
-{
-    drawseg_xrange_item_t       *items;
-    int                         count;
-} drawsegs_xrange_t;
-
-static drawsegs_xrange_t        drawsegs_xranges[DS_RANGES_COUNT];
+static drawseg_xrange_item_t    *drawsegs_all;          // back to front
+static int                      drawsegs_all_count;
+static drawseg_xrange_item_t    *drawsegs_merged;
+static unsigned int             drawsegs_all_size;
+static drawseg_xrange_item_t    *drawsegs_binned;
+static unsigned int             drawsegs_binned_size;
+static int                      drawsegs_binstart[DS_BINS + 1];
+static int                      drawsegs_binend[DS_BINS];
+static int                      numdrawsegbins;
 
 static drawseg_xrange_item_t    *drawsegs_xrange;
-static unsigned int             drawsegs_xrange_size;
 static int                      drawsegs_xrange_count;
 
+unsigned int                    drawsegtests;
+
 static mobj_t                   **nearby_sprites;
 static fixed_t                  *spritebottomoffset;
 
@@ -118,9 +126,130 @@ static sector_t                 *viewheightsec;
 static int                      viewfixedcolormap;
 static bool                     viewinvulnerabilitycolormap;
 
-static int R_GetDrawSegXRangeIndex(const int x1, const int x2)
+//
+// R_BinDrawSegs
+// Called once a frame before any sprites are drawn.
+//
+static void R_BinDrawSegs(void)
+{
+    int total;
+
+    if (drawsegs_all_size < maxdrawsegs)
+    {
+        drawsegs_all_size = 2 * maxdrawsegs;
+        drawsegs_all = I_Realloc(drawsegs_all, drawsegs_all_size * sizeof(*drawsegs_all));
+        drawsegs_merged = I_Realloc(drawsegs_merged, drawsegs_all_size * sizeof(*drawsegs_merged));
+    }
+
+    numdrawsegbins = ((viewwidth - 1) >> DS_BINSHIFT) + 1;
+    memset(drawsegs_binstart, 0, ((size_t)numdrawsegbins + 1) * sizeof(drawsegs_binstart[0]));
+    drawsegs_all_count = 0;
+
+    // count how many drawsegs cover each bin
+    for (drawseg_t *ds = ds_p; ds-- > drawsegs; )
+        if (ds->silhouette || ds->maskedtexturecol)
+        {
+            drawseg_xrange_item_t   *item = &drawsegs_all[drawsegs_all_count++];
+
+            item->x1 = ds->x1;
+            item->x2 = ds->x2;
+            item->user = ds;
+
+            for (int i = ds->x1 >> DS_BINSHIFT; i <= ds->x2 >> DS_BINSHIFT; i++)
+                drawsegs_binstart[i + 1]++;
+        }
+
+    for (int i = 0; i < numdrawsegbins; i++)
+    {
+        drawsegs_binstart[i + 1] += drawsegs_binstart[i];
+        drawsegs_binend[i] = drawsegs_binstart[i];
+    }
+
+    if ((total = drawsegs_binstart[numdrawsegbins]) > (int)drawsegs_binned_size)
+    {
+        drawsegs_binned_size = 2 * total;
+        drawsegs_binned = I_Realloc(drawsegs_binned, drawsegs_binned_size * sizeof(*drawsegs_binned));
+    }
+
+    // fill the bins, keeping the drawsegs in each bin back to front
+    for (int i = 0; i < drawsegs_all_count; i++)
+    {
+        const drawseg_xrange_item_t *item = &drawsegs_all[i];
+
+        for (int j = item->x1 >> DS_BINSHIFT; j <= item->x2 >> DS_BINSHIFT; j++)
+            drawsegs_binned[drawsegs_binend[j]++] = *item;
+    }
+}
+
+//
+// R_GetDrawSegXRange
+// Points drawsegs_xrange at the drawsegs that may overlap columns x1 to x2.
+//
+static void R_GetDrawSegXRange(const int x1, const int x2)
 {
-    return (x2 < centerx ? 1 : (x1 >= centerx ? 2 : 0));
+    const int   bin1 = MAX(0, x1) >> DS_BINSHIFT;
+    const int   bin2 = MIN(viewwidth - 1, x2) >> DS_BINSHIFT;
+
+    if (bin1 > bin2)
+    {
+        drawsegs_xrange_count = 0;
+        return;
+    }
+    else if (bin1 == bin2)
+    {
+        drawsegs_xrange = &drawsegs_binned[drawsegs_binstart[bin1]];
+        drawsegs_xrange_count = drawsegs_binend[bin1] - drawsegs_binstart[bin1];
+    }
+    else if (bin2 - bin1 < DS_MAXMERGE)
+    {
+        // merge the bins, keeping the drawsegs back to front and
+        // dropping those that are in more than one of them
+        int cursors[DS_MAXMERGE];
+        int count = 0;
+
+        for (int i = bin1; i <= bin2; i++)
+            cursors[i - bin1] = drawsegs_binstart[i];
+
+        while (true)
+        {
+            drawseg_t   *next = NULL;
+            int         index = 0;
+
+            for (int i = bin1; i <= bin2; i++)
+            {
+                const int   cursor = cursors[i - bin1];
+
+                if (cursor < drawsegs_binend[i] && (!next || drawsegs_binned[cursor].user > next))
+                {
+                    next = drawsegs_binned[cursor].user;
+                    index = cursor;
+                }
+            }
+
+            if (!next)
+                break;
+
+            drawsegs_merged[count++] = drawsegs_binned[index];
+
+            for (int i = bin1; i <= bin2; i++)
+            {
+                int *cursor = &cursors[i - bin1];
+
+                if (*cursor < drawsegs_binend[i] && drawsegs_binned[*cursor].user == next)
+                    (*cursor)++;
+            }
+        }
+
+        drawsegs_xrange = drawsegs_merged;
+        drawsegs_xrange_count = count;
+    }
+    else
+    {
+        drawsegs_xrange = drawsegs_all;
+        drawsegs_xrange_count = drawsegs_all_count;
+    }
+
+    drawsegtests += drawsegs_xrange_count;
 }
 
 static int R_CompareNearbySprites(const void *a, const void *b)
@@ -414,7 +543,8 @@ static void R_InitSpriteDefs(void)
 
 static vissprite_t  *vissprites;
 static vissprite_t  **vissprite_ptrs;
-static unsigned int num_vissprite;
+static unsigned int num_vissprite_ptrs;
+unsigned int        num_vissprite;
 static unsigned int num_vissprite_alloc = MAXVISSPRITES;
 
 static vissplat_t   vissplats[r_bloodsplats_max_max];
@@ -442,7 +572,18 @@ void R_InitSprites(void)
 //
 void R_ClearSprites(void)
 {
+    const unsigned int  size = R_GrowPool(num_vissprite_alloc, num_vissprite);
+
+    if (size != num_vissprite_alloc)
+    {
+        num_vissprite_alloc = size;
+        vissprites = I_Realloc(vissprites, num_vissprite_alloc * sizeof(*vissprites));
+        vissprite_ptrs = I_Realloc(vissprite_ptrs,
+            (num_vissprite_ptrs = num_vissprite_alloc * 2) * sizeof(*vissprite_ptrs));
+    }
+
     num_vissprite = 0;
+    drawsegtests = 0;
     r_bloodsplats_visible = 0;
     viewfixedcolormap = viewplayer->fixedcolormap;
     viewinvulnerabilitycolormap = ISINVULNERABILITYCOLORMAP(viewfixedcolormap);
@@ -454,6 +595,8 @@ void R_ClearSprites(void)
 //
 static vissprite_t *R_NewVisSprite(void)
 {
+    // [BH] vissprites are grown at the start of each frame, so this only happens
+    //  if a frame needs half as many again as the frame before it
     if (num_vissprite >= num_vissprite_alloc)
     {
         num_vissprite_alloc = (num_vissprite_alloc ? num_vissprite_alloc * 2 : MAXVISSPRITES);
@@ -2176,8 +2319,6 @@ static void msort(vissprite_t **s, vissprite_t **t, unsigned int n)
 
 static void R_SortVisSprites(void)
 {
-    static unsigned int num_vissprite_ptrs;
-
     if (num_vissprite_ptrs < num_vissprite * 2)
         vissprite_ptrs = I_Realloc(vissprite_ptrs,
             (num_vissprite_ptrs = num_vissprite_alloc * 2) * sizeof(*vissprite_ptrs));
@@ -2336,51 +2477,15 @@ void R_DrawMasked(void)
         return;
     }
 
-    // Prepare drawseg xranges once (used by both splats and sprites).
-    if (drawsegs_xrange_size < maxdrawsegs)
-    {
-        drawsegs_xrange_size = 2 * maxdrawsegs;
-
-        for (int i = 0; i < DS_RANGES_COUNT; i++)
-            drawsegs_xranges[i].items = I_Realloc(drawsegs_xranges[i].items,
-                drawsegs_xrange_size * sizeof(drawsegs_xranges[i].items[0]));
-    }
-
-    for (int i = 0; i < DS_RANGES_COUNT; i++)
-        drawsegs_xranges[i].count = 0;
-
-    for (drawseg_t *ds = ds_p; ds-- > drawsegs; )
-        if (ds->silhouette || ds->maskedtexturecol)
-        {
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count].x1 = ds->x1;
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count].x2 = ds->x2;
-            drawsegs_xranges[0].items[drawsegs_xranges[0].count].user = ds;
-
-            // e6y: ~13% of speed improvement on sunder.wad map10
-            if (ds->x1 < centerx)
-            {
-                drawsegs_xranges[1].items[drawsegs_xranges[1].count] = drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-                drawsegs_xranges[1].count++;
-            }
-
-            if (ds->x2 >= centerx)
-            {
-                drawsegs_xranges[2].items[drawsegs_xranges[2].count] = drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-                drawsegs_xranges[2].count++;
-            }
-
-            drawsegs_xranges[0].count++;
-        }
+    // bin the drawsegs once (used by both splats and sprites)
+    R_BinDrawSegs();
 
     // draw all blood splats
     for (int i = r_bloodsplats_visible - 1; i >= 0; i--)
     {
-        const vissplat_t        *splat = &vissplats[i];
-        const drawsegs_xrange_t *range = &drawsegs_xranges[R_GetDrawSegXRangeIndex(splat->x1, splat->x2)];
-
-        drawsegs_xrange = range->items;
-        drawsegs_xrange_count = range->count;
+        const vissplat_t    *splat = &vissplats[i];
 
+        R_GetDrawSegXRange(splat->x1, splat->x2);
         R_DrawBloodSplatSprite(splat);
     }
 
@@ -2391,12 +2496,9 @@ void R_DrawMasked(void)
         // draw all other vissprites back to front
         for (int i = num_vissprite - 1; i >= 0; i--)
         {
-            const vissprite_t       *spr = vissprite_ptrs[i];
-            const drawsegs_xrange_t *range = &drawsegs_xranges[R_GetDrawSegXRangeIndex(spr->x1, spr->x2)];
-
-            drawsegs_xrange = range->items;
-            drawsegs_xrange_count = range->count;
+            const vissprite_t   *spr = vissprite_ptrs[i];
 
+            R_GetDrawSegXRange(spr->x1, spr->x2);
             R_DrawSprite(spr);
         }
     }
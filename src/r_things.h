@@ -54,6 +54,9 @@ extern int      numbloodsplatlumps;
 
 extern bool     allowwolfensteinss;
 
+extern unsigned int num_vissprite;
+extern unsigned int drawsegtests;
+
 void R_AddSprites(sector_t *sec, int lightlevel);
 void R_InitSpriteBottomOffsets(void);
 void R_InitSprites(void);
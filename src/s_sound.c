@@ -39,6 +39,7 @@
 
 #include "c_console.h"
 #include "doomstat.h"
+#include "i_timer.h"
 #include "m_argv.h"
 #include "m_config.h"
 #include "m_misc.h"
@@ -379,6 +380,40 @@ void S_StopSounds(void)
         S_StopChannel(cnum);
 }
 
+//
+// S_WaitForSounds
+// [BH] Waits up to ms milliseconds for any sounds that are playing to finish,
+//  rather than cutting them off.
+//
+void S_WaitForSounds(const int ms)
+{
+    const uint64_t  endtime = I_GetTimeMS() + ms;
+
+    if (nosfx)
+        return;
+
+    while (I_GetTimeMS() < endtime)
+    {
+        bool    playing = false;
+
+        for (int cnum = 0; cnum < s_channels; cnum++)
+        {
+            const channel_t *c = &channels[cnum];
+
+            if (c->sfxinfo && !c->paused && I_SoundIsPlaying(c->handle))
+            {
+                playing = true;
+                break;
+            }
+        }
+
+        if (!playing)
+            break;
+
+        I_Sleep(1);
+    }
+}
+
 void S_PauseSounds(void)
 {
     if (nosfx)
@@ -91,6 +91,7 @@ void S_Shutdown(void);
 void S_StopSoundEffect(const sfxnum_t sfxnum);
 void S_StopSound(const mobj_t *origin);
 void S_StopSounds(void);
+void S_WaitForSounds(const int ms);
 void S_PauseSounds(void);
 void S_ResumeSounds(void);
 
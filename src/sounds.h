@@ -40,6 +40,14 @@
 // so that the individual game logic and sound driver code agree
 #define NORM_PITCH  127
 
+// [BH] monsters' sounds are randomly pitched up to this much either side of NORM_PITCH
+#define PITCH_RANGE 16
+
+// [BH] random pitches are rounded toward NORM_PITCH to a multiple of this, so
+//  there are fewer pitch-shifted sounds to make and cache
+#define PITCHBUCKETSIZE 2
+#define NUMPITCHBUCKETS (PITCH_RANGE * 2 / PITCHBUCKETSIZE + 1)
+
 //
 // SFX struct.
 //
@@ -68,6 +76,9 @@ typedef struct
 
     // SFX lumpnum
     int             lumpnum;
+
+    // [BH] the sound driver's copy of this sound at each pitch it's been made at
+    void            *pitches[NUMPITCHBUCKETS];
 } sfxinfo_t;
 
 //
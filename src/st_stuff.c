@@ -1531,15 +1531,15 @@ void ST_InitStatBar(void)
     // status bar background bits
     if (english == english_american)
     {
-        sbar = ((FREEDOOM && !modifiedgame) || chex || hacx || harmony || REKKRSA ?
-            W_CacheLastLumpName("STBAR") : (legacyofrust ? W_CacheLumpNameFromResourceWAD("STBAR") : W_CacheLumpName("STBAR")));
-        sbar2 = W_CacheLumpName("STBAR2");
+        sbar = W_CacheWritableLumpNum((FREEDOOM && !modifiedgame) || chex || hacx || harmony || REKKRSA ?
+            W_GetLastNumForName("STBAR") : (legacyofrust ? W_GetNumForNameFromResourceWAD("STBAR") : W_GetNumForName("STBAR")));
+        sbar2 = W_CacheWritableLumpName("STBAR2");
     }
     else
     {
-        sbar = ((FREEDOOM && !modifiedgame) || chex || hacx || harmony || REKKRSA ? W_CacheLastLumpName("STBAR") :
-            (W_GetNumLumps("STBAR") > 2 ? W_CacheLumpName("STBAR") : W_CacheLumpName("STBAR3")));
-        sbar2 = W_CacheLumpName("STBAR4");
+        sbar = W_CacheWritableLumpNum((FREEDOOM && !modifiedgame) || chex || hacx || harmony || REKKRSA ? W_GetLastNumForName("STBAR") :
+            (W_GetNumLumps("STBAR") > 2 ? W_GetNumForName("STBAR") : W_GetNumForName("STBAR3")));
+        sbar2 = W_CacheWritableLumpName("STBAR4");
     }
 
     sbarwidth = LITTLESHORT(sbar->width);
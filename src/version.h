@@ -66,6 +66,8 @@
 #define DOOMRETRO_LICENSEURL            "https://github.com/bradharding/doomretro/wiki/License"
 #define DOOMRETRO_MUTEX                 "DOOMRETRO-CC4F1071-8B24-4E91-A207-D792F39636CD"
 #define DOOMRETRO_NAME                  "DOOM Retro"
+#define DOOMRETRO_NODESFOLDER           "nodes"
+#define DOOMRETRO_PVSFOLDER             "pvs"
 #define DOOMRETRO_RELEASENOTESURL       "https://github.com/bradharding/doomretro/releases/tag/v" \
                                         DOOMRETRO_VERSIONSTRING
 #define DOOMRETRO_RESOURCEWAD           "doomretro.wad"
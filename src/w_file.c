@@ -33,10 +33,78 @@
 ==============================================================================
 */
 
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "m_argv.h"
 #include "m_misc.h"
 #include "w_file.h"
 #include "z_zone.h"
 
+// [BH] Map the entire file into memory so lumps can be used directly from it
+// rather than being read into a copy. The mapping is read-only, so it's backed
+// by the file itself rather than the page file, and only the pages that are used
+// are ever loaded. Lumps that are modified in place are copied out of it by
+// W_CacheWritableLumpNum() instead.
+static void W_MapFile(wadfile_t *wad)
+{
+#if defined(_WIN32)
+    HANDLE          file = (HANDLE)_get_osfhandle(_fileno(wad->fstream));
+    LARGE_INTEGER   size;
+    HANDLE          maphandle;
+
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || !size.QuadPart
+        || (unsigned long long)size.QuadPart > SIZE_MAX)
+        return;
+
+    if (!(maphandle = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL)))
+        return;
+
+    if (!(wad->mapping = MapViewOfFile(maphandle, FILE_MAP_READ, 0, 0, 0)))
+    {
+        CloseHandle(maphandle);
+        return;
+    }
+
+    wad->maphandle = maphandle;
+    wad->length = (size_t)size.QuadPart;
+#else
+    struct stat status;
+    void        *mapping;
+
+    if (fstat(fileno(wad->fstream), &status) || status.st_size <= 0
+        || (unsigned long long)status.st_size > SIZE_MAX)
+        return;
+
+    if ((mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE,
+        fileno(wad->fstream), 0)) == MAP_FAILED)
+        return;
+
+    wad->mapping = mapping;
+    wad->length = (size_t)status.st_size;
+#endif
+}
+
+static void W_UnmapFile(wadfile_t *wad)
+{
+    if (!wad->mapping)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(wad->mapping);
+    CloseHandle(wad->maphandle);
+#else
+    munmap(wad->mapping, wad->length);
+#endif
+
+    wad->mapping = NULL;
+    wad->length = 0;
+}
+
 wadfile_t *W_OpenFile(const char *path)
 {
     wadfile_t   *result;
@@ -46,22 +114,47 @@ wadfile_t *W_OpenFile(const char *path)
         return NULL;
 
     // Create a new wadfile_t to hold the file handle.
-    result = Z_Malloc(sizeof(wadfile_t), PU_STATIC, NULL);
+    result = Z_Calloc(1, sizeof(wadfile_t), PU_STATIC, NULL);
     result->fstream = fstream;
 
+    if (!M_CheckParm("-nommap"))
+        W_MapFile(result);
+
     return result;
 }
 
 void W_CloseFile(wadfile_t *wad)
 {
+    W_UnmapFile(wad);
     fclose(wad->fstream);
     Z_Free(wad);
 }
 
+byte *W_MappedData(wadfile_t *wad, unsigned int offset, size_t length)
+{
+    if (!wad->mapping || offset > wad->length || length > wad->length - offset)
+        return NULL;
+
+    return wad->mapping + offset;
+}
+
 // Read data from the specified position in the file into the
 // provided buffer. Returns the number of bytes read.
 size_t W_Read(wadfile_t *wad, unsigned int offset, void *buffer, size_t buffer_len)
 {
+    if (wad->mapping)
+    {
+        if (offset >= wad->length)
+            return 0;
+
+        if (buffer_len > wad->length - offset)
+            buffer_len = wad->length - offset;
+
+        memcpy(buffer, wad->mapping + offset, buffer_len);
+
+        return buffer_len;
+    }
+
     // Jump to the specified position in the file.
     fseek(wad->fstream, offset, SEEK_SET);
 
@@ -43,6 +43,8 @@
 #include <direct.h>
 #endif
 
+#include "doomtype.h"
+
 #if !defined(MAX_PATH)
 #define MAX_PATH    260
 #endif
@@ -53,6 +55,13 @@ typedef struct
     bool    freedoom;
     char    path[MAX_PATH];
     int     type;
+
+    // [BH] read-only view of the entire file, or NULL if it couldn't be mapped
+    byte    *mapping;
+    size_t  length;
+#if defined(_WIN32)
+    void    *maphandle;
+#endif
 } wadfile_t;
 
 // Open the specified file. Returns a pointer to a new wadfile_t
@@ -62,6 +71,10 @@ wadfile_t *W_OpenFile(const char *path);
 // Close the specified WAD file.
 void W_CloseFile(wadfile_t *wad);
 
+// Returns a pointer to the specified offset into the file's mapping,
+// or NULL if the file isn't mapped or the range lies outside of it.
+byte *W_MappedData(wadfile_t *wad, unsigned int offset, size_t length);
+
 // Read data from the specified file into the provided buffer. The
 // data is read from the specified offset from the start of the file.
 // Returns the number of bytes read.
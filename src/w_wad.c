@@ -890,6 +890,22 @@ int W_CheckNumForName(const char *name)
     return i;
 }
 
+//
+// W_NextNumForName
+// [BH] Returns the lump before the given one with the same name, or -1 if there
+//  isn't one, so all the lumps with a name can be found using the hash table
+//  starting with W_CheckNumForName().
+//
+int W_NextNumForName(const int lump, const char *name)
+{
+    int i = lumpinfo[lump]->next;
+
+    while (i >= 0 && strncasecmp(lumpinfo[i]->name, name, 8))
+        i = lumpinfo[i]->next;
+
+    return i;
+}
+
 bool W_LumpExistsWithName(int lump, char *name)
 {
     if (lump < 0 || lump >= numlumps)
@@ -1152,19 +1168,78 @@ static void W_ReadLump(int lump, void *dest)
         I_Error("W_ReadLump: only read %zu of %i on lump %i", c, l->size, lump);
 }
 
+// [BH] Lumps can only be used directly from a WAD's mapping if the CPU
+// doesn't fault on unaligned access, as lumps are rarely aligned in WADs.
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64) \
+    || defined(__aarch64__) || defined(_M_ARM64)
+#define ISALIGNED(position) true
+#else
+#define ISALIGNED(position) (!((position) & 7))
+#endif
+
+//
+// W_MappedLump
+// Returns a pointer to the lump inside its WAD's mapping, or NULL if it must
+// be copied instead.
+//
+static void *W_MappedLump(const lumpinfo_t *lump)
+{
+    if (lump->size <= 0 || !ISALIGNED(lump->position))
+        return NULL;
+
+    return W_MappedData(lump->wadfile, lump->position, lump->size);
+}
+
 void *W_CacheLumpNum(int lumpnum)
 {
     lumpinfo_t  *lump = lumpinfo[lumpnum];
 
-    if (!lump->cache)
+    if (!lump->cache && !(lump->cache = W_MappedLump(lump)))
         W_ReadLump(lumpnum, Z_Malloc(lump->size, PU_CACHE, &lump->cache));
 
     return lump->cache;
 }
 
+//
+// W_CacheWritableLumpNum
+// [BH] Like W_CacheLumpNum, but the lump is copied out of its WAD's read-only
+// mapping first, so it can be modified in place.
+//
+void *W_CacheWritableLumpNum(int lumpnum)
+{
+    lumpinfo_t  *lump = lumpinfo[lumpnum];
+
+    if (!lump->cache || lump->cache == W_MappedLump(lump))
+    {
+        lump->cache = NULL;
+        W_ReadLump(lumpnum, Z_Malloc(lump->size, PU_CACHE, &lump->cache));
+    }
+
+    return lump->cache;
+}
+
+//
+// W_LockLumpNum
+// [BH] Like W_CacheLumpNum, but the lump can't be purged until W_ReleaseLumpNum is called.
+//
+void *W_LockLumpNum(int lumpnum)
+{
+    lumpinfo_t  *lump = lumpinfo[lumpnum];
+    void        *cache = W_CacheLumpNum(lumpnum);
+
+    if (cache != W_MappedLump(lump))
+        Z_ChangeTag(cache, PU_STATIC);
+
+    return cache;
+}
+
 void W_ReleaseLumpNum(int lumpnum)
 {
-    Z_ChangeTag(lumpinfo[lumpnum]->cache, PU_CACHE);
+    lumpinfo_t  *lump = lumpinfo[lumpnum];
+
+    // [BH] lumps used directly from a WAD's mapping were never allocated
+    if (lump->cache && lump->cache != W_MappedLump(lump))
+        Z_ChangeTag(lump->cache, PU_CACHE);
 }
 
 void W_CloseFiles(void)
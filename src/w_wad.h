@@ -82,6 +82,7 @@ bool W_AutoloadFiles(const char *folder, const bool noexpansions);
 int W_WadType(char *filename);
 
 int W_CheckNumForName(const char *name);
+int W_NextNumForName(const int lump, const char *name);
 
 int W_CheckNumForNameFromTo(int min, int max, const char *name);
 int W_GetNumForName(const char *name);
@@ -99,11 +100,14 @@ bool W_LumpExistsWithName(int lump, char *name);
 int W_LumpLengthWithName(int lump, char *name);
 
 void *W_CacheLumpNum(int lumpnum);
+void *W_CacheWritableLumpNum(int lumpnum);
+void *W_LockLumpNum(int lumpnum);
 
 #define W_CacheLumpName(name)                   W_CacheLumpNum(W_GetNumForName(name))
 #define W_CacheLastLumpName(name)               W_CacheLumpNum(W_GetLastNumForName(name))
 #define W_CacheXLumpName(name, x)               W_CacheLumpNum(W_GetXNumForName(name, x))
 #define W_CacheLumpNameFromResourceWAD(name)    W_CacheLumpNum(W_GetNumForNameFromResourceWAD(name))
+#define W_CacheWritableLumpName(name)           W_CacheWritableLumpNum(W_GetNumForName(name))
 
 void W_Init(void);
 bool W_IsPNGLump(const int lump);
@@ -37,7 +37,13 @@
 #include "z_zone.h"
 
 // Minimum chunk size at which blocks are allocated
-#define CHUNKSIZE   32
+#define CHUNKSIZE           32
+
+// Largest block that is allocated from a level arena rather than with malloc()
+#define ARENAMAXBLOCKSIZE   2048
+
+// Size of the chunks of memory a level arena bumps its blocks out of
+#define ARENACHUNKSIZE      (1024 * 1024)
 
 typedef struct memblock_s
 {
@@ -46,16 +52,184 @@ typedef struct memblock_s
     size_t              size;
     void                **user;
     unsigned char       tag;
+    bool                arena;
+#if defined(ZONESTATS)
+    int                 callsite;
+#endif
 } memblock_t;
 
+typedef struct arenachunk_s
+{
+    struct arenachunk_s *next;
+    size_t              used;
+} arenachunk_t;
+
+// [BH] Blocks tagged PU_LEVEL or PU_LEVSPEC are bumped out of a list of chunks
+//  that is kept from one map to the next, so all of them can be freed at once
+//  by Z_FreeTags(). Blocks freed before then are kept in a list for their size.
+typedef struct
+{
+    arenachunk_t        *chunks;
+    arenachunk_t        *chunk;
+    memblock_t          *freeblocks[ARENAMAXBLOCKSIZE / CHUNKSIZE + 1];
+    size_t              bytes;
+    size_t              blocks;
+} arena_t;
+
 // size of block header
 // cph - base on sizeof(memblock_t), which can be larger than CHUNKSIZE on 64-bit architectures
 static const size_t headersize = ((sizeof(memblock_t) + CHUNKSIZE - 1) & ~(CHUNKSIZE - 1));
 
+// size of arena chunk header
+static const size_t chunkheadersize = ((sizeof(arenachunk_t) + CHUNKSIZE - 1) & ~(CHUNKSIZE - 1));
+
 static memblock_t   *blockbytag[PU_MAX];
+static arena_t      arenas[PU_MAX];
+
+zonestats_t         zonestats[PU_MAX];
+
+#if defined(ZONESTATS)
+#undef Z_Malloc
+#undef Z_Calloc
+
+zonecallsite_t      zonecallsites[ZONECALLSITES + 1];
+int                 numzonecallsites;
+
+uint64_t            zonetics;
+uint64_t            zoneallocations;
+int                 zonelastticallocations;
+int                 zonepeakticallocations;
+
+static int          zoneticallocations;
+
+// [BH] blocks in an arena counted in the last callsite, for each tag
+static size_t       otherarenabytes[PU_MAX];
+static size_t       otherarenablocks[PU_MAX];
+
+//
+// Z_GetCallsite
+// Returns the index of the callsite for blocks with tag allocated at file and
+// line, adding it if it's new. Once the table is 3/4 full, new callsites are
+// counted together in the last entry, which has no tag of its own.
+//
+static int Z_GetCallsite(const char *file, const int line, const unsigned char tag)
+{
+    int i = (int)(((uintptr_t)file * 31 + line * 7 + tag) & (ZONECALLSITES - 1));
+
+    while (zonecallsites[i].file)
+    {
+        const zonecallsite_t    *callsite = &zonecallsites[i];
+
+        if (callsite->line == line && callsite->tag == tag && callsite->file == file)
+            return i;
+
+        i = (i + 1) & (ZONECALLSITES - 1);
+    }
+
+    if (numzonecallsites >= ZONECALLSITES * 3 / 4)
+    {
+        zonecallsites[ZONECALLSITES].file = "(other)";
+        return ZONECALLSITES;
+    }
+
+    zonecallsites[i].file = file;
+    zonecallsites[i].line = line;
+    zonecallsites[i].tag = tag;
+    numzonecallsites++;
+
+    return i;
+}
+
+//
+// Z_Tick
+// Called once every tic by G_Ticker() to work out the rate blocks are allocated at.
+//
+void Z_Tick(void)
+{
+    zonetics++;
+    zonelastticallocations = zoneticallocations;
+
+    if (zoneticallocations > zonepeakticallocations)
+        zonepeakticallocations = zoneticallocations;
+
+    zoneticallocations = 0;
+}
+#endif
+
+static void Z_AddStats(const unsigned char tag, const size_t size)
+{
+    zonestats_t *stats = &zonestats[tag];
+
+    if ((stats->bytes += size) > stats->peakbytes)
+        stats->peakbytes = stats->bytes;
+
+    if (++stats->blocks > stats->peakblocks)
+        stats->peakblocks = stats->blocks;
+}
+
+static void Z_RemoveStats(const unsigned char tag, const size_t size)
+{
+    zonestats[tag].bytes -= size;
+    zonestats[tag].blocks--;
+}
 
 //
-// Z_Malloc
+// Z_ArenaMalloc
+// Returns a block from the arena for tag, either one that has been freed
+// before, or a new one from the end of its current chunk.
+//
+static memblock_t *Z_ArenaMalloc(const size_t size, const unsigned char tag)
+{
+    arena_t         *arena = &arenas[tag];
+    memblock_t      *block = arena->freeblocks[size / CHUNKSIZE];
+    arenachunk_t    *chunk = arena->chunk;
+
+    if (block)
+    {
+        arena->freeblocks[size / CHUNKSIZE] = block->next;
+        return block;
+    }
+
+    while (!chunk || chunk->used + headersize + size > ARENACHUNKSIZE - chunkheadersize)
+        if (chunk && chunk->next)
+        {
+            // reuse a chunk from a previous map
+            chunk = chunk->next;
+            chunk->used = 0;
+        }
+        else
+        {
+            arenachunk_t    *newchunk;
+
+            while (!(newchunk = malloc(ARENACHUNKSIZE)))
+            {
+                if (!blockbytag[PU_CACHE])
+                    I_Error("Z_Malloc: Failure trying to allocate %lu bytes", (unsigned long)ARENACHUNKSIZE);
+
+                Z_FreeTags(PU_CACHE, PU_CACHE);
+            }
+
+            newchunk->next = NULL;
+            newchunk->used = 0;
+
+            if (chunk)
+                chunk->next = newchunk;
+            else
+                arena->chunks = newchunk;
+
+            chunk = newchunk;
+            zonestats[tag].arenabytes += ARENACHUNKSIZE;
+        }
+
+    block = (memblock_t *)((char *)chunk + chunkheadersize + chunk->used);
+    chunk->used += headersize + size;
+    arena->chunk = chunk;
+
+    return block;
+}
+
+//
+// Z_MallocBlock
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
 //
 // cph - the algorithm here was a very simple first-fit round-robin
@@ -66,7 +240,9 @@ static memblock_t   *blockbytag[PU_MAX];
 // but we only free the blocks we actually end up using; we don't
 // free all the stuff we just pass on the way.
 //
-void *Z_Malloc(size_t size, unsigned char tag, void **user)
+// [BH] Returns the header of the new block rather than the block itself.
+//
+static memblock_t *Z_MallocBlock(size_t size, unsigned char tag, void **user)
 {
     memblock_t  *block = NULL;
 
@@ -75,6 +251,30 @@ void *Z_Malloc(size_t size, unsigned char tag, void **user)
 
     size = ((size + CHUNKSIZE - 1) & ~(CHUNKSIZE - 1)); // round to chunk size
 
+#if defined(ZONESTATS)
+    zoneallocations++;
+    zoneticallocations++;
+#endif
+
+    if ((tag == PU_LEVEL || tag == PU_LEVSPEC) && size <= ARENAMAXBLOCKSIZE && !user)
+    {
+        block = Z_ArenaMalloc(size, tag);
+        block->next = block->prev = NULL;
+        block->size = size;
+        block->tag = tag;
+        block->user = NULL;
+        block->arena = true;
+#if defined(ZONESTATS)
+        block->callsite = -1;
+#endif
+
+        arenas[tag].bytes += size;
+        arenas[tag].blocks++;
+        Z_AddStats(tag, size);
+
+        return block;
+    }
+
     while (!(block = malloc(size + headersize)))
     {
         if (!blockbytag[PU_CACHE])
@@ -100,19 +300,69 @@ void *Z_Malloc(size_t size, unsigned char tag, void **user)
 
     block->tag = tag;
     block->user = user;
-    block = (memblock_t *)((char *)block + headersize);
+    block->arena = false;
+#if defined(ZONESTATS)
+    block->callsite = -1;
+#endif
+    Z_AddStats(tag, size);
 
-    if (user)           // if there is a user
-        *user = block;  // set user to point to new block
+    if (user)                                   // if there is a user
+        *user = (char *)block + headersize;     // set user to point to new block
 
     return block;
 }
 
+void *Z_Malloc(size_t size, unsigned char tag, void **user)
+{
+    memblock_t  *block = Z_MallocBlock(size, tag, user);
+
+    return (block ? (char *)block + headersize : NULL);
+}
+
 void *Z_Calloc(size_t size1, size_t size2, unsigned char tag, void **user)
 {
     return ((size1 *= size2) ? memset(Z_Malloc(size1, tag, user), 0, size1) : NULL);
 }
 
+#if defined(ZONESTATS)
+void *Z_MallocAt(size_t size, unsigned char tag, void **user, const char *file, int line)
+{
+    memblock_t  *block = Z_MallocBlock(size, tag, user);
+
+    if (block)
+    {
+        zonecallsite_t  *callsite;
+
+        block->callsite = Z_GetCallsite(file, line, tag);
+        callsite = &zonecallsites[block->callsite];
+        callsite->allocations++;
+        callsite->blocks++;
+
+        if ((callsite->bytes += block->size) > callsite->peakbytes)
+            callsite->peakbytes = callsite->bytes;
+
+        if (block->arena)
+        {
+            callsite->arenabytes += block->size;
+            callsite->arenablocks++;
+
+            if (block->callsite == ZONECALLSITES)
+            {
+                otherarenabytes[tag] += block->size;
+                otherarenablocks[tag]++;
+            }
+        }
+    }
+
+    return (block ? (char *)block + headersize : NULL);
+}
+
+void *Z_CallocAt(size_t size1, size_t size2, unsigned char tag, void **user, const char *file, int line)
+{
+    return ((size1 *= size2) ? memset(Z_MallocAt(size1, tag, user, file, line), 0, size1) : NULL);
+}
+#endif
+
 void Z_Free(void *ptr)
 {
     memblock_t      *block;
@@ -125,6 +375,41 @@ void Z_Free(void *ptr)
         return;
 
     block = (memblock_t *)((char *)ptr - headersize);
+
+#if defined(ZONESTATS)
+    if (block->callsite >= 0)
+    {
+        zonecallsite_t  *callsite = &zonecallsites[block->callsite];
+
+        callsite->bytes -= block->size;
+        callsite->blocks--;
+
+        if (block->arena)
+        {
+            callsite->arenabytes -= block->size;
+            callsite->arenablocks--;
+
+            if (block->callsite == ZONECALLSITES)
+            {
+                otherarenabytes[block->tag] -= block->size;
+                otherarenablocks[block->tag]--;
+            }
+        }
+    }
+#endif
+
+    if (block->arena)
+    {
+        arena_t *arena = &arenas[block->tag];
+
+        block->next = arena->freeblocks[block->size / CHUNKSIZE];
+        arena->freeblocks[block->size / CHUNKSIZE] = block;
+        arena->bytes -= block->size;
+        arena->blocks--;
+        Z_RemoveStats(block->tag, block->size);
+        return;
+    }
+
     next = block->next;
     prev = block->prev;
     user = block->user;
@@ -142,14 +427,53 @@ void Z_Free(void *ptr)
     prev->next = next;
     next->prev = prev;
 
+    Z_RemoveStats(tag, block->size);
     free(block);
 }
 
 void Z_FreeTags(unsigned char lowtag, unsigned char hightag)
 {
     for (; lowtag <= hightag; lowtag++)
+    {
+        arena_t *arena = &arenas[lowtag];
+
         while (blockbytag[lowtag])
             Z_Free((char *)blockbytag[lowtag] + headersize);
+
+        // [BH] free every block in the arena at once by starting again at its first chunk
+        if (arena->chunks)
+        {
+            zonestats[lowtag].bytes -= arena->bytes;
+            zonestats[lowtag].blocks -= arena->blocks;
+            arena->bytes = 0;
+            arena->blocks = 0;
+            arena->chunk = arena->chunks;
+            arena->chunk->used = 0;
+            memset(arena->freeblocks, 0, sizeof(arena->freeblocks));
+
+#if defined(ZONESTATS)
+            for (int i = 0; i < ZONECALLSITES; i++)
+            {
+                zonecallsite_t  *callsite = &zonecallsites[i];
+
+                if (callsite->tag == lowtag)
+                {
+                    callsite->bytes -= callsite->arenabytes;
+                    callsite->blocks -= callsite->arenablocks;
+                    callsite->arenabytes = 0;
+                    callsite->arenablocks = 0;
+                }
+            }
+
+            zonecallsites[ZONECALLSITES].bytes -= otherarenabytes[lowtag];
+            zonecallsites[ZONECALLSITES].blocks -= otherarenablocks[lowtag];
+            zonecallsites[ZONECALLSITES].arenabytes -= otherarenabytes[lowtag];
+            zonecallsites[ZONECALLSITES].arenablocks -= otherarenablocks[lowtag];
+            otherarenabytes[lowtag] = 0;
+            otherarenablocks[lowtag] = 0;
+#endif
+        }
+    }
 }
 
 void Z_ChangeTag(void *ptr, unsigned char tag)
@@ -165,6 +489,31 @@ void Z_ChangeTag(void *ptr, unsigned char tag)
     if (tag == block->tag)
         return;
 
+    if (block->arena)
+        I_Error("Z_ChangeTag: Can't change the tag of a block in a level arena");
+
+    Z_RemoveStats(block->tag, block->size);
+    Z_AddStats(tag, block->size);
+
+#if defined(ZONESTATS)
+    // [BH] move the block to the callsite it would have been counted in if it
+    //  was allocated with its new tag. the last callsite has no tag of its own.
+    if (block->callsite >= 0 && block->callsite < ZONECALLSITES)
+    {
+        zonecallsite_t  *callsite = &zonecallsites[block->callsite];
+
+        callsite->bytes -= block->size;
+        callsite->blocks--;
+
+        block->callsite = Z_GetCallsite(callsite->file, callsite->line, tag);
+        callsite = &zonecallsites[block->callsite];
+        callsite->blocks++;
+
+        if ((callsite->bytes += block->size) > callsite->peakbytes)
+            callsite->peakbytes = callsite->bytes;
+    }
+#endif
+
     if (block == block->next)
         blockbytag[block->tag] = NULL;
     else if (blockbytag[block->tag] == block)
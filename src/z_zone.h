@@ -57,8 +57,58 @@ enum
 
 #define PU_PURGELEVEL    PU_CACHE    // First purgeable tag's level
 
+typedef struct
+{
+    size_t  bytes;
+    size_t  blocks;
+    size_t  peakbytes;
+    size_t  peakblocks;
+    size_t  arenabytes;
+} zonestats_t;
+
+extern zonestats_t  zonestats[PU_MAX];
+
+#if defined(ZONESTATS)
+// [BH] Built with ZONESTATS defined, every block records the file and line it
+//  was allocated at, and running totals are kept for each of those callsites.
+#define ZONECALLSITES   1024
+
+typedef struct
+{
+    const char      *file;
+    int             line;
+    unsigned char   tag;
+    size_t          bytes;
+    size_t          blocks;
+    size_t          peakbytes;
+    uint64_t        allocations;
+    size_t          arenabytes;
+    size_t          arenablocks;
+} zonecallsite_t;
+
+extern zonecallsite_t   zonecallsites[ZONECALLSITES + 1];
+extern int              numzonecallsites;
+
+extern uint64_t         zonetics;
+extern uint64_t         zoneallocations;
+extern int              zonelastticallocations;
+extern int              zonepeakticallocations;
+#endif
+
 void *Z_Malloc(size_t size, unsigned char tag, void **user) ALLOCATTR(1);
 void *Z_Calloc(size_t size1, size_t size2, unsigned char tag, void **user) ALLOCSATTR(1, 2);
 void Z_Free(void *ptr);
 void Z_FreeTags(unsigned char lowtag, unsigned char hightag);
 void Z_ChangeTag(void *ptr, unsigned char tag);
+
+#if defined(ZONESTATS)
+void *Z_MallocAt(size_t size, unsigned char tag, void **user, const char *file, int line) ALLOCATTR(1);
+void *Z_CallocAt(size_t size1, size_t size2, unsigned char tag, void **user,
+    const char *file, int line) ALLOCSATTR(1, 2);
+void Z_Tick(void);
+
+#define Z_Malloc(size, tag, user)           Z_MallocAt(size, tag, user, __FILE__, __LINE__)
+#define Z_Calloc(size1, size2, tag, user)   Z_CallocAt(size1, size2, tag, user, __FILE__, __LINE__)
+#else
+#define Z_Tick()
+#endif